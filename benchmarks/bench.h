@@ -0,0 +1,381 @@
+/// bench.h
+/// Minimal, self-contained microbenchmark harness
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Used only by the benchmarks in this directory, so that they need
+/// nothing beyond the library itself (no network fetch).
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Each benchmark is timed as a number of samples (repetitions), each
+/// running the measured operation enough times to last `min_time`.
+/// Samples are reported as nanoseconds per operation, summarized by:
+/// - median and MAD (median absolute deviation), which are robust to
+///   the odd interrupted sample, unlike mean and standard deviation
+/// - p99, min, max and mean, for the tails
+///
+///   Writing benchmarks
+/// Benchmarks are grouped into suites, which register themselves:
+/// ```
+/// SIMPLY_BENCHMARK(atomics) {
+///     std::atomic<int> value = 0;
+///     runner.run("atomic/fetch_add", [&](){ value.fetch_add(1); });
+///
+///     // When the timing must exclude setup, time each batch yourself
+///     runner.run_manual("thread/spawn", [&](uint64_t iterations){
+///         ... // Setup
+///         auto start = simply::bench::Clock::now();
+///         ... // Run iterations
+///         return simply::bench::Clock::now() - start;
+///     });
+/// }
+/// ```
+#ifndef SIMPLY_BENCH_HPP_
+#define SIMPLY_BENCH_HPP_
+
+#include <simply/concurrency.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace simply::bench {
+// =====================================================================
+// Bench >> Declarations
+// =====================================================================
+///   Clock
+/// Clock used for all measurements
+using Clock = std::chrono::steady_clock;
+
+///   Options
+/// Settings for a run, set from the command line in main.cpp
+struct Options {
+    ///   warmup
+    /// Samples taken and discarded before measuring
+    size_t warmup = 2;
+
+    ///   repetitions
+    /// Samples measured per benchmark
+    size_t repetitions = 20;
+
+    ///   min_time
+    /// Minimum duration of a sample, used to pick iterations per sample
+    std::chrono::nanoseconds min_time = std::chrono::milliseconds(10);
+
+    ///   pin
+    /// CPU to pin the measuring thread to, if any
+    std::optional<unsigned> pin;
+
+    ///   filter
+    /// Only run benchmarks whose name contains this
+    std::string filter;
+};
+
+///   Stats
+/// Summary of samples, in nanoseconds per operation
+struct Stats {
+    size_t samples = 0;
+    double min     = 0;
+    double max     = 0;
+    double mean    = 0;
+    double median  = 0;
+    double p99     = 0;
+    double mad     = 0;
+};
+
+///   Result
+/// Measurements of a single benchmark
+struct Result {
+    std::string name;
+    uint64_t iterations; // Per sample
+    Stats ns_per_op;
+};
+
+///   Runner
+/// Runs benchmarks, and collects their results
+class Runner final {
+public:
+    explicit Runner(Options opt);
+
+    ///   run
+    /// Time f, called once per operation
+    template <class F>
+    void run(const std::string& name, F&& f);
+
+    ///   run_manual
+    /// Time batches timed by f itself
+    ///
+    /// f is given the number of operations to run, and must return
+    /// how long they took (as any `std::chrono::duration`)
+    template <class F>
+    void run_manual(const std::string& name, F&& f);
+
+    ///   run_fixed
+    /// As `run_manual`, but with a fixed number of operations per sample
+    ///
+    /// For operations too slow or heavy to repeat many times, such as
+    /// starting hundreds of threads
+    template <class F>
+    void run_fixed(const std::string& name, uint64_t iterations, F&& f);
+
+    ///   results
+    /// Results of all benchmarks run so far
+    const std::vector<Result>& results() const noexcept;
+
+    ///   options
+    /// Options given to the constructor
+    const Options& options() const noexcept;
+
+    ///   write_table
+    /// Write results as a human-readable table
+    void write_table(std::ostream& ost) const;
+
+    ///   write_json
+    /// Write results (and context such as pinning) as JSON
+    void write_json(std::ostream& ost) const;
+
+private:
+    bool _selected(const std::string& name) const;
+
+    void _measure(const std::string& name, uint64_t iterations,
+                  const std::function<std::chrono::nanoseconds(uint64_t)>& batch);
+
+    Options _opt;
+    std::vector<Result> _results;
+};
+
+///   Suite
+/// A function registering/running related benchmarks
+using Suite = void (*)(Runner& runner);
+
+///   suites
+/// All suites registered with `SIMPLY_BENCHMARK`, by name
+std::map<std::string, Suite>& suites();
+
+///   summarize
+/// Compute statistics over samples
+Stats summarize(std::vector<double> samples);
+
+///   keep
+/// Prevent the compiler from optimizing away a value
+template <class T>
+void keep(T&& value) noexcept;
+
+///   pin_current_thread
+/// Restrict the calling thread to a single CPU
+///
+/// Throws `system_error` if not possible, for example for CPUs above 63
+void pin_current_thread(unsigned cpu);
+
+///   SIMPLY_BENCHMARK
+/// Define and register a suite, see notes at start of file
+#define SIMPLY_BENCHMARK(suite_name)                                             \
+    static void suite_name(::simply::bench::Runner& runner);                      \
+    static const bool suite_name##_registered =                                   \
+        (::simply::bench::suites()[#suite_name] = &suite_name, true);             \
+    static void suite_name(::simply::bench::Runner& runner)
+
+// =====================================================================
+// Bench >> Implementations
+// =====================================================================
+inline std::map<std::string, Suite>& suites() {
+    static std::map<std::string, Suite> registered;
+    return registered;
+}
+
+template <class T>
+void keep(T&& value) noexcept {
+#ifdef _MSC_VER
+    // No inline assembly - escape the address through a volatile instead
+    static const void* volatile sink;
+    sink = static_cast<const void*>(&value);
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+inline void pin_current_thread(unsigned cpu) {
+    if ( cpu >= 64 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "pin_current_thread: only CPUs 0 to 63 supported"
+        );
+    if ( !SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) )
+        throw std::system_error(GetLastError(), std::system_category());
+}
+
+inline Stats summarize(std::vector<double> samples) {
+    Stats stats;
+    if ( samples.empty() )
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+    const size_t n = samples.size();
+
+    auto median_of = [](const std::vector<double>& sorted) {
+        size_t mid = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+    };
+
+    stats.samples = n;
+    stats.min     = samples.front();
+    stats.max     = samples.back();
+    stats.median  = median_of(samples);
+    stats.p99     = samples[std::min(n - 1, static_cast<size_t>(std::ceil(0.99 * n)) - 1)];
+
+    double total = 0;
+    for ( double sample: samples )
+        total += sample;
+    stats.mean = total / n;
+
+    std::vector<double> deviations;
+    for ( double sample: samples )
+        deviations.push_back(std::abs(sample - stats.median));
+    std::sort(deviations.begin(), deviations.end());
+    stats.mad = median_of(deviations);
+
+    return stats;
+}
+
+inline Runner::Runner(Options opt): _opt(std::move(opt)) {
+    if ( _opt.pin )
+        pin_current_thread(*_opt.pin);
+}
+
+inline bool Runner::_selected(const std::string& name) const {
+    return name.find(_opt.filter) != std::string::npos;
+}
+
+template <class F>
+void Runner::run(const std::string& name, F&& f) {
+    run_manual(name, [&f](uint64_t iterations){
+        auto start = Clock::now();
+        for ( uint64_t i = 0; i < iterations; i++ )
+            f();
+        return Clock::now() - start;
+    });
+}
+
+template <class F>
+void Runner::run_manual(const std::string& name, F&& f) {
+    if ( !_selected(name) )
+        return;
+
+    auto batch = [&f](uint64_t iterations) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(f(iterations));
+    };
+
+    // Double iterations until a single batch lasts min_time
+    uint64_t iterations = 1;
+    while ( iterations < (uint64_t(1) << 30) && batch(iterations) < _opt.min_time )
+        iterations *= 2;
+
+    _measure(name, iterations, batch);
+}
+
+template <class F>
+void Runner::run_fixed(const std::string& name, uint64_t iterations, F&& f) {
+    if ( !_selected(name) )
+        return;
+
+    _measure(name, iterations, [&f](uint64_t n) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(f(n));
+    });
+}
+
+inline void Runner::_measure(const std::string& name, uint64_t iterations,
+                             const std::function<std::chrono::nanoseconds(uint64_t)>& batch) {
+    for ( size_t i = 0; i < _opt.warmup; i++ )
+        batch(iterations);
+
+    std::vector<double> samples;
+    for ( size_t i = 0; i < _opt.repetitions; i++ )
+        samples.push_back(static_cast<double>(batch(iterations).count()) / iterations);
+
+    _results.push_back({name, iterations, summarize(std::move(samples))});
+}
+
+inline const std::vector<Result>& Runner::results() const noexcept {
+    return _results;
+}
+
+inline const Options& Runner::options() const noexcept {
+    return _opt;
+}
+
+inline void Runner::write_table(std::ostream& ost) const {
+    size_t width = 9;
+    for ( const Result& result: _results )
+        width = std::max(width, result.name.size());
+
+    ost << std::left << std::setw(width) << "benchmark" << std::right
+        << std::setw(14) << "median ns" << std::setw(12) << "mad"
+        << std::setw(14) << "p99 ns" << std::setw(12) << "iterations" << '\n';
+
+    for ( const Result& result: _results )
+        ost << std::left << std::setw(width) << result.name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(14) << result.ns_per_op.median << std::setw(12) << result.ns_per_op.mad
+            << std::setw(14) << result.ns_per_op.p99 << std::setw(12) << result.iterations << '\n';
+}
+
+// Benchmark names are plain ASCII, but escape anyway to keep output valid
+inline std::string _json_string(const std::string& text) {
+    std::string escaped = "\"";
+    for ( char c: text ) {
+        if ( c == '"' || c == '\\' ) {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ( static_cast<unsigned char>(c) < 0x20 ) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else
+            escaped += c;
+    }
+    return escaped + "\"";
+}
+
+inline void Runner::write_json(std::ostream& ost) const {
+    ost << "{\n  \"context\": {\n"
+        << "    \"hardware_concurrency\": " << Thread::hardware_concurrency() << ",\n"
+        << "    \"pinned_cpu\": " << (_opt.pin ? std::to_string(*_opt.pin) : "null") << ",\n"
+        << "    \"warmup\": " << _opt.warmup << ",\n"
+        << "    \"repetitions\": " << _opt.repetitions << "\n"
+        << "  },\n  \"benchmarks\": [";
+
+    for ( size_t i = 0; i < _results.size(); i++ ) {
+        const Result& result = _results[i];
+        const Stats& stats   = result.ns_per_op;
+        ost << (i ? "," : "") << "\n    {\"name\": " << _json_string(result.name)
+            << ", \"iterations\": " << result.iterations
+            << ", \"samples\": " << stats.samples
+            << ", \"ns_per_op\": {\"median\": " << stats.median
+            << ", \"mad\": " << stats.mad
+            << ", \"p99\": " << stats.p99
+            << ", \"min\": " << stats.min
+            << ", \"max\": " << stats.max
+            << ", \"mean\": " << stats.mean << "}}";
+    }
+    ost << "\n  ]\n}\n";
+}
+}
+
+#endif // SIMPLY_BENCH_HPP_
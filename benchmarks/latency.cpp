@@ -0,0 +1,299 @@
+// simply_latency - wake-up latency per Thread::Priority (like cyclictest)
+//
+// For each priority, a measuring thread is started with that priority
+// (and optionally affinity), and records how late it wakes up:
+// - sleep:  from absolute deadlines, waiting on a high-resolution
+//           waitable timer alone (a regular one before Windows 10 1803)
+// - signal: from an event set by another thread
+//
+// Sleep mode does not use `this_thread::sleep_until`, which yields
+// through the last stretch before each deadline, so hides how late the
+// scheduler wakes the thread.
+//
+// Optionally, background threads keep CPUs busy meanwhile, to show how
+// much each priority helps under load.
+//
+// Usage: simply_latency [--mode sleep|signal|both] [--priority NAME|all]
+//                       [--samples N] [--interval-us US] [--cpu 0-63]
+//                       [--load N] [--histogram] [--json FILE]
+
+#include "tools.h"
+
+#include <simply/concurrency.h>
+#include <simply/histogram.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <ratio>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+using Clock    = std::chrono::steady_clock;
+using Priority = simply::Thread::Priority;
+using simply::bench::priority_name;
+
+struct Config {
+    bool sleep_mode   = true;
+    bool signal_mode  = true;
+    std::vector<Priority> priorities = simply::bench::priorities();
+    size_t samples    = 10000;
+    std::chrono::microseconds interval{1000};
+    std::optional<unsigned> cpu;
+    unsigned load     = 0;
+    bool histogram    = false;
+    std::string json_path;
+};
+
+struct Measurement {
+    std::string mode;
+    Priority priority;
+    std::optional<simply::LatencyHistogram::Snapshot> snapshot; // Empty if unavailable
+};
+
+simply::Thread::Options thread_options(const Config& config, Priority priority) {
+    return simply::bench::thread_options(priority, config.cpu);
+}
+
+// Waitable timer, high-resolution where available
+struct Timer {
+    HANDLE handle = CreateWaitableTimerExW(
+        nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS
+    );
+
+    Timer() {
+        if ( !handle )
+            handle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        if ( !handle )
+            throw std::system_error(GetLastError(), std::system_category());
+    }
+
+    ~Timer() {
+        CloseHandle(handle);
+    }
+};
+
+// Wakes from absolute deadlines, so lateness does not accumulate.
+// Returns false if the timer failed.
+bool measure_sleep(const Config& config, HANDLE timer, simply::LatencyHistogram& histogram) {
+    using Ticks = std::chrono::duration<LONGLONG, std::ratio<1, 10000000>>; // Of timers, 100ns
+
+    auto deadline = Clock::now() + config.interval;
+    for ( size_t i = 0; i < config.samples; i++ ) {
+        const auto remaining = deadline - Clock::now();
+        if ( remaining.count() > 0 ) {
+            LARGE_INTEGER due;
+            due.QuadPart = -std::chrono::ceil<Ticks>(remaining).count(); // Relative, never early
+            if ( !SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE)
+                 || WaitForSingleObject(timer, INFINITE) != WAIT_OBJECT_0 )
+                return false;
+        }
+        histogram.record(Clock::now() - deadline);
+        deadline += config.interval;
+    }
+    return true;
+}
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Wakes from an auto-reset event, set by the calling thread
+void measure_signal(const Config& config, Priority priority, simply::LatencyHistogram& histogram) {
+    HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if ( !event )
+        throw std::system_error(GetLastError(), std::system_category());
+    std::unique_ptr<void, decltype(&CloseHandle)> event_guard(event, &CloseHandle);
+
+    std::atomic<int64_t> sent{0};
+    std::atomic<bool> waiting{false};
+
+    simply::Thread waiter(thread_options(config, priority), [&](){
+        for ( size_t i = 0; i < config.samples; i++ ) {
+            waiting = true;
+            WaitForSingleObject(event, INFINITE);
+            histogram.record(now_ns() - sent.load());
+        }
+    });
+
+    for ( size_t i = 0; i < config.samples; i++ ) {
+        simply::this_thread::sleep_for(config.interval);
+        while ( !waiting.exchange(false) ) // Only signal once it is waiting (or about to)
+            simply::this_thread::yield();
+        sent = now_ns();
+        SetEvent(event);
+    }
+    waiter.join();
+}
+
+Measurement measure(const Config& config, const std::string& mode, Priority priority) {
+    simply::LatencyHistogram histogram;
+    try {
+        if ( mode == "sleep" ) {
+            Timer timer;
+            bool measured = false;
+            simply::Thread t(thread_options(config, priority), [&](){
+                measured = measure_sleep(config, timer.handle, histogram);
+            });
+            t.join();
+            if ( !measured )
+                return {mode, priority, std::nullopt};
+        }
+        else {
+            measure_signal(config, priority, histogram);
+        }
+    }
+    catch ( const std::system_error& ) {
+        // For example TIME_CRITICAL without sufficient rights
+        return {mode, priority, std::nullopt};
+    }
+    return {mode, priority, histogram.snapshot()};
+}
+
+void print(const Measurement& m, bool histogram) {
+    std::cout << std::left << std::setw(8) << m.mode << std::setw(15) << priority_name(m.priority) << std::right;
+    if ( !m.snapshot ) {
+        std::cout << "  unavailable\n";
+        return;
+    }
+
+    const auto& s = *m.snapshot;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(10) << s.min() / 1e3
+              << std::setw(10) << s.percentile(50) / 1e3
+              << std::setw(10) << s.percentile(90) / 1e3
+              << std::setw(10) << s.percentile(99) / 1e3
+              << std::setw(10) << s.percentile(99.9) / 1e3
+              << std::setw(10) << s.max() / 1e3 << '\n';
+
+    if ( histogram )
+        for ( size_t i = 0; i < s.counts().size(); i++ )
+            if ( s.counts()[i] )
+                std::cout << "    " << std::setw(12) << s.lowest(i) / 1e3 << " us  " << s.counts()[i] << '\n';
+}
+
+void write_json(std::ostream& ost, const Config& config, const std::vector<Measurement>& measurements) {
+    ost << "{\n  \"samples\": " << config.samples
+        << ",\n  \"interval_us\": " << config.interval.count()
+        << ",\n  \"cpu\": " << (config.cpu ? std::to_string(*config.cpu) : "null")
+        << ",\n  \"load\": " << config.load
+        << ",\n  \"results\": [";
+
+    for ( size_t i = 0; i < measurements.size(); i++ ) {
+        const Measurement& m = measurements[i];
+        ost << (i ? "," : "") << "\n    {\"mode\": \"" << m.mode
+            << "\", \"priority\": \"" << priority_name(m.priority) << "\"";
+        if ( m.snapshot ) {
+            const auto& s = *m.snapshot;
+            ost << ", \"ns\": {\"min\": " << s.min() << ", \"p50\": " << s.percentile(50)
+                << ", \"p90\": " << s.percentile(90) << ", \"p99\": " << s.percentile(99)
+                << ", \"p99.9\": " << s.percentile(99.9) << ", \"max\": " << s.max()
+                << "}, \"buckets\": [";
+            bool first = true;
+            for ( size_t b = 0; b < s.counts().size(); b++ ) {
+                if ( !s.counts()[b] )
+                    continue;
+                ost << (first ? "" : ", ") << "[" << s.lowest(b) << ", " << s.counts()[b] << "]";
+                first = false;
+            }
+            ost << "]";
+        }
+        else
+            ost << ", \"ns\": null";
+        ost << "}";
+    }
+    ost << "\n  ]\n}\n";
+}
+
+void usage() {
+    simply::bench::usage("simply_latency", {
+        "[--mode sleep|signal|both] [--priority NAME|all]",
+        "[--samples N] [--interval-us US] [--cpu 0-63]",
+        "[--load N] [--histogram] [--json FILE]"
+    });
+}
+}
+
+int main(int argc, char** argv) {
+    Config config;
+
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        bool has_value  = i + 1 < argc;
+
+        if ( arg == "--mode" && has_value ) {
+            std::string mode   = argv[++i];
+            config.sleep_mode  = mode == "sleep"  || mode == "both";
+            config.signal_mode = mode == "signal" || mode == "both";
+        }
+        else if ( arg == "--priority" && has_value ) {
+            std::string name = argv[++i];
+            if ( name != "all" ) {
+                auto priority = simply::bench::parse_priority(name);
+                if ( !priority ) {
+                    usage();
+                    return EXIT_FAILURE;
+                }
+                config.priorities = {*priority};
+            }
+        }
+        else if ( arg == "--samples" && has_value )
+            config.samples = std::stoul(argv[++i]);
+        else if ( arg == "--interval-us" && has_value )
+            config.interval = std::chrono::microseconds(std::stoul(argv[++i]));
+        else if ( arg == "--cpu" && has_value ) {
+            config.cpu = simply::bench::parse_cpu(argv[++i]);
+            if ( !config.cpu ) {
+                usage();
+                return EXIT_FAILURE;
+            }
+        }
+        else if ( arg == "--load" && has_value )
+            config.load = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if ( arg == "--histogram" )
+            config.histogram = true;
+        else if ( arg == "--json" && has_value )
+            config.json_path = argv[++i];
+        else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Background load, on the same CPU if pinned
+    std::optional<simply::bench::BusyLoad> load(std::in_place, config.load, config.cpu);
+
+    std::cout << std::left << std::setw(8) << "mode" << std::setw(15) << "priority" << std::right
+              << std::setw(10) << "min us" << std::setw(10) << "p50" << std::setw(10) << "p90"
+              << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << '\n';
+
+    std::vector<Measurement> measurements;
+    for ( Priority priority: config.priorities ) {
+        if ( config.sleep_mode ) {
+            measurements.push_back(measure(config, "sleep", priority));
+            print(measurements.back(), config.histogram);
+        }
+        if ( config.signal_mode ) {
+            measurements.push_back(measure(config, "signal", priority));
+            print(measurements.back(), config.histogram);
+        }
+    }
+
+    load.reset();
+
+    if ( !config.json_path.empty() ) {
+        std::ofstream json(config.json_path);
+        if ( !json ) {
+            std::cerr << "Could not open " << config.json_path << '\n';
+            return EXIT_FAILURE;
+        }
+        write_json(json, config, measurements);
+    }
+}
@@ -0,0 +1,69 @@
+// simply_bench - runs all registered benchmark suites
+//
+// Usage: simply_bench [--filter TEXT] [--json FILE] [--pin CPU]
+//                     [--repetitions N] [--warmup N] [--min-time MS]
+//                     [--list]
+
+#include "bench.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+static void usage() {
+    std::cerr << "Usage: simply_bench [--filter TEXT] [--json FILE] [--pin CPU]\n"
+                 "                    [--repetitions N] [--warmup N] [--min-time MS]\n"
+                 "                    [--list]\n";
+}
+
+int main(int argc, char** argv) {
+    simply::bench::Options opt;
+    std::string json_path;
+    bool list = false;
+
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg  = argv[i];
+        bool has_value   = i + 1 < argc;
+
+        if ( arg == "--filter" && has_value )
+            opt.filter = argv[++i];
+        else if ( arg == "--json" && has_value )
+            json_path = argv[++i];
+        else if ( arg == "--pin" && has_value )
+            opt.pin = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if ( arg == "--repetitions" && has_value )
+            opt.repetitions = std::stoul(argv[++i]);
+        else if ( arg == "--warmup" && has_value )
+            opt.warmup = std::stoul(argv[++i]);
+        else if ( arg == "--min-time" && has_value )
+            opt.min_time = std::chrono::milliseconds(std::stoul(argv[++i]));
+        else if ( arg == "--list" )
+            list = true;
+        else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ( list ) {
+        for ( const auto& [name, suite]: simply::bench::suites() )
+            std::cout << name << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    simply::bench::Runner runner(opt);
+    for ( const auto& [name, suite]: simply::bench::suites() )
+        suite(runner);
+
+    runner.write_table(std::cout);
+
+    if ( !json_path.empty() ) {
+        std::ofstream json(json_path);
+        if ( !json ) {
+            std::cerr << "Could not open " << json_path << '\n';
+            return EXIT_FAILURE;
+        }
+        runner.write_json(json);
+    }
+}
@@ -0,0 +1,82 @@
+// Large-buffer copy and fill - simply::parallel_memcpy/parallel_memset
+// against std::memcpy/std::memset
+//
+// - memcpy/std/SIZE:          a single std::memcpy
+// - memcpy/parallel/SIZE/N:   parallel_memcpy with at most N threads,
+//                             for N = 1, 2, 4, ... up to the CPU count
+// - memset/...:               the same for filling
+//
+// Reported per operation (one whole buffer), so bandwidth is SIZE
+// divided by the time. Buffers are touched beforehand, so page faults
+// are not measured. N = 1 shows the gain of non-temporal stores alone,
+// and the curve over N where bandwidth saturates, as used by
+// `calibrate_parallel_memory`.
+
+#include "bench.h"
+
+#include <simply/parallel_memory.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+using simply::bench::Clock;
+
+std::string size_name(size_t size) {
+    return std::to_string(size >> 20) + "MB";
+}
+}
+
+SIMPLY_BENCHMARK(memory) {
+    std::vector<unsigned> thread_counts;
+    const unsigned most = std::max(simply::Thread::hardware_concurrency(), 1u);
+    for ( unsigned n = 1; ; n = std::min(n * 2, most) ) {
+        thread_counts.push_back(n);
+        if ( n == most )
+            break;
+    }
+
+    for ( size_t size: {size_t(16) << 20, size_t(256) << 20} ) {
+        std::vector<char> from(size, 1);
+        std::vector<char> to(size, 0);
+        const std::string name = size_name(size);
+
+        runner.run_manual("memcpy/std/" + name, [&](uint64_t iterations){
+            auto start = Clock::now();
+            for ( uint64_t i = 0; i < iterations; i++ ) {
+                std::memcpy(to.data(), from.data(), size);
+                simply::bench::keep(to[i % size]);
+            }
+            return Clock::now() - start;
+        });
+        for ( unsigned threads: thread_counts )
+            runner.run_manual("memcpy/parallel/" + name + "/" + std::to_string(threads), [&](uint64_t iterations){
+                auto start = Clock::now();
+                for ( uint64_t i = 0; i < iterations; i++ ) {
+                    simply::parallel_memcpy(to.data(), from.data(), size, threads);
+                    simply::bench::keep(to[i % size]);
+                }
+                return Clock::now() - start;
+            });
+
+        runner.run_manual("memset/std/" + name, [&](uint64_t iterations){
+            auto start = Clock::now();
+            for ( uint64_t i = 0; i < iterations; i++ ) {
+                std::memset(to.data(), static_cast<int>(i), size);
+                simply::bench::keep(to[i % size]);
+            }
+            return Clock::now() - start;
+        });
+        for ( unsigned threads: thread_counts )
+            runner.run_manual("memset/parallel/" + name + "/" + std::to_string(threads), [&](uint64_t iterations){
+                auto start = Clock::now();
+                for ( uint64_t i = 0; i < iterations; i++ ) {
+                    simply::parallel_memset(to.data(), static_cast<int>(i), size, threads);
+                    simply::bench::keep(to[i % size]);
+                }
+                return Clock::now() - start;
+            });
+    }
+}
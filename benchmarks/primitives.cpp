@@ -0,0 +1,78 @@
+// Benchmarks for the library's building blocks, against their
+// standard library equivalents
+
+#include "bench.h"
+
+#include <simply/sharded.h>
+#include <simply/histogram.h>
+#include <simply/bag.h>
+#include <simply/rate_limiter.h>
+#include <simply/task.h>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+SIMPLY_BENCHMARK(primitives) {
+    std::atomic<int64_t> atomic_counter = 0;
+    simply::ShardedCounter sharded_counter;
+    runner.run("counter/std_atomic", [&](){ atomic_counter.fetch_add(1, std::memory_order_relaxed); });
+    runner.run("counter/sharded",    [&](){ sharded_counter.add(); });
+
+    simply::LatencyHistogram histogram;
+    int64_t value = 1;
+    runner.run("histogram/record", [&](){ histogram.record(value = value * 7 % 1000003); });
+
+    simply::ConcurrentBag<int> bag;
+    runner.run("bag/add_take", [&](){ bag.add(1); simply::bench::keep(bag.try_take()); });
+
+    simply::RateLimiter limiter(1e12, 1000000);
+    runner.run("rate_limiter/try_acquire", [&](){ simply::bench::keep(limiter.try_acquire()); });
+
+    // Capture large enough that std::function allocates on common implementations
+    std::array<int64_t, 5> capture{1, 2, 3, 4, 5};
+    runner.run("callable/std_function", [&](){
+        std::function<void()> f([capture](){ simply::bench::keep(capture); });
+        f();
+    });
+    runner.run("callable/task", [&](){
+        simply::Task task([capture](){ simply::bench::keep(capture); });
+        task();
+    });
+}
+
+// Contended: every hardware thread increments at once
+SIMPLY_BENCHMARK(primitives_contended) {
+    const unsigned n_threads = std::max(simply::Thread::hardware_concurrency(), 2u);
+
+    auto contended = [n_threads](auto&& op) {
+        return [n_threads, &op](uint64_t iterations) {
+            std::atomic<bool> go = false;
+            std::vector<simply::Thread> threads;
+            for ( unsigned t = 1; t < n_threads; t++ )
+                threads.emplace_back([&go, &op, iterations](){
+                    while ( !go )
+                        simply::this_thread::yield();
+                    for ( uint64_t i = 0; i < iterations; i++ )
+                        op();
+                });
+
+            auto start = simply::bench::Clock::now();
+            go = true;
+            for ( uint64_t i = 0; i < iterations; i++ )
+                op();
+            for ( auto& t: threads )
+                t.join();
+            return simply::bench::Clock::now() - start;
+        };
+    };
+
+    std::atomic<int64_t> atomic_counter = 0;
+    simply::ShardedCounter sharded_counter;
+    auto atomic_add  = [&](){ atomic_counter.fetch_add(1, std::memory_order_relaxed); };
+    auto sharded_add = [&](){ sharded_counter.add(); };
+
+    runner.run_manual("contended/counter/std_atomic", contended(atomic_add));
+    runner.run_manual("contended/counter/sharded",    contended(sharded_add));
+}
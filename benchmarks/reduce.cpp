@@ -0,0 +1,88 @@
+// Reductions over 64MB of floats - simply::parallel_sum, parallel_dot,
+// parallel_minmax and parallel_count_if per kernel, against std::accumulate
+//
+// - sum/std_accumulate:    a single std::accumulate
+// - OP/KERNEL/1:           one thread, so the kernel's own speed
+// - OP/KERNEL/all:         one thread per CPU
+// for KERNEL in avx512, avx2, sse2 and scalar, as supported, and
+// sum/reproducible/all for the portable kernel's fixed order.
+//
+// Reported per operation (the whole array), so bandwidth is 64MB
+// divided by the time.
+
+#include "bench.h"
+
+#include <simply/parallel_reduce.h>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+using simply::bench::Clock;
+
+const char* kernel_name(simply::Simd simd) {
+    switch ( simd ) {
+    case simply::Simd::AVX512: return "avx512";
+    case simply::Simd::AVX2:   return "avx2";
+    case simply::Simd::SSE2:   return "sse2";
+    default:                   return "scalar";
+    }
+}
+
+// Times f(options) once per iteration
+template <class F>
+void run(simply::bench::Runner& runner, const std::string& name, const simply::ReduceOptions& options, F f) {
+    runner.run_manual(name, [&](uint64_t iterations){
+        auto start = Clock::now();
+        for ( uint64_t i = 0; i < iterations; i++ )
+            simply::bench::keep(f(options));
+        return Clock::now() - start;
+    });
+}
+}
+
+SIMPLY_BENCHMARK(reduce) {
+    std::vector<float> data(size_t(16) << 20); // 64MB, touched
+    for ( size_t i = 0; i < data.size(); i++ )
+        data[i] = static_cast<float>(i % 1000) * 0.001f;
+    const float* values = data.data();
+    const size_t size = data.size();
+
+    runner.run_manual("sum/std_accumulate", [&](uint64_t iterations){
+        auto start = Clock::now();
+        for ( uint64_t i = 0; i < iterations; i++ )
+            simply::bench::keep(std::accumulate(data.begin(), data.end(), 0.0f));
+        return Clock::now() - start;
+    });
+
+    for ( auto simd: {simply::Simd::AVX512, simply::Simd::AVX2, simply::Simd::SSE2, simply::Simd::SCALAR} ) {
+        if ( simd < simply::supported_simd() )
+            continue;
+        for ( unsigned threads: {1u, 0u} ) {
+            simply::ReduceOptions opt;
+            opt.simd = simd;
+            opt.threads = threads;
+            const std::string suffix = std::string("/") + kernel_name(simd) + (threads ? "/1" : "/all");
+
+            run(runner, "sum" + suffix, opt, [=](const simply::ReduceOptions& o){
+                return simply::parallel_sum(values, size, o);
+            });
+            run(runner, "dot" + suffix, opt, [=](const simply::ReduceOptions& o){
+                return simply::parallel_dot(values, values, size, o);
+            });
+            run(runner, "minmax" + suffix, opt, [=](const simply::ReduceOptions& o){
+                return simply::parallel_minmax(values, size, o).second;
+            });
+            run(runner, "count_if" + suffix, opt, [=](const simply::ReduceOptions& o){
+                return simply::parallel_count_if(values, size, simply::Compare::LESS, 0.5f, o);
+            });
+        }
+    }
+
+    simply::ReduceOptions reproducible;
+    reproducible.reproducible = true;
+    run(runner, "sum/reproducible/all", reproducible, [=](const simply::ReduceOptions& o){
+        return simply::parallel_sum(values, size, o);
+    });
+}
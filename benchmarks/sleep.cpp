@@ -0,0 +1,269 @@
+// simply_sleep - how far this_thread sleeps overshoot what was asked
+//
+// For each system timer period, background load and priority, a thread
+// is started with that priority (and optionally affinity), and records
+// how much longer than requested each call takes:
+// - sleep:     `this_thread::sleep(ms)`, relying on the system timer
+// - sleep_for: `this_thread::sleep_for(us)`, a high-resolution timer
+//              followed by yielding for the final stretch
+//
+// Waking early is counted separately, as both promise to sleep for at
+// least the requested time.
+//
+// {note: Windows} The timer period (`--periods`) is set with
+//                 `timeBeginPeriod`, and affects the whole system while
+//                 set. "default" leaves it as it is, usually 15.6ms
+//                 unless another process has lowered it.
+//
+// Usage: simply_sleep [--priority NAME|all] [--ms N,N,..] [--us N,N,..]
+//                     [--samples N] [--periods default|MS,..] [--cpu 0-63]
+//                     [--load N] [--json FILE]
+
+#include "tools.h"
+
+#include <simply/concurrency.h>
+#include <simply/histogram.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mmsystem.h>
+
+namespace {
+using Clock    = std::chrono::steady_clock;
+using Priority = simply::Thread::Priority;
+using simply::bench::priority_name;
+
+struct Config {
+    std::vector<Priority> priorities = simply::bench::priorities();
+    std::vector<size_t> sleep_ms     = {1, 2, 5};
+    std::vector<size_t> sleep_for_us = {100, 500, 1000};
+    size_t samples = 200;
+    std::vector<unsigned> periods    = {0, 1}; // 0 for the default period
+    std::optional<unsigned> cpu;
+    unsigned load  = 0;                         // Also run with this many busy threads
+    std::string json_path;
+};
+
+struct Measurement {
+    unsigned period;
+    unsigned load;
+    Priority priority;
+    std::string call;
+    std::chrono::microseconds requested;
+    size_t early = 0;
+    std::optional<simply::LatencyHistogram::Snapshot> snapshot; // Empty if unavailable
+};
+
+std::string period_name(unsigned period) {
+    return period ? std::to_string(period) + "ms" : "default";
+}
+
+simply::Thread::Options thread_options(const Config& config, Priority priority) {
+    return simply::bench::thread_options(priority, config.cpu);
+}
+
+// Records overshoot of each call, counting early wakes apart
+template <class F>
+size_t measure_calls(size_t samples, std::chrono::microseconds requested,
+                     simply::LatencyHistogram& histogram, F&& sleep) {
+    size_t early = 0;
+    for ( size_t i = 0; i < samples; i++ ) {
+        const auto start = Clock::now();
+        sleep();
+        const auto overshoot = Clock::now() - start - requested;
+        if ( overshoot.count() < 0 )
+            early++;
+        histogram.record(overshoot);
+    }
+    return early;
+}
+
+Measurement measure(const Config& config, unsigned period, unsigned load, Priority priority,
+                    const std::string& call, std::chrono::microseconds requested) {
+    Measurement m{period, load, priority, call, requested};
+    simply::LatencyHistogram histogram;
+    try {
+        simply::Thread t(thread_options(config, priority), [&](){
+            if ( call == "sleep" )
+                m.early = measure_calls(config.samples, requested, histogram, [&](){
+                    simply::this_thread::sleep(static_cast<size_t>(requested.count() / 1000));
+                });
+            else
+                m.early = measure_calls(config.samples, requested, histogram, [&](){
+                    simply::this_thread::sleep_for(requested);
+                });
+        });
+    }
+    catch ( const std::system_error& ) {
+        // For example TIME_CRITICAL without sufficient rights
+        return m;
+    }
+    m.snapshot = histogram.snapshot();
+    return m;
+}
+
+void print(const Measurement& m) {
+    std::cout << std::left << std::setw(9) << period_name(m.period) << std::right << std::setw(5) << m.load
+              << "  " << std::left << std::setw(15) << priority_name(m.priority)
+              << std::setw(10) << m.call << std::right << std::setw(9) << m.requested.count();
+    if ( !m.snapshot ) {
+        std::cout << "  unavailable\n";
+        return;
+    }
+
+    const auto& s = *m.snapshot;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(10) << s.min() / 1e3
+              << std::setw(10) << s.percentile(50) / 1e3
+              << std::setw(10) << s.percentile(90) / 1e3
+              << std::setw(10) << s.percentile(99) / 1e3
+              << std::setw(10) << s.max() / 1e3
+              << std::setw(7) << m.early << '\n';
+}
+
+void write_json(std::ostream& ost, const Config& config, const std::vector<Measurement>& measurements) {
+    ost << "{\n  \"samples\": " << config.samples
+        << ",\n  \"cpu\": " << (config.cpu ? std::to_string(*config.cpu) : "null")
+        << ",\n  \"results\": [";
+
+    for ( size_t i = 0; i < measurements.size(); i++ ) {
+        const Measurement& m = measurements[i];
+        ost << (i ? "," : "") << "\n    {\"period\": \"" << period_name(m.period)
+            << "\", \"load\": " << m.load
+            << ", \"priority\": \"" << priority_name(m.priority)
+            << "\", \"call\": \"" << m.call
+            << "\", \"requested_us\": " << m.requested.count();
+        if ( m.snapshot ) {
+            const auto& s = *m.snapshot;
+            ost << ", \"early\": " << m.early
+                << ", \"overshoot_ns\": {\"min\": " << s.min() << ", \"p50\": " << s.percentile(50)
+                << ", \"p90\": " << s.percentile(90) << ", \"p99\": " << s.percentile(99)
+                << ", \"max\": " << s.max() << ", \"mean\": " << s.mean() << "}";
+        }
+        else
+            ost << ", \"overshoot_ns\": null";
+        ost << "}";
+    }
+    ost << "\n  ]\n}\n";
+}
+
+// Comma-separated list, where "default" stands for 0
+template <class T>
+std::vector<T> parse_list(const std::string& text) {
+    std::vector<T> values;
+    std::stringstream stream(text);
+    std::string item;
+    while ( std::getline(stream, item, ',') )
+        values.push_back(item == "default" ? T(0) : static_cast<T>(std::stoul(item)));
+    return values;
+}
+
+void usage() {
+    simply::bench::usage("simply_sleep", {
+        "[--priority NAME|all] [--ms N,N,..] [--us N,N,..]",
+        "[--samples N] [--periods default|MS,..] [--cpu 0-63]",
+        "[--load N] [--json FILE]"
+    });
+}
+}
+
+int main(int argc, char** argv) {
+    Config config;
+
+    for ( int i = 1; i < argc; i++ ) {
+        std::string arg = argv[i];
+        bool has_value  = i + 1 < argc;
+
+        if ( arg == "--priority" && has_value ) {
+            std::string name = argv[++i];
+            if ( name != "all" ) {
+                auto priority = simply::bench::parse_priority(name);
+                if ( !priority ) {
+                    usage();
+                    return EXIT_FAILURE;
+                }
+                config.priorities = {*priority};
+            }
+        }
+        else if ( arg == "--ms" && has_value )
+            config.sleep_ms = parse_list<size_t>(argv[++i]);
+        else if ( arg == "--us" && has_value )
+            config.sleep_for_us = parse_list<size_t>(argv[++i]);
+        else if ( arg == "--samples" && has_value )
+            config.samples = std::stoul(argv[++i]);
+        else if ( arg == "--periods" && has_value )
+            config.periods = parse_list<unsigned>(argv[++i]);
+        else if ( arg == "--cpu" && has_value ) {
+            config.cpu = simply::bench::parse_cpu(argv[++i]);
+            if ( !config.cpu ) {
+                usage();
+                return EXIT_FAILURE;
+            }
+        }
+        else if ( arg == "--load" && has_value )
+            config.load = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if ( arg == "--json" && has_value )
+            config.json_path = argv[++i];
+        else {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<unsigned> loads = {0};
+    if ( config.load )
+        loads.push_back(config.load);
+
+    std::cout << "Overshoot in microseconds, early = calls returning before the requested time\n"
+              << std::left << std::setw(9) << "period" << std::right << std::setw(5) << "load"
+              << "  " << std::left << std::setw(15) << "priority" << std::setw(10) << "call"
+              << std::right << std::setw(9) << "req us" << std::setw(10) << "min"
+              << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+              << std::setw(10) << "max" << std::setw(7) << "early" << '\n';
+
+    std::vector<Measurement> measurements;
+    for ( unsigned period: config.periods ) {
+        if ( period && timeBeginPeriod(period) != TIMERR_NOERROR ) {
+            std::cerr << "Timer period of " << period << "ms is not supported, skipped\n";
+            continue;
+        }
+
+        for ( unsigned load: loads ) {
+            // Background load, on the same CPU if pinned
+            simply::bench::BusyLoad busy(load, config.cpu);
+
+            for ( Priority priority: config.priorities ) {
+                for ( size_t ms: config.sleep_ms ) {
+                    measurements.push_back(measure(config, period, load, priority, "sleep",
+                                                   std::chrono::milliseconds(ms)));
+                    print(measurements.back());
+                }
+                for ( size_t us: config.sleep_for_us ) {
+                    measurements.push_back(measure(config, period, load, priority, "sleep_for",
+                                                   std::chrono::microseconds(us)));
+                    print(measurements.back());
+                }
+            }
+        }
+
+        if ( period )
+            timeEndPeriod(period);
+    }
+
+    if ( !config.json_path.empty() ) {
+        std::ofstream json(config.json_path);
+        if ( !json ) {
+            std::cerr << "Could not open " << config.json_path << '\n';
+            return EXIT_FAILURE;
+        }
+        write_json(json, config, measurements);
+    }
+}
@@ -0,0 +1,120 @@
+// Thread lifecycle benchmarks - simply::Thread against std::thread
+// and std::jthread
+//
+// - spawn_latency:   from constructor call to the thread's first instruction
+// - spawn_join:      full round trip of starting and joining a thread
+// - concurrent/N:    starting N threads, then joining all of them
+// - join_poll:       cost of a `join(0)` on a still running thread
+//
+// The `simply_priority` variants set `Options::priority`, which starts
+// the thread suspended to set its priority before resuming it.
+
+#include "bench.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <string>
+#include <vector>
+
+namespace {
+using simply::bench::Clock;
+
+// Each kind of thread, started the same way
+struct SimplyKind {
+    static constexpr const char* name = "simply";
+    template <class F>
+    static simply::Thread start(F&& f) { return simply::Thread(std::forward<F>(f)); }
+};
+
+struct SimplyPriorityKind {
+    static constexpr const char* name = "simply_priority";
+    template <class F>
+    static simply::Thread start(F&& f) {
+        return simply::Thread({ simply::Thread::Priority::NORMAL }, std::forward<F>(f));
+    }
+};
+
+struct StdKind {
+    static constexpr const char* name = "std_thread";
+    template <class F>
+    static std::thread start(F&& f) { return std::thread(std::forward<F>(f)); }
+};
+
+#if SIMPLY_C20plus
+struct JthreadKind {
+    static constexpr const char* name = "std_jthread";
+    template <class F>
+    static std::jthread start(F&& f) { return std::jthread(std::forward<F>(f)); }
+};
+#endif
+
+template <class Kind>
+void lifecycle(simply::bench::Runner& runner) {
+    const std::string kind = Kind::name;
+
+    runner.run_manual("thread/spawn_latency/" + kind, [](uint64_t iterations){
+        Clock::duration total{};
+        for ( uint64_t i = 0; i < iterations; i++ ) {
+            Clock::time_point first;
+            auto start = Clock::now();
+            auto t = Kind::start([&first](){ first = Clock::now(); });
+            t.join();
+            total += first - start;
+        }
+        return total;
+    });
+
+    runner.run_manual("thread/spawn_join/" + kind, [](uint64_t iterations){
+        auto start = Clock::now();
+        for ( uint64_t i = 0; i < iterations; i++ ) {
+            auto t = Kind::start([](){});
+            t.join();
+        }
+        return Clock::now() - start;
+    });
+
+    for ( uint64_t n_threads: {1, 10, 100, 1000} ) {
+        runner.run_fixed("thread/concurrent/" + std::to_string(n_threads) + "/" + kind, n_threads,
+            [](uint64_t n){
+                using T = decltype(Kind::start([](){}));
+                std::vector<T> threads;
+                threads.reserve(n);
+
+                auto start = Clock::now();
+                for ( uint64_t i = 0; i < n; i++ )
+                    threads.push_back(Kind::start([](){}));
+                for ( auto& t: threads )
+                    t.join();
+                return Clock::now() - start;
+            });
+    }
+}
+}
+
+SIMPLY_BENCHMARK(thread_lifecycle) {
+    lifecycle<SimplyKind>(runner);
+    lifecycle<SimplyPriorityKind>(runner);
+    lifecycle<StdKind>(runner);
+#if SIMPLY_C20plus
+    lifecycle<JthreadKind>(runner);
+#endif
+
+    // Polling a running thread - std::thread cannot time out a join,
+    // so the closest standard equivalent is polling a std::future
+    std::atomic<bool> done = false;
+    {
+        simply::Thread t([&done](){
+            while ( !done )
+                simply::this_thread::sleep(1);
+        });
+        runner.run("thread/join_poll/simply", [&t](){ simply::bench::keep(t.join(0)); });
+        done = true;
+    }
+
+    std::promise<void> promise;
+    std::future<void> future = promise.get_future();
+    runner.run("thread/join_poll/std_future", [&future](){
+        simply::bench::keep(future.wait_for(std::chrono::seconds(0)));
+    });
+}
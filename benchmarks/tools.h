@@ -0,0 +1,146 @@
+/// tools.h
+/// Helpers shared by the standalone timing tools
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Used only by simply_latency (latency.cpp) and simply_sleep
+/// (sleep.cpp), which measure per Thread::Priority, optionally pinned
+/// to a CPU and under a background load.
+#ifndef SIMPLY_BENCH_TOOLS_HPP_
+#define SIMPLY_BENCH_TOOLS_HPP_
+
+#include <simply/concurrency.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace simply::bench {
+// =====================================================================
+// Tools >> Declarations
+// =====================================================================
+///   priorities
+/// Every Thread::Priority, lowest first
+std::vector<Thread::Priority> priorities();
+
+///   priority_name
+/// Name of the priority, as in the enumeration
+const char* priority_name(Thread::Priority priority);
+
+///   parse_priority
+/// Priority of the given name, empty if none
+std::optional<Thread::Priority> parse_priority(const std::string& name);
+
+///   parse_cpu
+/// CPU of the given number, empty if past an affinity mask (64 or more)
+///
+/// Throws as `std::stoul` if not a number
+std::optional<unsigned> parse_cpu(const std::string& text);
+
+///   thread_options
+/// Options for a thread at priority, pinned to cpu if given
+Thread::Options thread_options(Thread::Priority priority, std::optional<unsigned> cpu);
+
+///   usage
+/// Print "Usage: tool" to std::cerr, followed by lines of options
+/// aligned after the tool's name
+void usage(const char* tool, std::initializer_list<const char*> lines);
+
+///   BusyLoad
+/// Busy threads at NORMAL priority, on cpu if given, until destroyed
+class BusyLoad final {
+public:
+    BusyLoad(unsigned threads, std::optional<unsigned> cpu);
+    ~BusyLoad();
+
+    BusyLoad(const BusyLoad&) = delete;
+    BusyLoad& operator=(const BusyLoad&) = delete;
+
+private:
+    std::atomic<bool> _stop{false};
+    std::vector<Thread> _threads;
+};
+
+// =====================================================================
+// Tools >> Implementations
+// =====================================================================
+inline std::vector<Thread::Priority> priorities() {
+    using Priority = Thread::Priority;
+    return {
+        Priority::LOWEST, Priority::LOW, Priority::NORMAL,
+        Priority::HIGH, Priority::HIGHEST, Priority::TIME_CRITICAL
+    };
+}
+
+inline const char* priority_name(Thread::Priority priority) {
+    using Priority = Thread::Priority;
+    switch ( priority ) {
+        case Priority::LOWEST:        return "LOWEST";
+        case Priority::LOW:           return "LOW";
+        case Priority::NORMAL:        return "NORMAL";
+        case Priority::HIGH:          return "HIGH";
+        case Priority::HIGHEST:       return "HIGHEST";
+        case Priority::TIME_CRITICAL: return "TIME_CRITICAL";
+    }
+    return "UNKNOWN";
+}
+
+inline std::optional<Thread::Priority> parse_priority(const std::string& name) {
+    for ( Thread::Priority priority: priorities() )
+        if ( name == priority_name(priority) )
+            return priority;
+    return std::nullopt;
+}
+
+inline std::optional<unsigned> parse_cpu(const std::string& text) {
+    const unsigned long cpu = std::stoul(text);
+    if ( cpu >= 64 )
+        return std::nullopt;
+    return static_cast<unsigned>(cpu);
+}
+
+inline Thread::Options thread_options(Thread::Priority priority, std::optional<unsigned> cpu) {
+    Thread::Options opt;
+    opt.priority = priority;
+    if ( cpu )
+        opt.affinity = uint64_t(1) << *cpu;
+    return opt;
+}
+
+inline void usage(const char* tool, std::initializer_list<const char*> lines) {
+    const std::string indent(std::strlen("Usage: ") + std::strlen(tool), ' ');
+    std::cerr << "Usage: " << tool;
+    bool first = true;
+    for ( const char* line: lines ) {
+        std::cerr << (first ? "" : indent) << ' ' << line << '\n';
+        first = false;
+    }
+}
+
+inline BusyLoad::BusyLoad(unsigned threads, std::optional<unsigned> cpu) {
+    try {
+        for ( unsigned i = 0; i < threads; i++ )
+            _threads.emplace_back(thread_options(Thread::Priority::NORMAL, cpu), [this](){
+                while ( !_stop.load(std::memory_order_relaxed) )
+                    ;
+            });
+    }
+    catch ( ... ) {
+        _stop = true; // The destructor is not called, so stop those started
+        throw;
+    }
+}
+
+inline BusyLoad::~BusyLoad() {
+    _stop = true;
+    // Destroying each Thread joins it
+}
+}
+
+#endif // SIMPLY_BENCH_TOOLS_HPP_
@@ -0,0 +1,221 @@
+/// bag.h
+/// Unordered concurrent pool with per-thread lists
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// When the order items come back out in does not matter, for example
+/// when recycling buffers or work items, a FIFO queue pays for ordering
+/// it does not need. `ConcurrentBag` (like .NET's `ConcurrentBag<T>`)
+/// instead gives each thread its own list, picked by its
+/// `this_thread::get_index()`. A thread adds to and takes from its own
+/// list, and only steals from other threads' lists once its own is empty.
+///
+///   Classes
+/// simply::ConcurrentBag<T>
+///     Unordered collection, safe to add to and take from on any thread.
+#ifndef SIMPLY_BAG_HPP_
+#define SIMPLY_BAG_HPP_
+
+#include "concurrency.h"
+#include "sharded.h"
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// ConcurrentBag >> Helpers
+// =====================================================================
+// Held only for a push/pop, so spinning beats sleeping on an OS lock
+class _SpinLock final {
+public:
+    bool try_lock() noexcept {
+        return !_locked.load(std::memory_order_relaxed)
+            && !_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void lock() noexcept {
+        while ( !try_lock() )
+            this_thread::yield();
+    }
+
+    void unlock() noexcept {
+        _locked.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> _locked{false};
+};
+
+// =====================================================================
+// ConcurrentBag >> Declaration
+// =====================================================================
+///   ConcurrentBag
+/// Unordered collection of T, safe to use from any number of threads
+///
+///   Behaviours
+/// - No ordering
+///     Items taken on the thread that added them come back last-in
+///     first-out, any other order is unspecified.
+/// - Stealing
+///     `try_take` only looks at other threads' lists if the calling
+///     thread's list is empty. Lists currently used by another thread
+///     are skipped rather than waited for, so `try_take` may return
+///     `std::nullopt` while items are being added elsewhere.
+/// - Sharing lists
+///     Threads with indices beyond the number of lists share lists,
+///     which remains correct but adds contention.
+///
+///   Example
+/// ```
+/// simply::ConcurrentBag<std::vector<char>> buffers;
+///
+/// auto buffer = buffers.try_take().value_or(std::vector<char>(4096));
+/// ... // Use buffer
+/// buffers.add(std::move(buffer));
+/// ```
+template <class T>
+class ConcurrentBag final {
+public:
+    ///   Constructor
+    /// Uses one list per hardware thread (rounded up to a power of 2)
+    ConcurrentBag();
+
+    ///   Constructor
+    /// Uses (at least) the given number of lists
+    explicit ConcurrentBag(size_t lists);
+
+    ///   No copying or moving
+    ConcurrentBag(const ConcurrentBag&) = delete;
+    ConcurrentBag& operator=(const ConcurrentBag&) = delete;
+
+    ///   add
+    /// Add an item to the calling thread's list
+    void add(T value);
+
+    ///   emplace
+    /// Construct an item in the calling thread's list
+    template <class... Args>
+    void emplace(Args&&... args);
+
+    ///   try_take
+    /// Take any item, preferring the calling thread's list
+    ///
+    /// Returns `std::nullopt` if no item could be found
+    SIMPLY_NODISCARD std::optional<T> try_take();
+
+    ///   size
+    /// Number of items across all lists
+    ///
+    /// Only a hint while other threads are adding or taking
+    SIMPLY_NODISCARD size_t size() const noexcept;
+
+    ///   empty
+    /// Whether there are no items across all lists
+    ///
+    /// Only a hint while other threads are adding or taking
+    SIMPLY_NODISCARD bool empty() const noexcept;
+
+private:
+    struct _List {
+        _SpinLock lock;
+        std::atomic<size_t> size{0}; // Lets stealers skip empty lists without locking
+        std::vector<T> items;
+    };
+
+    std::optional<T> _pop(_List& list);
+
+    _Shards<_List> _lists;
+};
+
+// =====================================================================
+// ConcurrentBag >> Implementations
+// =====================================================================
+template <class T>
+ConcurrentBag<T>::ConcurrentBag(): ConcurrentBag(_shard_count()) {}
+
+template <class T>
+ConcurrentBag<T>::ConcurrentBag(size_t lists): _lists(lists) {}
+
+template <class T>
+void ConcurrentBag<T>::add(T value) {
+    emplace(std::move(value));
+}
+
+template <class T>
+template <class... Args>
+void ConcurrentBag<T>::emplace(Args&&... args) {
+    _List& list = _lists.local();
+    std::lock_guard<_SpinLock> guard(list.lock);
+    list.items.emplace_back(std::forward<Args>(args)...);
+    list.size.store(list.items.size(), std::memory_order_relaxed);
+}
+
+template <class T>
+std::optional<T> ConcurrentBag<T>::_pop(_List& list) {
+    std::optional<T> item;
+    if ( !list.items.empty() ) {
+        item.emplace(std::move(list.items.back()));
+        list.items.pop_back();
+        list.size.store(list.items.size(), std::memory_order_relaxed);
+    }
+    return item;
+}
+
+template <class T>
+std::optional<T> ConcurrentBag<T>::try_take() {
+    const size_t local = this_thread::get_index() & (_lists.size() - 1);
+
+    // Own list - wait for the lock, it is almost always free
+    _List& own = _lists[local];
+    if ( own.size.load(std::memory_order_relaxed) ) {
+        std::lock_guard<_SpinLock> guard(own.lock);
+        if ( std::optional<T> item = _pop(own) )
+            return item;
+    }
+
+    // Steal - skip any list which is empty or busy
+    for ( size_t i = 1; i < _lists.size(); i++ ) {
+        _List& other = _lists[(local + i) & (_lists.size() - 1)];
+        if ( !other.size.load(std::memory_order_relaxed) )
+            continue;
+        std::unique_lock<_SpinLock> guard(other.lock, std::try_to_lock);
+        if ( !guard )
+            continue;
+        if ( std::optional<T> item = _pop(other) )
+            return item;
+    }
+
+    return std::nullopt;
+}
+
+template <class T>
+size_t ConcurrentBag<T>::size() const noexcept {
+    size_t total = 0;
+    for ( size_t i = 0; i < _lists.size(); i++ )
+        total += _lists[i].size.load(std::memory_order_relaxed);
+    return total;
+}
+
+template <class T>
+bool ConcurrentBag<T>::empty() const noexcept {
+    for ( size_t i = 0; i < _lists.size(); i++ )
+        if ( _lists[i].size.load(std::memory_order_relaxed) )
+            return false;
+    return true;
+}
+}
+
+#endif // SIMPLY_BAG_HPP_
@@ -46,8 +46,74 @@
 ///     determined by the system.
 ///
 /// simply::this_thread::sleep
-///     To sleep for a minimum (and often almost exact)
-///     number of milliseconds
+///     To sleep for a minimum number of milliseconds. How close to
+///     exact depends on the system timer period, which can be measured
+///     with `simply_sleep` (in benchmarks/).
+///
+/// simply::this_thread::sleep_for / sleep_until
+///     To sleep with sub-millisecond precision, for a duration or
+///     until a deadline on `std::chrono::steady_clock`.
+///
+/// simply::this_thread::get_index
+///     To get a small, reusable index for the current thread, for
+///     example to pick a per-thread shard of some shared data.
+///
+///   Other headers
+/// simply/sharded.h
+///     Counters, maxima and histograms sharded per thread, for
+///     statistics updated from many threads at once.
+///
+/// simply/histogram.h
+///     Log-linear latency histogram, with percentile queries.
+///
+/// simply/bag.h
+///     Unordered pool with per-thread lists, for recycling items.
+///
+/// simply/rate_limiter.h
+///     Lock-free (GCRA) rate limiter, shared between threads.
+///
+/// simply/task.h
+///     Move-only `void()` callable with inline storage, used as the
+///     payload for work handed between threads.
+///
+/// simply/trace.h
+///     Tracing of threads, tasks and user spans, to Chrome's format.
+///
+/// simply/mutex.h
+///     Mutexes and condition variables, with optional contention profiling.
+///
+/// simply/executor_metrics.h
+///     Per-worker metrics for thread pools, with a Prometheus text dump.
+///
+/// simply/watchdog.h
+///     Reports worker threads stalled inside a task, with their stacks.
+///
+/// simply/flight_recorder.h
+///     Always-on per-thread rings of recent events, dumped after a crash.
+///
+/// simply/logger.h
+///     Asynchronous logger, formatting and writing on a background thread.
+///
+/// simply/io_pool.h
+///     Elastic pool of threads for blocking calls, such as file I/O.
+///
+/// simply/io_ring.h
+///     Asynchronous file I/O, completed on a single reactor thread.
+///
+/// simply/loop_thread.h
+///     Thread running a loop, onto which other threads post work.
+///
+/// simply/parallel_read.h
+///     Memory-mapped files, processed in record-aligned chunks by many threads.
+///
+/// simply/parallel_memory.h
+///     Multi-threaded memcpy and memset for large buffers.
+///
+/// simply/parallel_reduce.h
+///     Multi-threaded sum, dot product, min/max and counting, with SIMD kernels.
+///
+/// simply/cpu_features.h
+///     Detection of AVX, AVX2 and AVX-512, used by the SIMD kernels above.
 ///
 /// Support for other operating systems will come later...
 ///
@@ -85,7 +151,12 @@
 #include <utility>
 #include <memory>
 #include <functional>
+#include <chrono>
 #include <system_error>
+#include <atomic>
+#include <cstdint>
+#include <climits>
+#include <vector>
 
 #if SIMPLY_C20plus
     #include <stop_token>
@@ -159,6 +230,14 @@ public:
     /// Thread startup options
     class Options;
 
+    ///   Stats
+    /// CPU usage and scheduling statistics of a thread
+    class Stats;
+
+    ///   Info
+    /// Description of a live thread, as listed by `enumerate`
+    class Info;
+
     ///   Priority
     /// Provided to make a cross-platform abstraction, such that the same
     /// code can run on Windows, (and when later supported) Linux and macOS
@@ -230,6 +309,25 @@ public:
     /// Get the priority of the thread this represents
     SIMPLY_NODISCARD Priority get_priority() const noexcept;
 
+    ///   stats
+    /// Get CPU usage and scheduling statistics of the thread
+    ///
+    /// Cheap enough to sample periodically across many threads, see
+    /// notes in the declaration of `Stats`.
+    ///
+    /// Throws `system_error` if this is a NULL-thread object
+    SIMPLY_NODISCARD Stats stats() const;
+
+    ///   stack_high_water
+    /// Get the most stack the thread has used so far, in bytes
+    ///
+    /// Rounded up to whole pages, see notes in `this_thread::stack_high_water`.
+    /// Empty if the thread has not started running yet, has finished, or
+    /// is not listed by `enumerate`.
+    ///
+    /// Throws `system_error` if this is a NULL-thread object
+    SIMPLY_NODISCARD std::optional<size_t> stack_high_water() const;
+
     ///   native_handle {dangerous}
     /// Get the native handle for the thread, for manual control
     ///
@@ -249,6 +347,18 @@ public:
     ///                 return `64` - Implementation restriction
     SIMPLY_NODISCARD static unsigned int hardware_concurrency() noexcept;
 
+    ///   enumerate
+    /// List all live threads started by `Thread`
+    ///
+    /// A thread is listed from when it starts running its function until
+    /// that function returns, whether or not its `Thread` was detached.
+    /// Threads not started by `Thread` (such as `main`) are not listed.
+    ///
+    /// Safe to call from any thread at any time, for example from an
+    /// admin endpoint or a crash handler. Threads starting or exiting
+    /// meanwhile may or may not be listed.
+    SIMPLY_NODISCARD static std::vector<Info> enumerate();
+
     ///   join
     /// Block until thread finishes execution
     ///
@@ -313,6 +423,21 @@ namespace this_thread {
     /// Get the priority of the current thread
     Thread::Priority get_priority() noexcept;
 
+    ///   stats
+    /// Get CPU usage and scheduling statistics of the current thread
+    Thread::Stats stats();
+
+    ///   stack_high_water
+    /// Get the most stack the current thread has used so far, in bytes
+    ///
+    /// {note: Windows} Stacks are committed a page at a time as they
+    ///                 grow, and never shrink, so this is read from the
+    ///                 committed part of the stack - nothing is written
+    ///                 to the stack in advance. This includes what is
+    ///                 committed at startup (the executable's stack
+    ///                 commit size, usually a page or two).
+    size_t stack_high_water() noexcept;
+
     ///   yield
     /// Yield to another thread of execution
     void yield() noexcept;
@@ -320,6 +445,31 @@ namespace this_thread {
     ///   sleep
     /// Sleep for the specified number of milliseconds
     void sleep(size_t ms_sleep);
+
+    ///   sleep_for
+    /// Sleep for (at least) the given duration, with sub-millisecond precision
+    ///
+    /// Waits on a high-resolution timer for most of the duration, and
+    /// yields for the final stretch. This costs some CPU time, so prefer
+    /// `sleep` where millisecond precision is good enough.
+    void sleep_for(std::chrono::nanoseconds duration);
+
+    ///   sleep_until
+    /// Sleep until (at least) the given time, with sub-millisecond precision
+    ///
+    /// See notes for `sleep_for`
+    void sleep_until(std::chrono::steady_clock::time_point deadline);
+
+    ///   get_index
+    /// Get a small, dense index for the current thread of execution
+    ///
+    /// Indices are handed out lowest-first and reused once a thread exits,
+    /// so they stay close to the number of live threads. This is intended
+    /// for picking per-thread shards, for example in `ShardedCounter`.
+    ///
+    /// Threads started by `Thread` are given their index on startup, any
+    /// other thread (such as `main`) is given one on its first call.
+    size_t get_index() noexcept;
 }
 
 // =====================================================================
@@ -329,15 +479,78 @@ namespace this_thread {
 /// See notes in declaration inside Thread
 ///
 /// Feel free to suggest more features to add
-/// 
-/// Possible future options:
-/// - Stack size
-/// - CPU affinity
 class Thread::Options final {
 public:
     ///   priority
     /// Optionally set
     std::optional<Thread::Priority> priority;
+
+    ///   affinity
+    /// Optionally restrict the thread to a set of CPUs
+    ///
+    /// Bitmask where bit N allows CPU N (of the process' processor group),
+    /// and must be a subset of the process' own affinity.
+    std::optional<uint64_t> affinity;
+
+    ///   stack_size
+    /// Optionally set how much address space to reserve for the stack
+    ///
+    /// Only what the thread actually uses is committed, see
+    /// `Thread::stack_high_water`. Defaults to the executable's stack
+    /// reserve size (usually 1MB).
+    std::optional<size_t> stack_size;
+
+    ///   name
+    /// Optionally name the thread, as listed by `Thread::enumerate`
+    ///
+    /// Names longer than 31 characters are cut short
+    std::optional<std::string> name;
+};
+
+// =====================================================================
+// Thread::Stats >> Full Implementation
+// =====================================================================
+///   Stats
+/// See notes in declaration inside Thread
+///
+/// Times are totals since the thread started, so compare two samples
+/// to get usage over a period. Each sample is a couple of system calls
+/// on the thread's handle (no files read, no locks taken), so sampling
+/// thousands of threads every second is fine.
+///
+/// Statistics not tracked by the system are left empty, so code using
+/// them stays portable.
+///
+/// {note: Windows} `user_time` and `system_time` only advance when a
+///                 clock interrupt finds the thread running (~15.6ms),
+///                 so prefer `cycles` for short-lived measurements.
+///                 Context switches and migrations are not tracked
+///                 per thread, and are always empty.
+class Thread::Stats final {
+public:
+    ///   user_time
+    /// CPU time spent running user code
+    std::chrono::nanoseconds user_time{0};
+
+    ///   system_time
+    /// CPU time spent in the kernel on behalf of the thread
+    std::chrono::nanoseconds system_time{0};
+
+    ///   cycles
+    /// CPU cycles spent running the thread, if available
+    std::optional<uint64_t> cycles;
+
+    ///   voluntary_switches
+    /// Times the thread gave up the CPU, such as to wait, if available
+    std::optional<uint64_t> voluntary_switches;
+
+    ///   involuntary_switches
+    /// Times the thread was preempted, if available
+    std::optional<uint64_t> involuntary_switches;
+
+    ///   migrations
+    /// Times the thread was moved to another CPU, if available
+    std::optional<uint64_t> migrations;
 };
 
 // =====================================================================
@@ -399,14 +612,66 @@ template <>
 struct hash<simply::Thread::id>;
 }
 
+namespace simply {
+// =====================================================================
+// Thread::Info >> Full Implementation
+// =====================================================================
+///   Info
+/// See notes in declaration inside Thread
+///
+/// A snapshot, which may already be out of date once returned.
+class Thread::Info final {
+public:
+    ///   State
+    /// What a thread is doing, as far as `Thread` can tell
+    ///
+    /// Only waits made through this library are seen, a thread blocked
+    /// in any other call is still RUNNING.
+    enum class State { RUNNING, SLEEPING, JOINING };
+
+    ///   id
+    Thread::id id;
+
+    ///   name
+    /// As given in `Options::name`, or empty
+    std::string name;
+
+    ///   priority
+    /// Current priority, if the thread could still be queried
+    std::optional<Thread::Priority> priority;
+
+    ///   affinity
+    /// As given in `Options::affinity`, if given
+    std::optional<uint64_t> affinity;
+
+    ///   started
+    /// When the thread started running its function
+    std::chrono::system_clock::time_point started;
+
+    ///   stats
+    /// CPU usage so far, if the thread could still be queried
+    std::optional<Thread::Stats> stats;
+
+    ///   stack_high_water
+    /// Most stack used so far in bytes, see `Thread::stack_high_water`
+    std::optional<size_t> stack_high_water;
+
+    ///   state
+    State state = State::RUNNING;
+
+    ///   waiting_on
+    /// The thread being joined, if JOINING
+    std::optional<Thread::id> waiting_on;
+};
+}
 
 
 namespace simply {
 // =====================================================================
 // Thread::id >> Implementations
 // =====================================================================
-Thread::id::id() noexcept: _id(GetCurrentThreadId()) {}
-Thread::id::id(DWORD i) noexcept: _id(i) {}
+inline Thread::id::id() noexcept: _id(GetCurrentThreadId()) {}
+inline Thread::id::id(DWORD i) noexcept: _id(i) {}
 
 // =====================================================================
 // Thread & this_thread >> System-priority
@@ -430,32 +695,434 @@ inline Thread::Priority _priority(HANDLE handle) noexcept {
         return Thread::Priority::HIGHEST;
 }
 
+// =====================================================================
+// Thread & this_thread >> Event hooks
+// =====================================================================
+// Lets optional layers (such as trace.h) observe what threads are doing.
+// While no hook is installed, each event costs a single relaxed load
+// and a branch which is always predicted right.
+enum class _HookEvent {
+    THREAD_START, THREAD_EXIT,          // From the Thread trampoline
+    JOIN_BEGIN, JOIN_END,               // Thread::join, detail is the joined thread's id
+    SLEEP_BEGIN, SLEEP_END,             // this_thread::sleep and sleep_until
+    TASK_BEGIN, TASK_END,               // Task::operator() (task.h)
+    SPAWN,                              // Thread started, detail is the new thread's id
+    STOP_REQUEST,                       // First stop request, detail is the thread's id
+    LOCK_WAIT_BEGIN, LOCK_WAIT_END      // Contended lock (mutex.h), detail is its address
+};
+
+// Called on the thread the event happened on, so must be thread-safe.
+// Hooks may still be called shortly after removal, so must stay valid.
+using _Hook = void (*)(_HookEvent event, uint64_t detail) noexcept;
+
+constexpr size_t _max_hooks = 4;
+
+inline std::atomic<_Hook> _hooks[_max_hooks];
+inline std::atomic<unsigned> _hook_mask{0}; // Bit per installed hook
+
+inline void _add_hook(_Hook hook) {
+    for ( size_t i = 0; i < _max_hooks; i++ ) {
+        _Hook empty = nullptr;
+        if ( _hooks[i].compare_exchange_strong(empty, hook) ) {
+            _hook_mask.fetch_or(1u << i);
+            return;
+        }
+    }
+    throw std::system_error(
+        std::make_error_code(std::errc::resource_unavailable_try_again),
+        "_add_hook: too many hooks installed"
+    );
+}
+
+inline void _remove_hook(_Hook hook) noexcept {
+    for ( size_t i = 0; i < _max_hooks; i++ ) {
+        if ( _hooks[i].load() == hook ) {
+            _hook_mask.fetch_and(~(1u << i));
+            _hooks[i].store(nullptr);
+            return;
+        }
+    }
+}
+
+inline void _call_hooks(_HookEvent event, uint64_t detail) noexcept {
+    for ( size_t i = 0; i < _max_hooks; i++ )
+        if ( _Hook hook = _hooks[i].load(std::memory_order_acquire) )
+            hook(event, detail);
+}
+
+inline void _notify(_HookEvent event, uint64_t detail = 0) noexcept {
+    if ( _hook_mask.load(std::memory_order_relaxed) )
+        _call_hooks(event, detail);
+}
+
+// =====================================================================
+// Thread & this_thread >> Registry
+// =====================================================================
+// Each thread started by `Thread` describes itself in the slot at its
+// own index (see `this_thread::get_index`), so no two threads ever
+// write the same slot, and registering needs no locks. Readers use the
+// version as a sequence lock, retrying if a slot changed under them.
+constexpr size_t _registry_size = 1024;     // As many as reusable indices
+constexpr size_t _max_thread_name = 32;     // Including terminating null
+
+struct _RegistrySlot {
+    std::atomic<uint32_t> version{0};       // Odd while (un)registering
+    std::atomic<bool> live{false};
+    std::atomic<DWORD> thread{0};
+    std::atomic<char> name[_max_thread_name] = {};
+    std::atomic<int64_t> started{0};        // system_clock ticks
+    std::atomic<bool> has_affinity{false};
+    std::atomic<uint64_t> affinity{0};
+    std::atomic<uintptr_t> stack_low{0};    // Whole reservation
+    std::atomic<uintptr_t> stack_high{0};
+
+    // Written by the owning thread at any time, outside the version
+    std::atomic<Thread::Info::State> state{Thread::Info::State::RUNNING};
+    std::atomic<DWORD> waiting_on{0};
+};
+
+inline _RegistrySlot _registry[_registry_size];
+inline thread_local _RegistrySlot* _registry_local = nullptr;
+
+// Passed to a new thread, to register with
+struct _StartInfo {
+    std::string name;
+    std::optional<uint64_t> affinity;
+};
+
+// Bounds of the calling thread's stack reservation, which grows down
+// from high. GetCurrentThreadStackLimits needs Windows 8, so is looked
+// up, and before it the reservation is found from a local's region.
+inline void _current_stack_limits(uintptr_t& low, uintptr_t& high) noexcept {
+    using Limits = void (WINAPI*)(PULONG_PTR, PULONG_PTR);
+    static const Limits limits = reinterpret_cast<Limits>(
+        GetProcAddress(GetModuleHandleA("kernel32.dll"), "GetCurrentThreadStackLimits"));
+    if ( limits ) {
+        ULONG_PTR stack_low, stack_high;
+        limits(&stack_low, &stack_high);
+        low  = stack_low;
+        high = stack_high;
+        return;
+    }
+
+    MEMORY_BASIC_INFORMATION region = {};
+    if ( !VirtualQuery(&region, &region, sizeof(region)) ) {
+        low = high = 0;
+        return;
+    }
+    const PVOID reservation = region.AllocationBase;
+    uintptr_t end = reinterpret_cast<uintptr_t>(region.BaseAddress) + region.RegionSize;
+    while ( VirtualQuery(reinterpret_cast<LPCVOID>(end), &region, sizeof(region))
+            && region.AllocationBase == reservation )
+        end = reinterpret_cast<uintptr_t>(region.BaseAddress) + region.RegionSize;
+    low  = reinterpret_cast<uintptr_t>(reservation);
+    high = end;
+}
+
+// Registers the calling thread for as long as this lives
+// Threads with an index past the registry are not listed
+class _Registration final {
+public:
+    explicit _Registration(const _StartInfo& info, size_t index) noexcept {
+        if ( index >= _registry_size )
+            return;
+        _RegistrySlot& slot = _registry[index];
+
+        const uint32_t version = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.thread.store(GetCurrentThreadId(), std::memory_order_relaxed);
+        for ( size_t i = 0; i < _max_thread_name; i++ )
+            slot.name[i].store(i < info.name.size() && i + 1 < _max_thread_name ? info.name[i] : '\0',
+                               std::memory_order_relaxed);
+        slot.started.store(std::chrono::system_clock::now().time_since_epoch().count(),
+                           std::memory_order_relaxed);
+        slot.has_affinity.store(info.affinity.has_value(), std::memory_order_relaxed);
+        slot.affinity.store(info.affinity.value_or(0), std::memory_order_relaxed);
+        uintptr_t stack_low, stack_high;
+        _current_stack_limits(stack_low, stack_high);
+        slot.stack_low.store(stack_low, std::memory_order_relaxed);
+        slot.stack_high.store(stack_high, std::memory_order_relaxed);
+        slot.state.store(Thread::Info::State::RUNNING, std::memory_order_relaxed);
+        slot.waiting_on.store(0, std::memory_order_relaxed);
+        slot.live.store(true, std::memory_order_relaxed);
+
+        slot.version.store(version + 2, std::memory_order_release);
+        _registry_local = &slot;
+    }
+
+    ~_Registration() {
+        _RegistrySlot* slot = _registry_local;
+        if ( !slot )
+            return;
+        _registry_local = nullptr;
+
+        const uint32_t version = slot->version.load(std::memory_order_relaxed);
+        slot->version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->live.store(false, std::memory_order_relaxed);
+        slot->version.store(version + 2, std::memory_order_release);
+    }
+
+    _Registration(const _Registration&) = delete;
+    _Registration& operator=(const _Registration&) = delete;
+};
+
+// A consistent copy of a slot's registered details
+struct _SlotCopy {
+    uint32_t version;
+    DWORD thread;
+    char name[_max_thread_name];
+    int64_t started;
+    std::optional<uint64_t> affinity;
+    uintptr_t stack_low;
+    uintptr_t stack_high;
+};
+
+// Returns false if the slot holds no live thread
+inline bool _read_slot(const _RegistrySlot& slot, _SlotCopy& copy) noexcept {
+    for ( ;; ) {
+        copy.version = slot.version.load(std::memory_order_acquire);
+        if ( copy.version & 1 ) {
+            SwitchToThread(); // Being (un)registered right now
+            continue;
+        }
+
+        const bool live = slot.live.load(std::memory_order_relaxed);
+        copy.thread = slot.thread.load(std::memory_order_relaxed);
+        for ( size_t i = 0; i < _max_thread_name; i++ )
+            copy.name[i] = slot.name[i].load(std::memory_order_relaxed);
+        copy.started = slot.started.load(std::memory_order_relaxed);
+        copy.affinity = slot.has_affinity.load(std::memory_order_relaxed)
+            ? std::optional<uint64_t>(slot.affinity.load(std::memory_order_relaxed))
+            : std::nullopt;
+        copy.stack_low  = slot.stack_low.load(std::memory_order_relaxed);
+        copy.stack_high = slot.stack_high.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ( slot.version.load(std::memory_order_relaxed) == copy.version )
+            return live;
+    }
+}
+
+// Finds the slot of a live thread, or nullptr
+inline const _RegistrySlot* _find_slot(DWORD thread, _SlotCopy& copy) noexcept {
+    for ( const _RegistrySlot& slot: _registry )
+        if ( slot.thread.load(std::memory_order_relaxed) == thread
+             && _read_slot(slot, copy) && copy.thread == thread )
+            return &slot;
+    return nullptr;
+}
+
+// Bytes committed at the top of a stack, which grows down from high.
+// Stacks are committed page by page as they grow (past guard pages),
+// and never decommitted, so this is the deepest the stack has been.
+// Safe on stacks of other threads, even if they exit meanwhile.
+inline size_t _stack_committed(uintptr_t low, uintptr_t high) noexcept {
+    MEMORY_BASIC_INFORMATION region;
+    uintptr_t address = low;
+    while ( address < high && VirtualQuery(reinterpret_cast<LPCVOID>(address), &region, sizeof(region)) ) {
+        if ( region.State == MEM_COMMIT && !(region.Protect & PAGE_GUARD) )
+            return high - address;
+        address = reinterpret_cast<uintptr_t>(region.BaseAddress) + region.RegionSize;
+    }
+    return 0;
+}
+
+// Marks what the calling thread is doing, if registered
+inline void _set_state(Thread::Info::State state, DWORD waiting_on = 0) noexcept {
+    if ( _RegistrySlot* slot = _registry_local ) {
+        slot->waiting_on.store(waiting_on, std::memory_order_relaxed);
+        slot->state.store(state, std::memory_order_relaxed);
+    }
+}
+
+// =====================================================================
+// Thread & this_thread >> Statistics
+// =====================================================================
+inline std::chrono::nanoseconds _filetime(const FILETIME& time) noexcept {
+    const uint64_t ticks = (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    return std::chrono::nanoseconds(ticks * 100); // FILETIME counts 100ns
+}
+
+inline Thread::Stats _stats(HANDLE handle) {
+    FILETIME creation, exit, kernel, user;
+    if ( !GetThreadTimes(handle, &creation, &exit, &kernel, &user) )
+        throw std::system_error(GetLastError(), std::system_category());
+
+    Thread::Stats stats;
+    stats.user_time   = _filetime(user);
+    stats.system_time = _filetime(kernel);
+
+    ULONG64 cycles;
+    if ( QueryThreadCycleTime(handle, &cycles) )
+        stats.cycles = cycles;
+
+    return stats;
+}
+
 // =====================================================================
 // this_thread >> Implementations
 // =====================================================================
-Thread::id this_thread::get_id() noexcept 
+inline Thread::id this_thread::get_id() noexcept 
     { return Thread::id(); }
 
-Thread::Priority this_thread::get_priority() noexcept 
+inline Thread::Priority this_thread::get_priority() noexcept 
     { return _priority(GetCurrentThread()); }
 
-void this_thread::yield() noexcept 
+inline Thread::Stats this_thread::stats()
+    { return _stats(GetCurrentThread()); }
+
+inline size_t this_thread::stack_high_water() noexcept {
+    uintptr_t low, high;
+    _current_stack_limits(low, high);
+    return _stack_committed(low, high);
+}
+
+inline void this_thread::yield() noexcept 
     { SwitchToThread(); }
     
-void this_thread::sleep(size_t ms_sleep) 
+inline void this_thread::sleep(size_t ms_sleep) 
     { 
         if ( ms_sleep > static_cast<size_t>(MAXDWORD) )
         throw std::system_error(
             std::make_error_code(std::errc::invalid_argument),
             "sleep duration exceeds maximum DWORD value"
         );
+        _set_state(Thread::Info::State::SLEEPING);
+        _notify(_HookEvent::SLEEP_BEGIN);
         Sleep(ms_sleep);
+        _notify(_HookEvent::SLEEP_END);
+        _set_state(Thread::Info::State::RUNNING);
     }
 
+// =====================================================================
+// this_thread >> Precise sleep
+// =====================================================================
+// Available from Windows 10 1803, older SDKs do not define it
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+    #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// One timer per thread, closed by the destructor when the thread exits
+struct _SleepTimer {
+    HANDLE handle = CreateWaitableTimerExW(
+        nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS
+    );
+    const bool high_resolution = handle != nullptr;
+
+    _SleepTimer() {
+        if ( !handle ) // Fall back to a regular timer on older systems
+            handle = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+
+    ~_SleepTimer() {
+        if ( handle )
+            CloseHandle(handle);
+    }
+};
+
+inline void this_thread::sleep_until(std::chrono::steady_clock::time_point deadline) {
+    thread_local const _SleepTimer timer;
+
+    // Left for yielding, as timers may wake (a little) late
+    const std::chrono::nanoseconds margin = timer.high_resolution
+        ? std::chrono::microseconds(200)
+        : std::chrono::milliseconds(2);
+
+    _set_state(Thread::Info::State::SLEEPING);
+    _notify(_HookEvent::SLEEP_BEGIN);
+
+    // Ends the sleep on return, or if the timer throws
+    struct SleepEnd {
+        ~SleepEnd() {
+            _notify(_HookEvent::SLEEP_END);
+            _set_state(Thread::Info::State::RUNNING);
+        }
+    } sleep_end;
+
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if ( timer.handle && remaining > margin ) {
+        LARGE_INTEGER due;
+        due.QuadPart = -static_cast<LONGLONG>((remaining - margin) / std::chrono::nanoseconds(100));
+        if ( !SetWaitableTimer(timer.handle, &due, 0, nullptr, nullptr, FALSE) )
+            throw std::system_error(GetLastError(), std::system_category());
+        if ( WaitForSingleObject(timer.handle, INFINITE) != WAIT_OBJECT_0 )
+            throw std::system_error(GetLastError(), std::system_category());
+    }
+
+    while ( std::chrono::steady_clock::now() < deadline )
+        SwitchToThread();
+}
+
+inline void this_thread::sleep_for(std::chrono::nanoseconds duration) {
+    sleep_until(std::chrono::steady_clock::now() + duration);
+}
+
+// =====================================================================
+// this_thread >> Thread index
+// =====================================================================
+// Claimed indices are kept in a bitmap, so that the lowest free index
+// can be claimed (and released) without any locks.
+// Once all are claimed, unique indices past the bitmap are handed out.
+constexpr size_t _index_words = 16; // 1024 reusable indices
+
+inline std::atomic<uint64_t> _index_bitmap[_index_words];
+inline std::atomic<size_t> _index_overflow{_index_words * 64};
+
+inline size_t _lowest_bit(uint64_t bits) noexcept {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+inline size_t _highest_bit(uint64_t bits) noexcept {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, bits);
+    return index;
+#else
+    return 63 - __builtin_clzll(bits);
+#endif
+}
+
+inline size_t _claim_index() noexcept {
+    for ( size_t word = 0; word < _index_words; word++ ) {
+        uint64_t bits = _index_bitmap[word].load(std::memory_order_relaxed);
+        while ( ~bits ) {
+            uint64_t lowest = ~bits & (bits + 1);
+            if ( _index_bitmap[word].compare_exchange_weak(bits, bits | lowest, std::memory_order_relaxed) )
+                return word * 64 + _lowest_bit(lowest);
+        }
+    }
+    return _index_overflow.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void _release_index(size_t index) noexcept {
+    if ( index < _index_words * 64 )
+        _index_bitmap[index / 64].fetch_and(~(uint64_t(1) << (index % 64)), std::memory_order_relaxed);
+}
+
+// Released by the destructor when the thread exits
+struct _ThreadIndex {
+    const size_t value = _claim_index();
+    ~_ThreadIndex() { _release_index(value); }
+};
+
+inline size_t this_thread::get_index() noexcept {
+    thread_local const _ThreadIndex index;
+    return index.value;
+}
+
 // =====================================================================
 // Thread::id >> Implementations 
 // =====================================================================
-size_t Thread::id::hash_value() const noexcept {
+inline size_t Thread::id::hash_value() const noexcept {
     return std::hash<DWORD>{}(_id);
 }
 
@@ -505,11 +1172,30 @@ struct hash<simply::Thread::id> {
 // Thread >> System-API Wrappers
 // =====================================================================
 namespace simply {
+// What a new thread is given - the function and its arguments as a
+// tuple, along with details to register
+template <class T>
+struct _StartData {
+    _StartInfo info;
+    T args;
+
+    template <class... A>
+    _StartData(_StartInfo i, A&&... a): info(std::move(i)), args(std::forward<A>(a)...) {}
+};
+
+inline _StartInfo _start_info(const Thread::Options& opt) {
+    return {opt.name.value_or(std::string()), opt.affinity};
+}
+
 template <class T, size_t... I>
 unsigned __stdcall _invoke(void* lparg) noexcept {
-    const std::unique_ptr<T> argptr(static_cast<T*>(lparg));
-    T& args = *argptr; // Had compiler issues without this...
+    const std::unique_ptr<_StartData<T>> argptr(static_cast<_StartData<T>*>(lparg));
+    T& args = argptr->args; // Had compiler issues without this...
+    // Claim this thread's index before running, and register under it
+    const _Registration registration(argptr->info, this_thread::get_index());
+    _notify(_HookEvent::THREAD_START);
     std::invoke(std::move(std::get<I>(args))...);
+    _notify(_HookEvent::THREAD_EXIT);
     return 0;
 }
 
@@ -543,18 +1229,19 @@ void _start(HANDLE& handle, std::stop_source& source, const Thread::Options& opt
         std::tuple<std::decay_t<F>, std::decay_t<Args>...>
     >;
 
-    std::unique_ptr<T> data_copy;
+    std::unique_ptr<_StartData<T>> data_copy;
 
     if constexpr (takes_stop_token) {
         static_assert(std::is_invocable_v<F, std::stop_token, Args...>,
             "Function taking stop_token must still be invocable with rest of params.");
-        data_copy = std::make_unique<T>(std::forward<F>(f),
-                                        std::forward<std::stop_token>(source.get_token()),
-                                        std::forward<Args>(args)...);
+        data_copy = std::make_unique<_StartData<T>>(_start_info(opt),
+                                                    std::forward<F>(f),
+                                                    std::forward<std::stop_token>(source.get_token()),
+                                                    std::forward<Args>(args)...);
     }
     else {
         static_assert(std::is_invocable_v<F, Args...>, "Ensure function signature and args match!");
-        data_copy = std::make_unique<T>(std::forward<F>(f), std::forward<Args>(args)...);
+        data_copy = std::make_unique<_StartData<T>>(_start_info(opt), std::forward<F>(f), std::forward<Args>(args)...);
     }
 
     constexpr auto invoker = _invoke_gen<T>(std::make_index_sequence<std::tuple_size_v<T>>{});
@@ -566,20 +1253,27 @@ void _start(HANDLE& handle, const Thread::Options& opt, F&& f, Args&&... args) {
 
     static_assert(std::is_invocable_v<F, Args...>, "Ensure function and arguments match!");
 
-    auto data_copy = std::make_unique<T>(std::forward<F>(f), std::forward<Args>(args)...);
+    auto data_copy = std::make_unique<_StartData<T>>(_start_info(opt), std::forward<F>(f), std::forward<Args>(args)...);
 
     constexpr auto invoker = _invoke_gen<T>(std::make_index_sequence<1+sizeof...(Args)>{});
 
 #endif
-    DWORD creation_flag = opt.priority.has_value() ? CREATE_SUSPENDED : 0;
+    DWORD creation_flag = opt.priority.has_value() || opt.affinity.has_value()
+        ? CREATE_SUSPENDED : 0;
+
+    if ( opt.stack_size.value_or(0) > static_cast<size_t>(UINT_MAX) )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "stack size exceeds maximum unsigned value"
+        );
     
     // Microsoft recommends _beginthreadex over CreateThread for C/C++ programs
     handle = reinterpret_cast<HANDLE>(_beginthreadex(
         nullptr,
-        0,
+        static_cast<unsigned>(opt.stack_size.value_or(0)),
         invoker,
         data_copy.get(),
-        creation_flag,
+        creation_flag | (opt.stack_size.has_value() ? STACK_SIZE_PARAM_IS_A_RESERVATION : 0),
         nullptr
     ));
 
@@ -587,39 +1281,46 @@ void _start(HANDLE& handle, const Thread::Options& opt, F&& f, Args&&... args) {
         throw std::system_error(errno, std::system_category());
 
     if ( creation_flag ) {
-        // Redundant to check priority.has_value again until more are added
-        int priority;
+        if ( opt.priority.has_value() ) {
+            int priority;
 
-        switch ( opt.priority.value() /* Should never error */ ) {
-            case Thread::Priority::LOWEST:
-                priority = THREAD_PRIORITY_LOWEST;
-                break;
+            switch ( opt.priority.value() ) {
+                case Thread::Priority::LOWEST:
+                    priority = THREAD_PRIORITY_LOWEST;
+                    break;
             
-            case Thread::Priority::LOW:
-                priority = THREAD_PRIORITY_BELOW_NORMAL;
-                break;
+                case Thread::Priority::LOW:
+                    priority = THREAD_PRIORITY_BELOW_NORMAL;
+                    break;
             
-            case Thread::Priority::NORMAL:
-                priority = THREAD_PRIORITY_NORMAL;
-                break;
+                case Thread::Priority::NORMAL:
+                    priority = THREAD_PRIORITY_NORMAL;
+                    break;
             
-            case Thread::Priority::HIGH:
-                priority = THREAD_PRIORITY_ABOVE_NORMAL;
-                break;
+                case Thread::Priority::HIGH:
+                    priority = THREAD_PRIORITY_ABOVE_NORMAL;
+                    break;
             
-            case Thread::Priority::HIGHEST:
-                priority = THREAD_PRIORITY_HIGHEST;
-                break;
+                case Thread::Priority::HIGHEST:
+                    priority = THREAD_PRIORITY_HIGHEST;
+                    break;
             
-            case Thread::Priority::TIME_CRITICAL:
-                priority = THREAD_PRIORITY_TIME_CRITICAL;
-                break;
+                case Thread::Priority::TIME_CRITICAL:
+                    priority = THREAD_PRIORITY_TIME_CRITICAL;
+                    break;
             
-            default: // In case I mess up - should never happen though...
-                priority = THREAD_PRIORITY_NORMAL;
+                default: // In case I mess up - should never happen though...
+                    priority = THREAD_PRIORITY_NORMAL;
+            }
+
+            if ( !SetThreadPriority(handle, priority) ) {
+                DWORD err = GetLastError();
+                _cleanup_suspended(handle);
+                throw std::system_error(err, std::system_category());
+            }
         }
 
-        if ( !SetThreadPriority(handle, priority) ) {
+        if ( opt.affinity.has_value() && !SetThreadAffinityMask(handle, static_cast<DWORD_PTR>(opt.affinity.value())) ) {
             DWORD err = GetLastError();
             _cleanup_suspended(handle);
             throw std::system_error(err, std::system_category());
@@ -633,6 +1334,7 @@ void _start(HANDLE& handle, const Thread::Options& opt, F&& f, Args&&... args) {
     }
 
     data_copy.release(); // Will be cleaned up by invoker
+    _notify(_HookEvent::SPAWN, GetThreadId(handle));
 }
 
 inline bool _join(HANDLE& handle, size_t ms_timeout) {
@@ -659,6 +1361,15 @@ inline DWORD _thread_id(HANDLE handle) noexcept {
     return GetThreadId(handle);
 }
 
+// Ends a join on return, or if the wait throws
+struct _JoinEnd {
+    DWORD target;
+    ~_JoinEnd() {
+        _notify(_HookEvent::JOIN_END, target);
+        _set_state(Thread::Info::State::RUNNING);
+    }
+};
+
 inline void _detach(HANDLE& handle) {
     if ( !CloseHandle(handle) )
         throw std::system_error(GetLastError(), std::system_category());
@@ -680,9 +1391,9 @@ inline unsigned int _hardware_concurrency() noexcept {
 // =====================================================================
 // Thread >> Implementations
 // =====================================================================
-Thread::Thread() noexcept: _handle(nullptr) {}
+inline Thread::Thread() noexcept: _handle(nullptr) {}
 
-Thread::~Thread() {
+inline Thread::~Thread() {
 #if SIMPLY_C20plus
     _source.request_stop();
 #endif
@@ -691,14 +1402,14 @@ Thread::~Thread() {
     }
 
 }
-Thread::Thread(Thread&& other) noexcept: Thread() { 
+inline Thread::Thread(Thread&& other) noexcept: Thread() { 
     std::swap(_handle, other._handle);
 #if SIMPLY_C20plus
     std::swap(_source, other._source);
 #endif
 }
 
-Thread& Thread::operator=(Thread&& other) { 
+inline Thread& Thread::operator=(Thread&& other) { 
     if (joinable()) 
         join();
     std::swap(_handle, other._handle);
@@ -708,7 +1419,7 @@ Thread& Thread::operator=(Thread&& other) {
     return *this;
 }
 
-void Thread::swap(Thread& other) noexcept {
+inline void Thread::swap(Thread& other) noexcept {
     std::swap(_handle, other._handle);
 #if SIMPLY_C20plus
     std::swap(_source, other._source);
@@ -733,11 +1444,11 @@ Thread::Thread(Thread::Options opt, F&& f, Args&&... args): Thread() {
 #endif
 }
 
-bool Thread::joinable() const noexcept {
+inline bool Thread::joinable() const noexcept {
     return get_id() != this_thread::get_id();
 }
 
-Thread::id Thread::get_id() const noexcept {
+inline Thread::id Thread::get_id() const noexcept {
     if ( _handle != nullptr )
         return id(_thread_id(_handle));
     return id();
@@ -746,37 +1457,80 @@ Thread::id Thread::get_id() const noexcept {
 // NOTE - If _handle != nullptr, AND !joinable(),
 //        then it must mean Thread::get_id() == this_thread::get_id(),
 //        in which case _handle == GetCurrentThread()
-Thread::Priority Thread::get_priority() const noexcept {
+inline Thread::Priority Thread::get_priority() const noexcept {
     if ( _handle != nullptr )
         return _priority(_handle);
     return _priority(GetCurrentThread());
 }
 
-void Thread::join() {
+inline Thread::Stats Thread::stats() const {
+    if ( _handle == nullptr )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "Thread::stats: NULL-thread"
+        );
+    return _stats(_handle);
+}
+
+inline std::optional<size_t> Thread::stack_high_water() const {
+    if ( _handle == nullptr )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "Thread::stack_high_water: NULL-thread"
+        );
+
+    _SlotCopy copy;
+    const _RegistrySlot* slot = _find_slot(_thread_id(_handle), copy);
+    if ( !slot )
+        return std::nullopt;
+    const size_t used = _stack_committed(copy.stack_low, copy.stack_high);
+
+    // Only trust it if the thread was still registered once read
+    if ( slot->version.load(std::memory_order_acquire) != copy.version )
+        return std::nullopt;
+    return used;
+}
+
+inline void Thread::join() {
     if ( !joinable() )
         throw std::system_error(
             std::make_error_code(std::errc::invalid_argument),
             "Thread::join: thread not joinable"
         );
+    const DWORD target = _thread_id(_handle);
 #if SIMPLY_C20plus
-    _source.request_stop();
+    if ( _source.request_stop() )
+        _notify(_HookEvent::STOP_REQUEST, target);
 #endif
+    _set_state(Info::State::JOINING, target);
+    _notify(_HookEvent::JOIN_BEGIN, target);
+    const _JoinEnd join_end{target};
     _join(_handle, INFINITE);
 }
 
-bool Thread::join(size_t ms_timeout) {
+inline bool Thread::join(size_t ms_timeout) {
     if ( !joinable() )
         throw std::system_error(
             std::make_error_code(std::errc::invalid_argument),
             "Thread::join: thread not joinable"
         );
+    if ( ms_timeout > static_cast<size_t>(MAXDWORD) )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "Thread::join: timeout exceeds maximum DWORD value"
+        );
+    const DWORD target = _thread_id(_handle);
 #if SIMPLY_C20plus
-    _source.request_stop();
+    if ( _source.request_stop() )
+        _notify(_HookEvent::STOP_REQUEST, target);
 #endif
+    _set_state(Info::State::JOINING, target);
+    _notify(_HookEvent::JOIN_BEGIN, target);
+    const _JoinEnd join_end{target};
     return _join(_handle, ms_timeout);
 }
 
-void Thread::detach() {
+inline void Thread::detach() {
     if ( !joinable() )
         throw std::system_error(
             std::make_error_code(std::errc::invalid_argument),
@@ -785,7 +1539,7 @@ void Thread::detach() {
     _detach(_handle);
 }
 
-Thread::native_handle_type Thread::native_handle() {
+inline Thread::native_handle_type Thread::native_handle() {
     if ( !joinable() )
         throw std::system_error(
             std::make_error_code(std::errc::invalid_argument),
@@ -794,21 +1548,64 @@ Thread::native_handle_type Thread::native_handle() {
     return _handle;
 }
 
-unsigned int Thread::hardware_concurrency() noexcept { 
+inline unsigned int Thread::hardware_concurrency() noexcept { 
     return _hardware_concurrency();
 }
 
+inline std::vector<Thread::Info> Thread::enumerate() {
+    std::vector<Info> infos;
+    for ( const _RegistrySlot& slot: _registry ) {
+        _SlotCopy copy;
+        if ( !_read_slot(slot, copy) )
+            continue;
+
+        Info info;
+        info.id       = id(copy.thread);
+        info.name     = copy.name;
+        info.affinity = copy.affinity;
+        info.started  = std::chrono::system_clock::time_point(
+            std::chrono::system_clock::duration(copy.started)
+        );
+        info.state    = slot.state.load(std::memory_order_relaxed);
+        if ( info.state == Info::State::JOINING )
+            info.waiting_on = id(slot.waiting_on.load(std::memory_order_relaxed));
+
+        // Only trust the stack if the thread was still registered once read
+        const size_t stack_used = _stack_committed(copy.stack_low, copy.stack_high);
+        if ( slot.version.load(std::memory_order_acquire) == copy.version )
+            info.stack_high_water = stack_used;
+
+        // Only trust the handle if the thread was still registered once
+        // opened, as ids of exited threads may be reused
+        if ( HANDLE handle = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, copy.thread) ) {
+            if ( slot.version.load(std::memory_order_acquire) == copy.version ) {
+                info.priority = _priority(handle);
+                try {
+                    info.stats = _stats(handle);
+                }
+                catch ( const std::system_error& ) {} // Left empty
+            }
+            CloseHandle(handle);
+        }
+        infos.push_back(std::move(info));
+    }
+    return infos;
+}
+
 #if SIMPLY_C20plus
-std::stop_source Thread::get_stop_source() noexcept {
+inline std::stop_source Thread::get_stop_source() noexcept {
     return _source;
 }
 
-std::stop_token Thread::get_stop_token() const noexcept {
+inline std::stop_token Thread::get_stop_token() const noexcept {
     return _source.get_token();
 }
 
-bool Thread::request_stop() noexcept {
-    return _source.request_stop();
+inline bool Thread::request_stop() noexcept {
+    const bool first = _source.request_stop();
+    if ( first && _handle != nullptr )
+        _notify(_HookEvent::STOP_REQUEST, _thread_id(_handle));
+    return first;
 }
 
 #endif
@@ -0,0 +1,95 @@
+/// cpu_features.h
+/// Runtime detection of x64 vector instruction sets, shared by the
+/// SIMD kernels of parallel_memory.h and parallel_reduce.h
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - included by the headers using it
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Kernels for wider vectors than the build targets are compiled per
+/// function, with `SIMPLY_TARGET_AVX`, `SIMPLY_TARGET_AVX2` or
+/// `SIMPLY_TARGET_AVX512`, and only called once `_cpu_features` shows
+/// that both the CPU supports them and the OS saves their registers.
+///
+/// `SIMPLY_X64` is 1 where these are available, else 0.
+///
+/// {note: clang-cl} Defines `_MSC_VER` too, but like GCC only allows
+///                  intrinsics in functions targeting their instruction
+///                  set, so takes the GCC path.
+#ifndef SIMPLY_CPU_FEATURES_HPP_
+#define SIMPLY_CPU_FEATURES_HPP_
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define SIMPLY_X64 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define SIMPLY_TARGET_AVX
+        #define SIMPLY_TARGET_AVX2
+        #define SIMPLY_TARGET_AVX512
+    #else
+        #include <cpuid.h>
+        #define SIMPLY_TARGET_AVX    __attribute__((target("avx")))
+        #define SIMPLY_TARGET_AVX2   __attribute__((target("avx2")))
+        #define SIMPLY_TARGET_AVX512 __attribute__((target("avx512f")))
+    #endif
+#else
+    #define SIMPLY_X64 0
+#endif
+
+namespace simply {
+// Instruction sets usable by this process - supported by the CPU, and
+// their registers saved by the OS
+struct _CpuFeatures {
+    bool avx     = false;
+    bool avx2    = false;
+    bool avx512f = false;
+};
+
+inline _CpuFeatures _detect_cpu_features() noexcept {
+    _CpuFeatures features;
+#if SIMPLY_X64
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const unsigned ecx = static_cast<unsigned>(info[2]);
+    unsigned ebx7 = 0;
+    if ( max_leaf >= 7 ) {
+        __cpuidex(info, 7, 0);
+        ebx7 = static_cast<unsigned>(info[1]);
+    }
+    if ( !(ecx & (1u << 27)) ) // OSXSAVE
+        return features;
+    const unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned eax, ebx, ecx, edx;
+    if ( !__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & (1u << 27)) ) // OSXSAVE
+        return features;
+    unsigned eax7, ebx7 = 0, ecx7, edx7; // Left as is where leaf 7 is missing
+    __get_cpuid_count(7, 0, &eax7, &ebx7, &ecx7, &edx7);
+    unsigned low, high;
+    __asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    const unsigned long long xcr0 = low;
+#endif
+    const bool ymm = (xcr0 & 6) == 6;          // XMM and YMM state
+    const bool zmm = (xcr0 & 0xE6) == 0xE6;    // As well as opmask and ZMM state
+    features.avx     = ymm && (ecx & (1u << 28));
+    features.avx2    = features.avx && (ebx7 & (1u << 5));
+    features.avx512f = features.avx2 && zmm && (ebx7 & (1u << 16));
+#endif
+    return features;
+}
+
+inline const _CpuFeatures _cpu_features = _detect_cpu_features();
+}
+
+#endif // SIMPLY_CPU_FEATURES_HPP_
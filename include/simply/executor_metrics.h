@@ -0,0 +1,431 @@
+/// executor_metrics.h
+/// Per-worker metrics for thread pools, with a Prometheus text dump
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// To size a pool from data, `ExecutorMetrics` tracks per worker:
+/// - enqueue-to-start latency, and execution time (histograms)
+/// - tasks run, steals attempted and succeeded
+/// - park/unpark counts, and busy/idle time
+///
+/// And for the pool as a whole, its queue depth.
+///
+/// Each worker records through its own `ExecutorMetrics::Worker`, on its
+/// own cache line, which no other thread writes. Recording is therefore
+/// uncontended - plain relaxed loads and stores, no read-modify-writes
+/// shared with other threads. The queue depth, changed by any thread
+/// submitting work, is a `ShardedCounter` (see sharded.h).
+///
+/// Metrics are read through `snapshot` (pull), or written in the
+/// Prometheus text format by `write_prometheus`.
+///
+///   Classes
+/// simply::ExecutorMetrics
+///     Metrics of one pool, and its workers.
+#ifndef SIMPLY_EXECUTOR_METRICS_HPP_
+#define SIMPLY_EXECUTOR_METRICS_HPP_
+
+#include "concurrency.h"
+#include "sharded.h"
+#include "histogram.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// ExecutorMetrics >> Declaration
+// =====================================================================
+///   ExecutorMetrics
+/// Metrics of a pool of worker threads
+///
+///   Behaviours
+/// - Single writer per worker
+///     Each `Worker` must only be recorded to by its own worker thread.
+///     Reading (`snapshot`) is safe from any thread, at any time.
+/// - Consistency
+///     A snapshot taken while workers record is not atomic as a whole,
+///     for example a task may be counted before its execution time.
+///
+///   Example
+/// ```
+/// simply::ExecutorMetrics metrics("io", workers);
+///
+/// // Submitting thread
+/// metrics.enqueued();
+///
+/// // Worker thread i
+/// auto& worker = metrics.worker(i);
+/// auto started = worker.task_started(job.enqueued_at);
+/// job.run();
+/// worker.task_finished(started);
+///
+/// // Anywhere
+/// metrics.write_prometheus(std::cout);
+/// ```
+class ExecutorMetrics final {
+public:
+    ///   Clock
+    /// Clock for all times given to and returned by metrics
+    using Clock = std::chrono::steady_clock;
+
+    ///   Worker
+    /// Recorder for a single worker thread
+    class Worker;
+
+    ///   WorkerSnapshot
+    /// Metrics of a single worker, at some point in time
+    struct WorkerSnapshot {
+        uint64_t tasks;
+        uint64_t steals_attempted;
+        uint64_t steals_succeeded;
+        uint64_t parks;
+        uint64_t unparks;
+        std::chrono::nanoseconds busy;  // Running tasks
+        std::chrono::nanoseconds idle;  // Parked
+        LatencyHistogram::Snapshot queue_latency;   // Enqueue to start
+        LatencyHistogram::Snapshot execution_time;
+
+        ///   utilization
+        /// Fraction of busy time, out of busy and idle time (0 if neither)
+        SIMPLY_NODISCARD double utilization() const noexcept;
+    };
+
+    ///   Snapshot
+    /// Metrics of the pool, at some point in time
+    ///
+    /// `total` sums all workers, and merges their histograms.
+    struct Snapshot {
+        std::string name;
+        int64_t queue_depth;
+        WorkerSnapshot total;
+        std::vector<WorkerSnapshot> workers;
+    };
+
+public:
+    ///   Constructor
+    ///
+    ///   Params
+    /// name Name of the pool, used as the `pool` label by `write_prometheus`
+    /// workers Number of workers, must be at least 1
+    /// precision Precision of the histograms, see `LatencyHistogram`
+    ExecutorMetrics(std::string name, size_t workers, unsigned precision = 5);
+
+    ///   No copying or moving
+    ExecutorMetrics(const ExecutorMetrics&) = delete;
+    ExecutorMetrics& operator=(const ExecutorMetrics&) = delete;
+
+    ///   worker
+    /// Recorder of the given worker
+    ///
+    /// Throws `system_error` if out of range
+    SIMPLY_NODISCARD Worker& worker(size_t index);
+
+    ///   enqueued
+    /// Count tasks added to the pool's queue, from any thread
+    void enqueued(int64_t tasks = 1) noexcept;
+
+    ///   dequeued
+    /// Count tasks removed from the queue without being started,
+    /// for example when cancelled. Started tasks are counted by
+    /// `Worker::task_started`.
+    void dequeued(int64_t tasks = 1) noexcept;
+
+    ///   snapshot
+    /// Read all metrics
+    SIMPLY_NODISCARD Snapshot snapshot() const;
+
+    ///   write_prometheus
+    /// Write all metrics in the Prometheus text exposition format
+    void write_prometheus(std::ostream& ost) const;
+
+    ///   name
+    /// Name of the pool, as given to the constructor
+    SIMPLY_NODISCARD const std::string& name() const noexcept;
+
+    ///   workers
+    /// Number of workers, as given to the constructor
+    SIMPLY_NODISCARD size_t workers() const noexcept;
+
+private:
+    std::string _name;
+    unsigned _precision;
+    ShardedCounter _queue_depth;
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+// =====================================================================
+// ExecutorMetrics::Worker >> Declaration
+// =====================================================================
+///   Worker
+/// See notes in declaration inside ExecutorMetrics
+///
+/// Only to be recorded to by its own worker thread.
+class alignas(64) ExecutorMetrics::Worker final {
+public:
+    ///   task_started
+    /// Record a task starting, which was enqueued at the given time
+    ///
+    /// Returns the start time, to pass to `task_finished`
+    Clock::time_point task_started(Clock::time_point enqueued) noexcept;
+
+    ///   task_finished
+    /// Record a task finishing, which started at the given time
+    void task_finished(Clock::time_point started) noexcept;
+
+    ///   steal
+    /// Record an attempt to steal work from another worker
+    void steal(bool succeeded) noexcept;
+
+    ///   park
+    /// Record the worker going to sleep for lack of work
+    void park() noexcept;
+
+    ///   unpark
+    /// Record the worker waking up, after `park`
+    void unpark() noexcept;
+
+private:
+    friend ExecutorMetrics;
+
+    Worker(ExecutorMetrics& pool, unsigned precision);
+
+    WorkerSnapshot _snapshot() const;
+
+    // Only written by the worker, so no read-modify-write needed
+    static void _add(std::atomic<uint64_t>& counter, uint64_t value) noexcept;
+
+    ExecutorMetrics& _pool;
+    std::atomic<uint64_t> _tasks{0};
+    std::atomic<uint64_t> _steals_attempted{0};
+    std::atomic<uint64_t> _steals_succeeded{0};
+    std::atomic<uint64_t> _parks{0};
+    std::atomic<uint64_t> _unparks{0};
+    std::atomic<uint64_t> _busy_ns{0};
+    std::atomic<uint64_t> _idle_ns{0};
+    Clock::time_point _parked_at;
+    LatencyHistogram _queue_latency;
+    LatencyHistogram _execution_time;
+};
+
+// =====================================================================
+// ExecutorMetrics >> Implementations
+// =====================================================================
+inline double ExecutorMetrics::WorkerSnapshot::utilization() const noexcept {
+    const auto total = busy + idle;
+    return total.count() ? static_cast<double>(busy.count()) / static_cast<double>(total.count()) : 0.0;
+}
+
+inline ExecutorMetrics::ExecutorMetrics(std::string name, size_t workers, unsigned precision):
+    _name(std::move(name)),
+    _precision(_latency_precision(precision))
+{
+    if ( workers == 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "ExecutorMetrics: workers must be at least 1"
+        );
+    _workers.reserve(workers);
+    for ( size_t i = 0; i < workers; i++ ) {
+        // Owned before pushing, so not leaked if that throws. Not
+        // make_unique, as the constructor is private.
+        std::unique_ptr<Worker> worker(new Worker(*this, precision));
+        _workers.push_back(std::move(worker));
+    }
+}
+
+inline ExecutorMetrics::Worker& ExecutorMetrics::worker(size_t index) {
+    if ( index >= _workers.size() )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "ExecutorMetrics::worker: index out of range"
+        );
+    return *_workers[index];
+}
+
+inline void ExecutorMetrics::enqueued(int64_t tasks) noexcept {
+    _queue_depth.add(tasks);
+}
+
+inline void ExecutorMetrics::dequeued(int64_t tasks) noexcept {
+    _queue_depth.add(-tasks);
+}
+
+inline ExecutorMetrics::Snapshot ExecutorMetrics::snapshot() const {
+    Snapshot snapshot{
+        _name,
+        _queue_depth.read(),
+        {0, 0, 0, 0, 0, {}, {}, LatencyHistogram::Snapshot(_precision), LatencyHistogram::Snapshot(_precision)},
+        {}
+    };
+
+    WorkerSnapshot& total = snapshot.total;
+    for ( const auto& worker: _workers ) {
+        snapshot.workers.push_back(worker->_snapshot());
+        const WorkerSnapshot& each = snapshot.workers.back();
+        total.tasks            += each.tasks;
+        total.steals_attempted += each.steals_attempted;
+        total.steals_succeeded += each.steals_succeeded;
+        total.parks            += each.parks;
+        total.unparks          += each.unparks;
+        total.busy             += each.busy;
+        total.idle             += each.idle;
+        total.queue_latency.merge(each.queue_latency);
+        total.execution_time.merge(each.execution_time);
+    }
+    return snapshot;
+}
+
+inline const std::string& ExecutorMetrics::name() const noexcept {
+    return _name;
+}
+
+inline size_t ExecutorMetrics::workers() const noexcept {
+    return _workers.size();
+}
+
+// Label values may hold any text, escaped as the format requires
+inline std::string _prometheus_label(const std::string& value) {
+    std::string escaped;
+    for ( char c: value ) {
+        if ( c == '\\' || c == '"' )
+            escaped += '\\';
+        if ( c == '\n' ) {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+inline void ExecutorMetrics::write_prometheus(std::ostream& ost) const {
+    const Snapshot snap = snapshot();
+    const std::string pool = "pool=\"" + _prometheus_label(snap.name) + "\"";
+
+    auto header = [&ost](const char* metric, const char* type, const char* help) {
+        ost << "# HELP simply_executor_" << metric << ' ' << help << '\n'
+            << "# TYPE simply_executor_" << metric << ' ' << type << '\n';
+    };
+
+    // One sample per worker, for per-worker counters
+    auto per_worker = [&](const char* metric, const char* help, auto value) {
+        header(metric, "counter", help);
+        for ( size_t i = 0; i < snap.workers.size(); i++ )
+            ost << "simply_executor_" << metric << '{' << pool << ",worker=\"" << i << "\"} "
+                << value(snap.workers[i]) << '\n';
+    };
+
+    // Pool-wide summary from a merged histogram, in seconds
+    auto summary = [&](const char* metric, const char* help, const LatencyHistogram::Snapshot& histogram) {
+        header(metric, "summary", help);
+        for ( double quantile: {0.5, 0.9, 0.99, 0.999} )
+            ost << "simply_executor_" << metric << '{' << pool << ",quantile=\"" << quantile << "\"} "
+                << histogram.percentile(quantile * 100) / 1e9 << '\n';
+        ost << "simply_executor_" << metric << "_sum{" << pool << "} "
+            << histogram.mean() * static_cast<double>(histogram.count()) / 1e9 << '\n'
+            << "simply_executor_" << metric << "_count{" << pool << "} " << histogram.count() << '\n';
+    };
+
+    header("queue_depth", "gauge", "Tasks waiting in the queue");
+    ost << "simply_executor_queue_depth{" << pool << "} " << snap.queue_depth << '\n';
+
+    header("utilization", "gauge", "Fraction of worker time spent running tasks");
+    ost << "simply_executor_utilization{" << pool << "} " << snap.total.utilization() << '\n';
+
+    per_worker("tasks_total", "Tasks started",
+               [](const WorkerSnapshot& w){ return w.tasks; });
+    per_worker("steals_attempted_total", "Attempts to steal work from other workers",
+               [](const WorkerSnapshot& w){ return w.steals_attempted; });
+    per_worker("steals_succeeded_total", "Successful steals of work from other workers",
+               [](const WorkerSnapshot& w){ return w.steals_succeeded; });
+    per_worker("parks_total", "Times a worker slept for lack of work",
+               [](const WorkerSnapshot& w){ return w.parks; });
+    per_worker("unparks_total", "Times a worker woke up",
+               [](const WorkerSnapshot& w){ return w.unparks; });
+    per_worker("busy_seconds_total", "Time spent running tasks",
+               [](const WorkerSnapshot& w){ return w.busy.count() / 1e9; });
+    per_worker("idle_seconds_total", "Time spent parked",
+               [](const WorkerSnapshot& w){ return w.idle.count() / 1e9; });
+
+    summary("queue_latency_seconds", "Time from enqueue to start of tasks", snap.total.queue_latency);
+    summary("execution_seconds", "Time spent running tasks", snap.total.execution_time);
+}
+
+// =====================================================================
+// ExecutorMetrics::Worker >> Implementations
+// =====================================================================
+// Each histogram has a single shard - only its worker records to it
+inline ExecutorMetrics::Worker::Worker(ExecutorMetrics& pool, unsigned precision):
+    _pool(pool),
+    _queue_latency(precision, 1),
+    _execution_time(precision, 1) {}
+
+inline void ExecutorMetrics::Worker::_add(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline ExecutorMetrics::Clock::time_point
+ExecutorMetrics::Worker::task_started(Clock::time_point enqueued) noexcept {
+    const Clock::time_point now = Clock::now();
+    _pool._queue_depth.add(-1);
+    _queue_latency.record(now - enqueued);
+    _add(_tasks, 1);
+    return now;
+}
+
+inline void ExecutorMetrics::Worker::task_finished(Clock::time_point started) noexcept {
+    const auto elapsed = Clock::now() - started;
+    _execution_time.record(elapsed);
+    _add(_busy_ns, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+inline void ExecutorMetrics::Worker::steal(bool succeeded) noexcept {
+    _add(_steals_attempted, 1);
+    if ( succeeded )
+        _add(_steals_succeeded, 1);
+}
+
+inline void ExecutorMetrics::Worker::park() noexcept {
+    _parked_at = Clock::now();
+    _add(_parks, 1);
+}
+
+inline void ExecutorMetrics::Worker::unpark() noexcept {
+    const auto idle = Clock::now() - _parked_at;
+    _add(_idle_ns, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(idle).count()));
+    _add(_unparks, 1);
+}
+
+inline ExecutorMetrics::WorkerSnapshot ExecutorMetrics::Worker::_snapshot() const {
+    return {
+        _tasks.load(std::memory_order_relaxed),
+        _steals_attempted.load(std::memory_order_relaxed),
+        _steals_succeeded.load(std::memory_order_relaxed),
+        _parks.load(std::memory_order_relaxed),
+        _unparks.load(std::memory_order_relaxed),
+        std::chrono::nanoseconds(_busy_ns.load(std::memory_order_relaxed)),
+        std::chrono::nanoseconds(_idle_ns.load(std::memory_order_relaxed)),
+        _queue_latency.snapshot(),
+        _execution_time.snapshot()
+    };
+}
+}
+
+#endif // SIMPLY_EXECUTOR_METRICS_HPP_
@@ -0,0 +1,411 @@
+/// flight_recorder.h
+/// Always-on record of recent thread events, for post-mortem analysis
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// While enabled, every thread keeps its last 2048 concurrency events in
+/// its own fixed-size ring, overwriting the oldest. Cheap enough to leave
+/// on in production - each event is a timestamp and a few stores into
+/// the calling thread's ring, no locks, no allocation (after a thread's
+/// first event).
+///
+/// Recorded, with a detail where there is one:
+/// - "thread start", "thread exit" - of every thread started by `Thread`
+/// - "spawn"        - starting a `Thread`, detail is its id
+/// - "join begin", "join end" - `Thread::join`, detail is the joined id
+/// - "stop request" - first stop request to a `Thread`, detail is its id
+/// - "sleep begin", "sleep end" - `this_thread::sleep`, `sleep_until`...
+/// - "task begin", "task end" - running a `Task` (task.h)
+/// - "lock wait begin", "lock wait end" - waiting for a contended lock
+///                    (mutex.h), detail is the lock's address
+///
+/// Rings belong to thread indices (see `this_thread::get_index`), so the
+/// events of a thread which exited stay until its index is reused.
+///
+///   After a crash
+/// `install_crash_handler` writes all rings to a binary file when the
+/// process dies of an unhandled exception (such as an access violation),
+/// without allocating. Read it back with `load`, for example from a
+/// separate tool, or on the next start.
+///
+///   Example
+/// ```
+/// int main() {
+///     simply::flight_recorder::enable();
+///     simply::flight_recorder::install_crash_handler("flight.bin");
+///     ...
+/// }
+///
+/// // Later, or in another program
+/// for ( auto& record: simply::flight_recorder::load("flight.bin") )
+///     std::cout << record.thread << ' ' << record.event << '\n';
+/// ```
+///
+///   Functions
+/// simply::flight_recorder::enable / disable / enabled
+///     Start or stop recording.
+/// simply::flight_recorder::snapshot / dump
+///     Read all rings, as records or as text.
+/// simply::flight_recorder::write / install_crash_handler / load
+///     Write all rings to a binary file, now or on a crash, and read it.
+#ifndef SIMPLY_FLIGHT_RECORDER_HPP_
+#define SIMPLY_FLIGHT_RECORDER_HPP_
+
+#include "concurrency.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace simply::flight_recorder {
+// =====================================================================
+// flight_recorder >> Declarations
+// =====================================================================
+///   Record
+/// One recorded event
+struct Record {
+    int64_t time;       // Nanoseconds on the steady clock
+    uint32_t thread;    // System thread id, as printed for a `Thread::id`
+    const char* event;  // Such as "join begin", see notes at start of file
+    uint64_t detail;    // Thread id or lock address, see notes at start of file
+};
+
+///   enable
+/// Start recording, if not already
+///
+/// Throws `system_error` if all event hooks are taken (see concurrency.h)
+void enable();
+
+///   disable
+/// Stop recording, keeping what was recorded
+void disable() noexcept;
+
+///   enabled
+/// Whether recording
+SIMPLY_NODISCARD bool enabled() noexcept;
+
+///   snapshot
+/// All records in all rings, oldest first
+///
+/// Safe while threads keep recording, events recorded meanwhile may or
+/// may not be included.
+SIMPLY_NODISCARD std::vector<Record> snapshot();
+
+///   dump
+/// Write all records as text, oldest first, timed relative to the newest
+void dump(std::ostream& ost);
+
+///   write
+/// Write all rings to a binary file, for `load`
+///
+/// Allocates nothing and takes no locks, so is safe from crash handlers.
+/// Returns false if the file could not be written.
+bool write(const char* path) noexcept;
+
+///   install_crash_handler
+/// Call `write` with path if the process dies of an unhandled exception
+///
+/// Any previously installed handler is called afterwards.
+/// Throws `system_error` if the path is longer than MAX_PATH.
+void install_crash_handler(const std::string& path);
+
+///   load
+/// Read a file made by `write`, oldest first
+///
+/// Throws `system_error` if the file could not be read, or is not one
+/// made by `write`.
+SIMPLY_NODISCARD std::vector<Record> load(const std::string& path);
+
+// =====================================================================
+// flight_recorder >> Helpers
+// =====================================================================
+constexpr const char* _event_names[] = {
+    "thread start", "thread exit",
+    "join begin", "join end",
+    "sleep begin", "sleep end",
+    "task begin", "task end",
+    "spawn",
+    "stop request",
+    "lock wait begin", "lock wait end"
+};
+static_assert(std::size(_event_names) == static_cast<size_t>(_HookEvent::LOCK_WAIT_END) + 1,
+              "Name every hook event");
+
+inline const char* _event_name(uint32_t event) noexcept {
+    return event < std::size(_event_names) ? _event_names[event] : "unknown";
+}
+
+// Each slot is a small sequence lock, odd while being written, so
+// readers can skip slots overwritten under them
+struct _Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<int64_t> time{0};
+    std::atomic<uint64_t> detail{0};
+    std::atomic<uint32_t> thread{0};
+    std::atomic<uint32_t> event{0};
+};
+
+// Written by whichever thread holds its index, read by anyone
+class _Ring final {
+public:
+    static constexpr size_t capacity = 2048; // Power of 2
+
+    void push(int64_t time, uint32_t thread, _HookEvent event, uint64_t detail) noexcept {
+        const uint64_t index = _head.fetch_add(1, std::memory_order_relaxed);
+        _Slot& slot = _slots[index & (capacity - 1)];
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.time.store(time, std::memory_order_relaxed);
+        slot.detail.store(detail, std::memory_order_relaxed);
+        slot.thread.store(thread, std::memory_order_relaxed);
+        slot.event.store(static_cast<uint32_t>(event), std::memory_order_relaxed);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    // Calls f(time, thread, event, detail) for each consistent slot
+    template <class F>
+    void read(F&& f) const noexcept(noexcept(f(int64_t(), uint32_t(), uint32_t(), uint64_t()))) {
+        for ( const _Slot& slot: _slots ) {
+            const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if ( sequence == 0 || sequence & 1 )
+                continue; // Never written, or being written
+            const int64_t time    = slot.time.load(std::memory_order_relaxed);
+            const uint64_t detail = slot.detail.load(std::memory_order_relaxed);
+            const uint32_t thread = slot.thread.load(std::memory_order_relaxed);
+            const uint32_t event  = slot.event.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ( slot.sequence.load(std::memory_order_relaxed) == sequence )
+                f(time, thread, event, detail);
+        }
+    }
+
+private:
+    std::atomic<uint64_t> _head{0};
+    _Slot _slots[capacity];
+};
+
+// One ring per reusable thread index, made on its first event and kept
+// for the rest of the program
+inline std::atomic<_Ring*> _rings[_registry_size];
+inline std::atomic<bool> _enabled{false};
+
+inline _Ring* _ring(size_t index) noexcept {
+    _Ring* ring = _rings[index].load(std::memory_order_acquire);
+    if ( ring )
+        return ring;
+
+    _Ring* made = new (std::nothrow) _Ring();
+    if ( !made )
+        return nullptr;
+    if ( !_rings[index].compare_exchange_strong(ring, made, std::memory_order_acq_rel) ) {
+        delete made; // Another thread (which had this index) won
+        return ring;
+    }
+    return made;
+}
+
+inline int64_t _now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+inline void _hook(_HookEvent event, uint64_t detail) noexcept {
+    const size_t index = this_thread::get_index();
+    if ( index >= _registry_size )
+        return; // Past the reusable indices - not recorded
+    if ( _Ring* ring = _ring(index) )
+        ring->push(_now(), GetCurrentThreadId(), event, detail);
+}
+
+// Binary file layout, see `write`
+constexpr char _file_magic[8] = {'S', 'I', 'M', 'P', 'L', 'Y', 'F', 'R'};
+constexpr uint32_t _file_version = 1;
+
+struct _FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+struct _FileRecord {
+    int64_t time;
+    uint64_t detail;
+    uint32_t thread;
+    uint32_t event;
+};
+
+inline char _crash_path[MAX_PATH];
+inline LPTOP_LEVEL_EXCEPTION_FILTER _previous_filter = nullptr;
+
+inline LONG WINAPI _crash_filter(EXCEPTION_POINTERS* exception) {
+    write(_crash_path);
+    return _previous_filter ? _previous_filter(exception) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+// =====================================================================
+// flight_recorder >> Implementations
+// =====================================================================
+inline void enable() {
+    bool expected = false;
+    if ( !_enabled.compare_exchange_strong(expected, true) )
+        return;
+    try {
+        _add_hook(&_hook);
+    }
+    catch ( ... ) {
+        _enabled.store(false);
+        throw;
+    }
+}
+
+inline void disable() noexcept {
+    bool expected = true;
+    if ( _enabled.compare_exchange_strong(expected, false) )
+        _remove_hook(&_hook);
+}
+
+inline bool enabled() noexcept {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+inline std::vector<Record> snapshot() {
+    std::vector<Record> records;
+    for ( const auto& slot: _rings ) {
+        const _Ring* ring = slot.load(std::memory_order_acquire);
+        if ( !ring )
+            continue;
+        ring->read([&records](int64_t time, uint32_t thread, uint32_t event, uint64_t detail){
+            records.push_back({time, thread, _event_name(event), detail});
+        });
+    }
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b){
+        return a.time < b.time;
+    });
+    return records;
+}
+
+inline void dump(std::ostream& ost) {
+    const std::vector<Record> records = snapshot();
+    if ( records.empty() )
+        return;
+
+    const int64_t newest = records.back().time;
+    const std::ios_base::fmtflags flags = ost.flags(); // Restored after, for the caller
+    const std::streamsize precision = ost.precision();
+    for ( const Record& record: records ) {
+        ost << std::fixed << std::setprecision(3) << std::setw(12)
+            << (record.time - newest) / 1e6 << " ms  thread " << std::setw(6) << record.thread
+            << "  " << record.event;
+        if ( std::strncmp(record.event, "lock", 4) == 0 )
+            ost << "  0x" << std::hex << record.detail << std::dec;
+        else if ( record.detail )
+            ost << "  " << record.detail;
+        ost << '\n';
+    }
+    ost.flags(flags);
+    ost.precision(precision);
+}
+
+inline bool write(const char* path) noexcept {
+    HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if ( file == INVALID_HANDLE_VALUE )
+        return false;
+
+    bool ok = true;
+    auto write_bytes = [&](const void* data, DWORD size){
+        DWORD written;
+        ok = ok && WriteFile(file, data, size, &written, nullptr) && written == size;
+    };
+
+    _FileHeader header;
+    std::memcpy(header.magic, _file_magic, sizeof(header.magic));
+    header.version     = _file_version;
+    header.record_size = sizeof(_FileRecord);
+    write_bytes(&header, sizeof(header));
+
+    // Buffered on the stack, to write in few calls without allocating
+    _FileRecord buffer[256];
+    size_t buffered = 0;
+    for ( const auto& slot: _rings ) {
+        const _Ring* ring = slot.load(std::memory_order_acquire);
+        if ( !ring )
+            continue;
+        ring->read([&](int64_t time, uint32_t thread, uint32_t event, uint64_t detail) noexcept {
+            buffer[buffered++] = {time, detail, thread, event};
+            if ( buffered == std::size(buffer) ) {
+                write_bytes(buffer, static_cast<DWORD>(sizeof(buffer)));
+                buffered = 0;
+            }
+        });
+    }
+    write_bytes(buffer, static_cast<DWORD>(buffered * sizeof(_FileRecord)));
+
+    CloseHandle(file);
+    return ok;
+}
+
+inline void install_crash_handler(const std::string& path) {
+    if ( path.size() >= MAX_PATH )
+        throw std::system_error(
+            std::make_error_code(std::errc::filename_too_long),
+            "flight_recorder::install_crash_handler: path longer than MAX_PATH"
+        );
+    std::memcpy(_crash_path, path.c_str(), path.size() + 1);
+
+    LPTOP_LEVEL_EXCEPTION_FILTER previous = SetUnhandledExceptionFilter(&_crash_filter);
+    if ( previous != &_crash_filter ) // Not when installed again
+        _previous_filter = previous;
+}
+
+inline std::vector<Record> load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if ( !file )
+        throw std::system_error(
+            std::make_error_code(std::errc::no_such_file_or_directory),
+            "flight_recorder::load: could not open " + path
+        );
+
+    _FileHeader header;
+    if ( !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+         || std::memcmp(header.magic, _file_magic, sizeof(header.magic)) != 0
+         || header.version != _file_version
+         || header.record_size != sizeof(_FileRecord) )
+        throw std::system_error(
+            std::make_error_code(std::errc::illegal_byte_sequence),
+            "flight_recorder::load: not a flight recorder file " + path
+        );
+
+    std::vector<Record> records;
+    _FileRecord record;
+    while ( file.read(reinterpret_cast<char*>(&record), sizeof(record)) )
+        records.push_back({record.time, record.thread, _event_name(record.event), record.detail});
+
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b){
+        return a.time < b.time;
+    });
+    return records;
+}
+}
+
+#endif // SIMPLY_FLIGHT_RECORDER_HPP_
@@ -0,0 +1,349 @@
+/// histogram.h
+/// Log-linear latency histogram for recording from many threads
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Latencies span many orders of magnitude, so fixed-width buckets are
+/// either too coarse for fast operations or too many for slow ones.
+/// Like HdrHistogram, `LatencyHistogram` splits each power of 2 into
+/// `2^precision` linear sub-buckets, so any recorded value is known to
+/// within a relative error of `2^-precision` (about 3% by default).
+///
+/// Recording is a handful of relaxed atomic adds on the calling thread's
+/// shard (see sharded.h), and takes no locks. Reading takes a `Snapshot`,
+/// a plain copy of the merged counts, which percentiles are queried on.
+///
+///   Classes
+/// simply::LatencyHistogram
+///     Records values (nanoseconds) from any number of threads.
+///
+/// simply::LatencyHistogram::Snapshot
+///     A merged copy of the counts, for percentiles, means etc.
+///     Snapshots with the same precision may be merged together.
+#ifndef SIMPLY_HISTOGRAM_HPP_
+#define SIMPLY_HISTOGRAM_HPP_
+
+#include "concurrency.h"
+#include "sharded.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <system_error>
+
+namespace simply {
+// =====================================================================
+// LatencyHistogram >> Declaration
+// =====================================================================
+///   LatencyHistogram
+/// Lock-free histogram of latencies, recorded in nanoseconds
+///
+/// Values below 0 are recorded as 0, and values above `max_value`
+/// (about 4.9 hours) are recorded as `max_value`.
+///
+///   Example
+/// ```
+/// simply::LatencyHistogram latency;
+///
+/// auto start = std::chrono::steady_clock::now();
+/// do_work();
+/// latency.record(std::chrono::steady_clock::now() - start);
+///
+/// auto snapshot = latency.snapshot();
+/// snapshot.percentile(99.9); // In nanoseconds
+/// ```
+class LatencyHistogram final {
+public:
+    ///   Snapshot
+    /// A copy of the histogram's counts at some point in time
+    class Snapshot;
+
+    ///   max_value
+    /// Largest value which can be told apart, in nanoseconds
+    static constexpr int64_t max_value = (int64_t(1) << 44) - 1;
+
+    ///   Constructor
+    ///
+    ///   Params
+    /// precision Sub-buckets per power of 2, as a power of 2 (1 to 10)
+    ///     Memory is about `8 * (45 - precision) * 2^precision` bytes per shard.
+    ///
+    /// Throws `system_error` if precision is out of range
+    explicit LatencyHistogram(unsigned precision = 5);
+
+    ///   Constructor
+    /// Uses (at least) the given number of shards
+    LatencyHistogram(unsigned precision, size_t shards);
+
+    ///   record
+    /// Count a value (nanoseconds) in the calling thread's shard
+    void record(int64_t ns) noexcept;
+
+    ///   record
+    /// Count a duration, converted to nanoseconds
+    template <class Rep, class Period>
+    void record(std::chrono::duration<Rep, Period> duration) noexcept;
+
+    ///   snapshot
+    /// Merge all shards into a snapshot
+    ///
+    /// Values recorded while this runs may or may not be included.
+    SIMPLY_NODISCARD Snapshot snapshot() const;
+
+    ///   reset
+    /// Forget all values recorded so far
+    void reset() noexcept;
+
+    ///   precision
+    /// Precision given to the constructor
+    SIMPLY_NODISCARD unsigned precision() const noexcept;
+
+private:
+    unsigned _precision;
+    size_t _buckets;
+    _ShardedArray _cells; // Per shard: [buckets..., sum, max]
+};
+
+// =====================================================================
+// LatencyHistogram::Snapshot >> Declaration
+// =====================================================================
+///   Snapshot
+/// See notes in declaration within LatencyHistogram
+///
+/// Percentiles are reported as the highest value of the bucket they
+/// fall into, but never above the highest value recorded.
+class LatencyHistogram::Snapshot final {
+public:
+    ///   Constructor
+    /// An empty snapshot, which can be merged into
+    explicit Snapshot(unsigned precision = 5);
+
+    ///   count
+    /// Number of values recorded
+    SIMPLY_NODISCARD uint64_t count() const noexcept;
+
+    ///   min
+    /// Lowest value recorded (to within bucket precision), or 0 if none
+    SIMPLY_NODISCARD int64_t min() const noexcept;
+
+    ///   max
+    /// Highest value recorded, or 0 if none
+    SIMPLY_NODISCARD int64_t max() const noexcept;
+
+    ///   mean
+    /// Mean of all values recorded, or 0 if none
+    SIMPLY_NODISCARD double mean() const noexcept;
+
+    ///   percentile
+    /// Value at or below which the given percent (0 to 100) of values lie
+    ///
+    /// Returns 0 if no values are recorded
+    SIMPLY_NODISCARD int64_t percentile(double percent) const noexcept;
+
+    ///   merge
+    /// Add the counts of another snapshot into this
+    ///
+    /// Throws `system_error` if the precisions differ
+    Snapshot& merge(const Snapshot& other);
+
+    ///   counts
+    /// Count of each bucket, see `lowest` and `highest` for their ranges
+    SIMPLY_NODISCARD const std::vector<uint64_t>& counts() const noexcept;
+
+    ///   lowest
+    /// Lowest value counted in a bucket
+    SIMPLY_NODISCARD int64_t lowest(size_t bucket) const noexcept;
+
+    ///   highest
+    /// Highest value counted in a bucket
+    SIMPLY_NODISCARD int64_t highest(size_t bucket) const noexcept;
+
+private:
+    friend LatencyHistogram;
+
+    unsigned _precision;
+    std::vector<uint64_t> _counts;
+    uint64_t _count;
+    uint64_t _sum;
+    int64_t _max;
+};
+
+// =====================================================================
+// LatencyHistogram >> Buckets
+// =====================================================================
+// Group 0 holds values below 2^precision exactly, and each following
+// group halves the resolution while covering twice the range
+inline size_t _latency_buckets(unsigned precision) noexcept {
+    return (45 - precision) * (size_t(1) << precision);
+}
+
+inline size_t _latency_bucket(uint64_t value, unsigned precision) noexcept {
+    const uint64_t linear = uint64_t(1) << precision;
+    if ( value < linear )
+        return static_cast<size_t>(value);
+    size_t shift = _highest_bit(value) - precision;
+    return static_cast<size_t>((shift + 1) * linear + ((value >> shift) - linear));
+}
+
+inline int64_t _latency_lowest(size_t bucket, unsigned precision) noexcept {
+    const size_t linear = size_t(1) << precision;
+    size_t group = bucket / linear;
+    if ( group == 0 )
+        return static_cast<int64_t>(bucket);
+    return static_cast<int64_t>((linear + bucket % linear) << (group - 1));
+}
+
+inline int64_t _latency_highest(size_t bucket, unsigned precision) noexcept {
+    size_t group = bucket >> precision;
+    if ( group == 0 )
+        return static_cast<int64_t>(bucket);
+    return _latency_lowest(bucket, precision) + (int64_t(1) << (group - 1)) - 1;
+}
+
+// =====================================================================
+// LatencyHistogram >> Implementations
+// =====================================================================
+// Validated before allocating any cells
+inline unsigned _latency_precision(unsigned precision) {
+    if ( precision < 1 || precision > 10 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "LatencyHistogram: precision must be from 1 to 10"
+        );
+    return precision;
+}
+
+inline LatencyHistogram::LatencyHistogram(unsigned precision):
+    LatencyHistogram(precision, _shard_count()) {}
+
+inline LatencyHistogram::LatencyHistogram(unsigned precision, size_t shards):
+    _precision(_latency_precision(precision)),
+    _buckets(_latency_buckets(precision)),
+    _cells(_buckets + 2, shards) {}
+
+inline void LatencyHistogram::record(int64_t ns) noexcept {
+    uint64_t value = static_cast<uint64_t>(std::clamp<int64_t>(ns, 0, max_value));
+    size_t shard = _cells.local();
+
+    _cells.cell(shard, _latency_bucket(value, _precision)).fetch_add(1, std::memory_order_relaxed);
+    _cells.cell(shard, _buckets).fetch_add(value, std::memory_order_relaxed);
+
+    std::atomic<uint64_t>& highest = _cells.cell(shard, _buckets + 1);
+    uint64_t current = highest.load(std::memory_order_relaxed);
+    while ( value > current && !highest.compare_exchange_weak(current, value, std::memory_order_relaxed) )
+        ;
+}
+
+template <class Rep, class Period>
+void LatencyHistogram::record(std::chrono::duration<Rep, Period> duration) noexcept {
+    record(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+}
+
+inline LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot(_precision);
+    for ( size_t shard = 0; shard < _cells.shards(); shard++ ) {
+        for ( size_t i = 0; i < _buckets; i++ ) {
+            uint64_t count = _cells.cell(shard, i).load(std::memory_order_relaxed);
+            snapshot._counts[i] += count;
+            snapshot._count     += count;
+        }
+        snapshot._sum += _cells.cell(shard, _buckets).load(std::memory_order_relaxed);
+        snapshot._max  = std::max(snapshot._max,
+            static_cast<int64_t>(_cells.cell(shard, _buckets + 1).load(std::memory_order_relaxed)));
+    }
+    return snapshot;
+}
+
+inline void LatencyHistogram::reset() noexcept {
+    _cells.reset();
+}
+
+inline unsigned LatencyHistogram::precision() const noexcept {
+    return _precision;
+}
+
+// =====================================================================
+// LatencyHistogram::Snapshot >> Implementations
+// =====================================================================
+inline LatencyHistogram::Snapshot::Snapshot(unsigned precision):
+    _precision(_latency_precision(precision)),
+    _counts(_latency_buckets(precision), 0),
+    _count(0),
+    _sum(0),
+    _max(0) {}
+
+inline uint64_t LatencyHistogram::Snapshot::count() const noexcept {
+    return _count;
+}
+
+inline int64_t LatencyHistogram::Snapshot::min() const noexcept {
+    for ( size_t i = 0; i < _counts.size(); i++ )
+        if ( _counts[i] )
+            return _latency_lowest(i, _precision);
+    return 0;
+}
+
+inline int64_t LatencyHistogram::Snapshot::max() const noexcept {
+    return _max;
+}
+
+inline double LatencyHistogram::Snapshot::mean() const noexcept {
+    return _count ? static_cast<double>(_sum) / static_cast<double>(_count) : 0.0;
+}
+
+inline int64_t LatencyHistogram::Snapshot::percentile(double percent) const noexcept {
+    if ( _count == 0 )
+        return 0;
+
+    double   wanted = std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(_count));
+    uint64_t rank   = std::max<uint64_t>(static_cast<uint64_t>(wanted), 1);
+    uint64_t seen   = 0;
+
+    for ( size_t i = 0; i < _counts.size(); i++ ) {
+        seen += _counts[i];
+        if ( seen >= rank )
+            return std::min(_latency_highest(i, _precision), _max);
+    }
+    return _max;
+}
+
+inline LatencyHistogram::Snapshot& LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    if ( other._precision != _precision )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "LatencyHistogram::Snapshot::merge: precisions differ"
+        );
+    for ( size_t i = 0; i < _counts.size(); i++ )
+        _counts[i] += other._counts[i];
+    _count += other._count;
+    _sum   += other._sum;
+    _max    = std::max(_max, other._max);
+    return *this;
+}
+
+inline const std::vector<uint64_t>& LatencyHistogram::Snapshot::counts() const noexcept {
+    return _counts;
+}
+
+inline int64_t LatencyHistogram::Snapshot::lowest(size_t bucket) const noexcept {
+    return _latency_lowest(bucket, _precision);
+}
+
+inline int64_t LatencyHistogram::Snapshot::highest(size_t bucket) const noexcept {
+    return _latency_highest(bucket, _precision);
+}
+}
+
+#endif // SIMPLY_HISTOGRAM_HPP_
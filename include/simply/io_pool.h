@@ -0,0 +1,320 @@
+/// io_pool.h
+/// Elastic pool of threads for blocking calls, such as file I/O
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// A thread blocked in `ReadFile` or `FlushFileBuffers` uses no CPU, but
+/// it is still a thread. In a pool sized to the CPUs, a few slow disks
+/// are enough to leave no thread for CPU work, and in the thread making
+/// the call, every other request waits behind it.
+///
+/// `BlockingIoPool` runs such calls on a separate set of threads, with
+/// its own limits and priority. Threads are started when work arrives
+/// and no thread is idle (up to `max_threads`), and exit after being
+/// idle for `idle_timeout` (down to `min_threads`). So a burst of slow
+/// calls gets many threads without keeping them, and blocked calls
+/// never hold threads another pool needs.
+///
+/// Each running thread records through an `ExecutorMetrics` worker
+/// (calls queued and run, queue latency, busy and idle time), one per
+/// thread up to `max_threads`, and given a `Watchdog`, marks a
+/// `Heartbeat` around each call.
+///
+///   Classes
+/// simply::BlockingIoPool
+///     Runs blocking calls on its own elastic set of threads.
+#ifndef SIMPLY_IO_POOL_HPP_
+#define SIMPLY_IO_POOL_HPP_
+
+#include "concurrency.h"
+#include "executor_metrics.h"
+#include "mutex.h"
+#include "task.h"
+#include "watchdog.h"
+
+#include <chrono>
+#include <deque>
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// BlockingIoPool >> Declaration
+// =====================================================================
+///   BlockingIoPool
+/// Runs blocking calls on its own, elastically sized, set of threads
+///
+///   Behaviours
+/// - First in, first out
+///     Calls start in the order offloaded, as threads become free.
+/// - Queued beyond max_threads
+///     With all `max_threads` busy, calls wait for one to become free.
+/// - Runs everything on destruction
+///     The destructor waits for all offloaded calls to finish.
+/// - Metrics per thread
+///     A thread takes a free worker of `metrics()` when started, and
+///     gives it back when it exits, so a worker may record several
+///     threads in turn.
+///
+///   Example
+/// ```
+/// simply::BlockingIoPool::Options opt;
+/// opt.max_threads = 16;
+/// simply::BlockingIoPool io(opt);
+///
+/// std::future<std::string> text = io.offload([](){ return read_file("data.txt"); });
+/// // ...CPU work, while the file is read...
+/// use(text.get());
+/// ```
+class BlockingIoPool final {
+public:
+    ///   Options
+    /// Settings for a pool
+    struct Options {
+        ///   min_threads
+        /// Threads kept even while idle, started on demand like the rest
+        size_t min_threads = 0;
+
+        ///   max_threads
+        /// Most threads running at once, at least 1
+        ///
+        /// Also the number of workers of `metrics()`, each about 20KB.
+        size_t max_threads = 64;
+
+        ///   idle_timeout
+        /// How long a thread beyond `min_threads` stays idle before exiting
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds(10);
+
+        ///   priority
+        /// Priority of the pool's threads
+        Thread::Priority priority = Thread::Priority::NORMAL;
+
+        ///   name
+        /// Name of the pool's threads, and of its metrics
+        std::string name = "simply::io";
+
+        ///   watchdog
+        /// Optionally, watchdog for a heartbeat in each thread, marked
+        /// around each call. Must outlive the pool.
+        Watchdog* watchdog = nullptr;
+    };
+
+public:
+    ///   Constructor
+    /// Make a pool with default options, with no threads until needed
+    BlockingIoPool();
+
+    ///   Constructor
+    /// Throws `system_error` for invalid options
+    explicit BlockingIoPool(Options opt);
+
+    ///   Destructor
+    /// Finish all offloaded calls, and stop all threads
+    ~BlockingIoPool();
+
+    ///   No copying or moving
+    BlockingIoPool(const BlockingIoPool&) = delete;
+    BlockingIoPool& operator=(const BlockingIoPool&) = delete;
+
+    ///   offload
+    /// Call f on one of the pool's threads
+    ///
+    /// Returns a future of f's result, or of what f throws.
+    /// Throws `system_error` if no thread could be started, and none run.
+    template <class F>
+    SIMPLY_NODISCARD std::future<std::invoke_result_t<std::decay_t<F>&>> offload(F&& f);
+
+    ///   threads
+    /// Number of threads running, busy or idle
+    SIMPLY_NODISCARD size_t threads() const;
+
+    ///   metrics
+    /// Metrics of the pool, with one worker per possible thread
+    ///
+    /// The queue depth counts calls waiting for a thread, and workers
+    /// parked more often than unparked are threads now idle.
+    SIMPLY_NODISCARD const ExecutorMetrics& metrics() const noexcept;
+
+private:
+    using _Threads = std::list<Thread>;
+
+    struct _Call {
+        Task task;
+        ExecutorMetrics::Clock::time_point enqueued;
+    };
+
+    static Options _validate(Options opt);
+    void _submit(Task task);
+    void _run(_Threads::iterator self, size_t worker);
+
+    const Options _opt;
+    ExecutorMetrics _metrics;
+
+    mutable Mutex _mutex;                   // Guards all below
+    ConditionVariable _wake;
+    bool _stopping = false;
+    std::deque<_Call> _queue;
+    size_t _idle = 0;
+    std::vector<size_t> _free_workers;      // Of _metrics, not taken by a running thread
+    _Threads _threads;                      // Running threads
+    _Threads _exited;                       // Returned from _run, joined by the next
+                                            // offload or the destructor
+};
+
+// =====================================================================
+// BlockingIoPool >> Implementations
+// =====================================================================
+inline BlockingIoPool::BlockingIoPool(): BlockingIoPool(Options()) {}
+
+inline BlockingIoPool::BlockingIoPool(Options opt):
+    _opt(_validate(std::move(opt))),
+    _metrics(_opt.name, _opt.max_threads)
+{
+    // Taken from the back, so the first threads record to the first workers
+    for ( size_t i = _opt.max_threads; i > 0; i-- )
+        _free_workers.push_back(i - 1);
+}
+
+inline BlockingIoPool::Options BlockingIoPool::_validate(Options opt) {
+    if ( opt.max_threads == 0 || opt.min_threads > opt.max_threads )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "BlockingIoPool: max_threads must be at least 1, and at least min_threads"
+        );
+    if ( opt.idle_timeout.count() <= 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "BlockingIoPool: idle_timeout must be positive"
+        );
+    return opt;
+}
+
+inline BlockingIoPool::~BlockingIoPool() {
+    _Threads joining;
+    {
+        std::unique_lock<Mutex> lock(_mutex);
+        _stopping = true;
+        _wake.notify_all();
+        _wake.wait(lock, [this](){ return _threads.empty(); });
+        joining.splice(joining.end(), _exited);
+    }
+    // Destroying each Thread joins it
+}
+
+template <class F>
+std::future<std::invoke_result_t<std::decay_t<F>&>> BlockingIoPool::offload(F&& f) {
+    using Result = std::invoke_result_t<std::decay_t<F>&>;
+    std::packaged_task<Result()> call(std::forward<F>(f));
+    std::future<Result> result = call.get_future();
+    _submit(Task(std::move(call)));
+    return result;
+}
+
+inline void BlockingIoPool::_submit(Task task) {
+    _Threads joining; // Exited threads, joined after unlocking
+    std::unique_lock<Mutex> lock(_mutex);
+    joining.splice(joining.end(), _exited);
+
+    _queue.push_back({std::move(task), ExecutorMetrics::Clock::now()});
+    _metrics.enqueued();
+    if ( _idle >= _queue.size() || _threads.size() >= _opt.max_threads ) {
+        lock.unlock();
+        _wake.notify_one();
+        return;
+    }
+
+    try {
+        Thread::Options thread_opt;
+        thread_opt.name = _opt.name;
+        thread_opt.priority = _opt.priority;
+        const size_t worker = _free_workers.back(); // One free per thread short of max_threads
+        auto self = _threads.emplace(_threads.end());
+        try {
+            *self = Thread(thread_opt, [this, self, worker](){ _run(self, worker); });
+        }
+        catch ( ... ) {
+            _threads.erase(self);
+            throw;
+        }
+        _free_workers.pop_back();
+    }
+    catch ( ... ) {
+        if ( !_threads.empty() )
+            return; // Queued for the running threads
+        _queue.pop_back();
+        _metrics.dequeued();
+        throw;
+    }
+}
+
+inline size_t BlockingIoPool::threads() const {
+    std::lock_guard<Mutex> guard(_mutex);
+    return _threads.size();
+}
+
+inline const ExecutorMetrics& BlockingIoPool::metrics() const noexcept {
+    return _metrics;
+}
+
+inline void BlockingIoPool::_run(_Threads::iterator self, size_t worker) {
+    std::optional<Heartbeat> heartbeat;
+    if ( _opt.watchdog )
+        heartbeat.emplace(*_opt.watchdog);
+    ExecutorMetrics::Worker& recorder = _metrics.worker(worker);
+
+    std::unique_lock<Mutex> lock(_mutex);
+    for ( ;; ) {
+        if ( _queue.empty() ) {
+            _idle++;
+            recorder.park();
+            const bool woken = _wake.wait_for(lock, _opt.idle_timeout, [this](){
+                return _stopping || !_queue.empty();
+            });
+            recorder.unpark();
+            _idle--;
+
+            if ( _queue.empty() ) {
+                if ( _stopping || (!woken && _threads.size() > _opt.min_threads) ) {
+                    _free_workers.push_back(worker);
+                    _exited.splice(_exited.end(), _threads, self);
+                    if ( _stopping )
+                        _wake.notify_all(); // The destructor may be waiting for the last
+                    return;
+                }
+                continue;
+            }
+        }
+
+        _Call call = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+
+        const auto started = recorder.task_started(call.enqueued);
+        if ( heartbeat )
+            heartbeat->begin("BlockingIoPool call");
+        call.task(); // A packaged_task, which keeps what it throws
+        if ( heartbeat )
+            heartbeat->end();
+        recorder.task_finished(started);
+        lock.lock();
+    }
+}
+}
+
+#endif // SIMPLY_IO_POOL_HPP_
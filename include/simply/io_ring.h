@@ -0,0 +1,579 @@
+/// io_ring.h
+/// Asynchronous file I/O, completed on a single reactor thread
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// `BlockingIoPool` (see io_pool.h) spends a thread per call in flight.
+/// With `IoRing`, calls are started without blocking, and any number of
+/// them complete through a single reactor `Thread` - so thousands of
+/// reads and writes may be in flight at once.
+///
+/// Each operation completes either as a `std::future`, or by calling a
+/// callback on the reactor thread. Arbitrary `Task`s may also be posted
+/// to run there, and timeouts set.
+///
+/// {note: Windows} Built on an I/O completion port. Reads and writes are
+///                 started by the calling thread (the system queues
+///                 them, there is no submission queue to batch), and
+///                 the reactor dequeues up to `Options::batch`
+///                 completions per wake. Files must be opened with
+///                 `FILE_FLAG_OVERLAPPED`, and `attach`ed once.
+///                 `FlushFileBuffers` cannot be started asynchronously,
+///                 so `flush` runs it on a small `BlockingIoPool`.
+///
+/// The reactor records through a single `ExecutorMetrics` worker, each
+/// operation counted as queued from its start until its completion is
+/// handled. Given a `Watchdog`, it marks a `Heartbeat` around each
+/// callback and task.
+///
+///   Classes
+/// simply::IoRing
+///     Reactor thread completing asynchronous file I/O.
+#ifndef SIMPLY_IO_RING_HPP_
+#define SIMPLY_IO_RING_HPP_
+
+#include "concurrency.h"
+#include "executor_metrics.h"
+#include "io_pool.h"
+#include "mutex.h"
+#include "task.h"
+#include "watchdog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// IoRing >> Helpers
+// =====================================================================
+// An operation in flight, deleted by the reactor once completed
+struct _IoOp {
+    OVERLAPPED overlapped = {};     // First, so a completed OVERLAPPED* is the _IoOp*
+    HANDLE file = nullptr;          // Null for operations completed by PostQueuedCompletionStatus
+    DWORD error = 0;                // For those, their result
+    DWORD bytes = 0;
+    std::function<void(std::error_code, size_t)> done;
+    Task task;                      // Posted tasks, instead of done
+    ExecutorMetrics::Clock::time_point started = ExecutorMetrics::Clock::now();
+};
+
+// Completion keys
+constexpr ULONG_PTR _io_key_file = 0;   // attach()ed files
+constexpr ULONG_PTR _io_key_op   = 1;   // A posted _IoOp
+constexpr ULONG_PTR _io_key_wake = 2;   // Timers or stopping changed
+
+// =====================================================================
+// IoRing >> Declaration
+// =====================================================================
+///   IoRing
+/// Reactor thread completing asynchronous file I/O
+///
+///   Behaviours
+/// - Callbacks run on the reactor thread
+///     So they must be short, and must not throw (which terminates).
+///     Block in them, and every other completion waits.
+/// - Buffers must stay valid until completion
+///     The system reads into, or writes from, them meanwhile.
+/// - Destruction waits for everything in flight
+///     Timeouts not yet due complete with `ERROR_OPERATION_ABORTED`. Reads
+///     and writes, which may never complete (such as reading a pipe), should
+///     be cancelled beforehand with `CancelIoEx`.
+/// - Stops if the completion port fails
+///     Which should never happen in use. Operations in flight then
+///     never complete, rather than the reactor spinning on the port.
+/// - Queue latency includes the device
+///     In `metrics()`, an operation is queued from when it is started, so
+///     its queue latency is the time the system took to complete it,
+///     plus the time its completion waited for the reactor.
+///
+///   Example
+/// ```
+/// simply::IoRing ring;
+/// HANDLE file = CreateFileW(L"data.bin", GENERIC_READ, FILE_SHARE_READ, nullptr,
+///                           OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+/// ring.attach(file);
+///
+/// std::vector<char> buffer(4096);
+/// std::future<size_t> read = ring.read(file, 0, buffer.data(), buffer.size());
+/// ring.read(file, 4096, other.data(), other.size(), [](std::error_code error, size_t bytes){
+///     // On the reactor thread
+/// });
+/// size_t bytes = read.get();
+/// ```
+class IoRing final {
+public:
+    ///   Callback
+    /// Called on the reactor thread with the result of an operation
+    using Callback = std::function<void(std::error_code error, size_t bytes)>;
+
+    ///   Clock
+    /// Clock for timeouts
+    using Clock = std::chrono::steady_clock;
+
+    ///   Options
+    /// Settings for the reactor thread
+    struct Options {
+        ///   affinity
+        /// Optionally pin the reactor thread, as `Thread::Options::affinity`
+        std::optional<uint64_t> affinity;
+
+        ///   priority
+        Thread::Priority priority = Thread::Priority::NORMAL;
+
+        ///   batch
+        /// Most completions dequeued per wake, at least 1
+        size_t batch = 64;
+
+        ///   flush_threads
+        /// Most `FlushFileBuffers` calls running at once
+        size_t flush_threads = 4;
+
+        ///   watchdog
+        /// Optionally, watchdog for heartbeats in the reactor and flush
+        /// threads, marked around each callback, task and flush. Must
+        /// outlive the ring.
+        Watchdog* watchdog = nullptr;
+    };
+
+public:
+    ///   Constructor
+    /// Start the reactor thread, with default options
+    IoRing();
+
+    ///   Constructor
+    /// Start the reactor thread
+    ///
+    /// Throws `system_error` for invalid options, or if the completion
+    /// port cannot be made
+    explicit IoRing(Options opt);
+
+    ///   Destructor
+    /// Wait for all operations, then stop the reactor thread
+    ~IoRing();
+
+    ///   No copying or moving
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    ///   attach
+    /// Complete I/O on file through this ring, from now on
+    ///
+    /// file must be opened with `FILE_FLAG_OVERLAPPED`, and can only be
+    /// attached to one ring. Throws `system_error` on failure.
+    void attach(HANDLE file);
+
+    ///   read
+    /// Start reading up to size bytes at offset of file into buffer
+    ///
+    /// The future is of the bytes read (0 at the end of the file), or
+    /// throws `system_error`. Throws `system_error` for sizes over 4GB.
+    SIMPLY_NODISCARD std::future<size_t> read(HANDLE file, uint64_t offset, void* buffer, size_t size);
+
+    ///   read
+    /// As above, calling done on completion instead
+    void read(HANDLE file, uint64_t offset, void* buffer, size_t size, Callback done);
+
+    ///   write
+    /// Start writing size bytes from buffer at offset of file
+    ///
+    /// The future is of the bytes written, or throws `system_error`.
+    /// Throws `system_error` for sizes over 4GB.
+    SIMPLY_NODISCARD std::future<size_t> write(HANDLE file, uint64_t offset, const void* buffer, size_t size);
+
+    ///   write
+    /// As above, calling done on completion instead
+    void write(HANDLE file, uint64_t offset, const void* buffer, size_t size, Callback done);
+
+    ///   flush
+    /// Start flushing file's buffered writes to the disk
+    SIMPLY_NODISCARD std::future<void> flush(HANDLE file);
+
+    ///   flush
+    /// As above, calling done (with 0 bytes) on completion instead
+    void flush(HANDLE file, Callback done);
+
+    ///   after
+    /// Complete after the given time, to at best a millisecond
+    SIMPLY_NODISCARD std::future<void> after(Clock::duration delay);
+
+    ///   after
+    /// As above, calling done (with 0 bytes) on completion instead
+    void after(Clock::duration delay, Callback done);
+
+    ///   post
+    /// Run task on the reactor thread
+    void post(Task task);
+
+    ///   pending
+    /// Number of operations started and not yet completed
+    SIMPLY_NODISCARD size_t pending() const noexcept;
+
+    ///   metrics
+    /// Metrics of the reactor, as its single worker
+    SIMPLY_NODISCARD const ExecutorMetrics& metrics() const noexcept;
+
+    ///   flush_metrics
+    /// Metrics of the threads running `flush`, see `BlockingIoPool::metrics`
+    SIMPLY_NODISCARD const ExecutorMetrics& flush_metrics() const noexcept;
+
+private:
+    struct _Timer {
+        Clock::time_point due;
+        _IoOp* op;
+        bool operator>(const _Timer& other) const noexcept { return due > other.due; }
+    };
+
+    void _start(HANDLE file, uint64_t offset, void* buffer, size_t size, bool write, Callback done);
+    void _post(_IoOp* op);
+    void _run();
+    void _dispatch(ULONG_PTR key, _IoOp* op) noexcept;
+    void _complete(ULONG_PTR key, _IoOp* op) noexcept;
+    DWORD _fire_timers();
+
+    const Options _opt;
+    HANDLE _port;
+    std::atomic<size_t> _pending{0};
+    ExecutorMetrics _metrics;
+
+    // Only used on the reactor
+    ExecutorMetrics::Worker& _recorder;
+    std::optional<Heartbeat> _heartbeat;
+
+    Mutex _mutex;                           // Guards the timers, and stopping
+    std::priority_queue<_Timer, std::vector<_Timer>, std::greater<_Timer>> _timers;
+    bool _stopping = false;
+
+    BlockingIoPool _flushes;
+    Thread _reactor;
+};
+
+// =====================================================================
+// IoRing >> Helpers
+// =====================================================================
+// Completes a future from a callback
+template <class T>
+IoRing::Callback _io_promise(std::shared_ptr<std::promise<T>> promise) {
+    return [promise = std::move(promise)](std::error_code error, size_t bytes){
+        if ( error )
+            promise->set_exception(std::make_exception_ptr(std::system_error(error)));
+        else if constexpr ( std::is_void_v<T> )
+            promise->set_value();
+        else
+            promise->set_value(bytes);
+    };
+}
+
+// =====================================================================
+// IoRing >> Implementations
+// =====================================================================
+inline IoRing::IoRing(): IoRing(Options()) {}
+
+inline IoRing::IoRing(Options opt):
+    _opt(opt),
+    _port(nullptr),
+    _metrics("simply::io_ring", 1),
+    _recorder(_metrics.worker(0)),
+    _flushes([&opt](){
+        BlockingIoPool::Options flush_opt;
+        flush_opt.max_threads = opt.flush_threads ? opt.flush_threads : 1;
+        flush_opt.name = "simply::io_ring flush";
+        flush_opt.watchdog = opt.watchdog;
+        return flush_opt;
+    }())
+{
+    if ( _opt.batch == 0 || _opt.flush_threads == 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "IoRing: batch and flush_threads must be at least 1"
+        );
+
+    _port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if ( !_port )
+        throw std::system_error(GetLastError(), std::system_category());
+
+    try {
+        Thread::Options thread_opt;
+        thread_opt.name = "simply::io_ring";
+        thread_opt.priority = _opt.priority;
+        thread_opt.affinity = _opt.affinity;
+        _reactor = Thread(thread_opt, [this](){ _run(); });
+    }
+    catch ( ... ) {
+        CloseHandle(_port);
+        throw;
+    }
+}
+
+inline IoRing::~IoRing() {
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        _stopping = true;
+    }
+    PostQueuedCompletionStatus(_port, 0, _io_key_wake, nullptr);
+    _reactor.join();
+    CloseHandle(_port);
+}
+
+inline void IoRing::attach(HANDLE file) {
+    if ( CreateIoCompletionPort(file, _port, _io_key_file, 0) != _port )
+        throw std::system_error(GetLastError(), std::system_category());
+    // Completions come through the port, so spare the kernel setting the file's event
+    SetFileCompletionNotificationModes(file, FILE_SKIP_SET_EVENT_ON_HANDLE);
+}
+
+inline std::future<size_t> IoRing::read(HANDLE file, uint64_t offset, void* buffer, size_t size) {
+    auto promise = std::make_shared<std::promise<size_t>>();
+    std::future<size_t> result = promise->get_future();
+    _start(file, offset, buffer, size, false, _io_promise(std::move(promise)));
+    return result;
+}
+
+inline void IoRing::read(HANDLE file, uint64_t offset, void* buffer, size_t size, Callback done) {
+    _start(file, offset, buffer, size, false, std::move(done));
+}
+
+inline std::future<size_t> IoRing::write(HANDLE file, uint64_t offset, const void* buffer, size_t size) {
+    auto promise = std::make_shared<std::promise<size_t>>();
+    std::future<size_t> result = promise->get_future();
+    _start(file, offset, const_cast<void*>(buffer), size, true, _io_promise(std::move(promise)));
+    return result;
+}
+
+inline void IoRing::write(HANDLE file, uint64_t offset, const void* buffer, size_t size, Callback done) {
+    _start(file, offset, const_cast<void*>(buffer), size, true, std::move(done));
+}
+
+inline void IoRing::_start(HANDLE file, uint64_t offset, void* buffer, size_t size, bool write, Callback done) {
+    if ( size > MAXDWORD )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            write ? "IoRing::write: size over 4GB" : "IoRing::read: size over 4GB"
+        );
+
+    auto op = std::make_unique<_IoOp>();
+    op->overlapped.Offset     = static_cast<DWORD>(offset);
+    op->overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    op->file = file;
+    op->done = std::move(done);
+
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    _metrics.enqueued();
+    const BOOL started = write
+        ? WriteFile(file, buffer, static_cast<DWORD>(size), nullptr, &op->overlapped)
+        : ReadFile(file, buffer, static_cast<DWORD>(size), nullptr, &op->overlapped);
+    const DWORD error = started ? ERROR_SUCCESS : GetLastError();
+
+    if ( started || error == ERROR_IO_PENDING ) {
+        op.release(); // Completes through the port, even if it finished at once
+        return;
+    }
+
+    // Failed to start, so nothing is queued - complete on the reactor,
+    // like any other failure
+    op->file  = nullptr;
+    op->error = error;
+    _post(op.release());
+}
+
+inline std::future<void> IoRing::flush(HANDLE file) {
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+    flush(file, _io_promise(std::move(promise)));
+    return result;
+}
+
+inline void IoRing::flush(HANDLE file, Callback done) {
+    auto op = std::make_unique<_IoOp>();
+    op->done = std::move(done);
+
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    _metrics.enqueued();
+    _IoOp* raw = op.get();
+    try {
+        (void)_flushes.offload([this, file, raw](){
+            raw->error = FlushFileBuffers(file) ? ERROR_SUCCESS : GetLastError();
+            _post(raw);
+        });
+    }
+    catch ( ... ) {
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        _metrics.dequeued();
+        throw;
+    }
+    op.release();
+}
+
+inline std::future<void> IoRing::after(Clock::duration delay) {
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+    after(delay, _io_promise(std::move(promise)));
+    return result;
+}
+
+inline void IoRing::after(Clock::duration delay, Callback done) {
+    auto op = std::make_unique<_IoOp>();
+    op->done = std::move(done);
+    const Clock::time_point due = Clock::now() + delay;
+
+    bool earliest;
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    _metrics.enqueued();
+    try {
+        std::lock_guard<Mutex> guard(_mutex);
+        earliest = _timers.empty() || due < _timers.top().due;
+        _timers.push({due, op.get()});
+    }
+    catch ( ... ) {
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        _metrics.dequeued();
+        throw;
+    }
+    op.release();
+
+    if ( earliest ) // The reactor may be waiting for a later timer
+        PostQueuedCompletionStatus(_port, 0, _io_key_wake, nullptr);
+}
+
+inline void IoRing::post(Task task) {
+    auto op = std::make_unique<_IoOp>();
+    op->task = std::move(task);
+    _pending.fetch_add(1, std::memory_order_relaxed);
+    _metrics.enqueued();
+    _post(op.release());
+}
+
+inline size_t IoRing::pending() const noexcept {
+    return _pending.load(std::memory_order_relaxed);
+}
+
+inline const ExecutorMetrics& IoRing::metrics() const noexcept {
+    return _metrics;
+}
+
+inline const ExecutorMetrics& IoRing::flush_metrics() const noexcept {
+    return _flushes.metrics();
+}
+
+inline void IoRing::_post(_IoOp* op) {
+    // Only fails if out of memory, after which the port is of little use.
+    // Completed here, on any thread, so not recorded by the reactor.
+    if ( !PostQueuedCompletionStatus(_port, op->bytes, _io_key_op, &op->overlapped) ) {
+        _metrics.dequeued();
+        _complete(_io_key_op, op);
+    }
+}
+
+inline void IoRing::_run() {
+    if ( _opt.watchdog )
+        _heartbeat.emplace(*_opt.watchdog);
+
+    std::vector<OVERLAPPED_ENTRY> entries(_opt.batch);
+    for ( ;; ) {
+        const DWORD timeout = _fire_timers();
+        if ( timeout == 0 && _pending.load(std::memory_order_acquire) == 0 )
+            break; // Stopping, and nothing left in flight
+
+        ULONG count = 0;
+        _recorder.park();
+        const BOOL dequeued = GetQueuedCompletionStatusEx(_port, entries.data(), static_cast<ULONG>(entries.size()),
+                                                          &count, timeout, FALSE);
+        _recorder.unpark();
+        if ( !dequeued ) {
+            if ( GetLastError() == WAIT_TIMEOUT )
+                continue;
+            break; // The port failed, so nothing more can complete
+        }
+
+        for ( ULONG i = 0; i < count; i++ )
+            if ( entries[i].lpCompletionKey != _io_key_wake )
+                _dispatch(entries[i].lpCompletionKey, reinterpret_cast<_IoOp*>(entries[i].lpOverlapped));
+    }
+    _heartbeat.reset();
+}
+
+// Completes due timers (all, if stopping), returning how long to wait
+// for the next, or 0 once stopping
+inline DWORD IoRing::_fire_timers() {
+    std::vector<_IoOp*> due;
+    std::vector<_IoOp*> canceled;
+    DWORD timeout = INFINITE;
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        const Clock::time_point now = Clock::now();
+        while ( !_timers.empty() && (_stopping || _timers.top().due <= now) ) {
+            (_timers.top().due <= now ? due : canceled).push_back(_timers.top().op);
+            _timers.pop();
+        }
+
+        if ( _stopping )
+            timeout = 0;
+        else if ( !_timers.empty() ) {
+            // Round up, so as never to wake early
+            const auto wait = std::chrono::ceil<std::chrono::milliseconds>(_timers.top().due - now);
+            timeout = static_cast<DWORD>(std::min<int64_t>(wait.count(), MAXDWORD - 1));
+        }
+    }
+
+    for ( _IoOp* op: due )
+        _dispatch(_io_key_op, op);
+    for ( _IoOp* op: canceled ) {
+        op->error = ERROR_OPERATION_ABORTED;
+        _dispatch(_io_key_op, op);
+    }
+
+    // While stopping, poll until the last operation completes
+    return timeout == 0 && _pending.load(std::memory_order_acquire) ? 1 : timeout;
+}
+
+// Completes op on the reactor, recording it
+inline void IoRing::_dispatch(ULONG_PTR key, _IoOp* op) noexcept {
+    const auto started = _recorder.task_started(op->started);
+    if ( _heartbeat )
+        _heartbeat->begin(op->task ? "IoRing task" : "IoRing callback");
+    _complete(key, op);
+    if ( _heartbeat )
+        _heartbeat->end();
+    _recorder.task_finished(started);
+}
+
+inline void IoRing::_complete(ULONG_PTR key, _IoOp* op) noexcept {
+    std::unique_ptr<_IoOp> owned(op);
+    if ( owned->task ) {
+        owned->task();
+    }
+    else {
+        DWORD error = owned->error;
+        DWORD bytes = owned->bytes;
+        if ( key == _io_key_file && !GetOverlappedResult(owned->file, &owned->overlapped, &bytes, FALSE) )
+            error = GetLastError();
+        if ( error == ERROR_HANDLE_EOF ) // Reading at or past the end
+            error = ERROR_SUCCESS;
+
+        owned->done(error ? std::error_code(static_cast<int>(error), std::system_category())
+                          : std::error_code(), bytes);
+    }
+    _pending.fetch_sub(1, std::memory_order_release);
+}
+}
+
+#endif // SIMPLY_IO_RING_HPP_
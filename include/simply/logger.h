@@ -0,0 +1,585 @@
+/// logger.h
+/// Asynchronous logger - threads copy arguments, a background thread formats
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Writing to `std::cout` from many threads makes them queue on the
+/// stream's lock, and on the I/O itself. With an `AsyncLogger`, a thread
+/// logging only copies a timestamp, the format string's address and the
+/// raw arguments into its own ring buffer (no formatting, no locks, no
+/// allocation). A background `Thread`, at LOW priority by default,
+/// drains all rings, formats, and writes in batches.
+///
+/// Messages from one thread keep their order. Messages from different
+/// threads are ordered by time within each batch.
+///
+///   Formatting
+/// Each `{}` in the format is replaced by the next argument. Arguments
+/// may be integers, floating point numbers, `bool`, `char`, enums,
+/// pointers, and strings (`const char*`, `std::string`,
+/// `std::string_view`), which are copied. Other types do not compile.
+///
+///   Classes
+/// simply::AsyncLogger
+///     Logs to an output stream from a background thread.
+#ifndef SIMPLY_LOGGER_HPP_
+#define SIMPLY_LOGGER_HPP_
+
+#include "concurrency.h"
+#include "mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// AsyncLogger >> Helpers
+// =====================================================================
+// Argument types, as encoded into a ring
+enum class _LogArg : uint8_t { INT, UINT, FLOAT, BOOL, CHAR, STRING, POINTER };
+
+// A message in a ring - this header, then each argument as its type
+// and value, padded to 8 bytes
+struct _LogHeader {
+    uint32_t size;          // Including this header, excluding padding
+    uint32_t thread;
+    int64_t time;           // system_clock ticks
+    const char* format;
+};
+
+constexpr uint32_t _log_wrap = 0xFFFFFFFF; // Size marking the rest of the ring unused
+
+inline size_t _log_align(size_t size) noexcept {
+    return (size + 7) & ~size_t(7);
+}
+
+template <class T>
+constexpr bool _log_string = std::is_convertible_v<const T&, std::string_view>
+                             && !std::is_same_v<std::decay_t<T>, std::nullptr_t>;
+
+template <class T>
+std::string_view _log_view(const T& value) noexcept {
+    if constexpr ( std::is_pointer_v<T> ) {
+        if ( !value )
+            return "(null)";
+    }
+    return std::string_view(value);
+}
+
+template <class T>
+size_t _log_size(const T& value) noexcept {
+    if constexpr ( _log_string<T> )
+        return 1 + sizeof(uint32_t) + _log_view(value).size();
+    else if constexpr ( std::is_same_v<T, bool> || std::is_same_v<T, char> )
+        return 2;
+    else
+        return 1 + 8;
+}
+
+template <class T>
+void _log_put(char*& out, const T& value) noexcept {
+    auto put = [&out](_LogArg type, const void* data, size_t size){
+        *out++ = static_cast<char>(type);
+        std::memcpy(out, data, size);
+        out += size;
+    };
+
+    if constexpr ( _log_string<T> ) {
+        const std::string_view view = _log_view(value);
+        const uint32_t length = static_cast<uint32_t>(view.size());
+        put(_LogArg::STRING, &length, sizeof(length));
+        std::memcpy(out, view.data(), length);
+        out += length;
+    }
+    else if constexpr ( std::is_same_v<T, bool> )
+        put(_LogArg::BOOL, &value, 1);
+    else if constexpr ( std::is_same_v<T, char> )
+        put(_LogArg::CHAR, &value, 1);
+    else if constexpr ( std::is_enum_v<T> )
+        _log_put(out, static_cast<std::underlying_type_t<T>>(value));
+    else if constexpr ( std::is_integral_v<T> && std::is_signed_v<T> ) {
+        const int64_t widened = value;
+        put(_LogArg::INT, &widened, 8);
+    }
+    else if constexpr ( std::is_integral_v<T> ) {
+        const uint64_t widened = value;
+        put(_LogArg::UINT, &widened, 8);
+    }
+    else if constexpr ( std::is_floating_point_v<T> ) {
+        const double widened = value;
+        put(_LogArg::FLOAT, &widened, 8);
+    }
+    else if constexpr ( std::is_pointer_v<T> || std::is_same_v<T, std::nullptr_t> ) {
+        const uint64_t address = reinterpret_cast<uintptr_t>(static_cast<const void*>(value));
+        put(_LogArg::POINTER, &address, 8);
+    }
+    else
+        static_assert(std::is_void_v<T>, "AsyncLogger: unsupported argument type");
+}
+
+// Appends the next argument at in to text, returning past it
+inline const char* _log_format_arg(std::string& text, const char* in) {
+    char buffer[32];
+    const _LogArg type = static_cast<_LogArg>(*in++);
+    switch ( type ) {
+        case _LogArg::STRING: {
+            uint32_t length;
+            std::memcpy(&length, in, sizeof(length));
+            in += sizeof(length);
+            text.append(in, length);
+            return in + length;
+        }
+        case _LogArg::BOOL:
+            text += *in ? "true" : "false";
+            return in + 1;
+        case _LogArg::CHAR:
+            text += *in;
+            return in + 1;
+        default:
+            break;
+    }
+
+    uint64_t bits;
+    std::memcpy(&bits, in, 8);
+    switch ( type ) {
+        case _LogArg::INT:
+            std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(bits));
+            break;
+        case _LogArg::UINT:
+            std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(bits));
+            break;
+        case _LogArg::FLOAT: {
+            double value;
+            std::memcpy(&value, &bits, 8);
+            std::snprintf(buffer, sizeof(buffer), "%g", value);
+            break;
+        }
+        default: // POINTER
+            std::snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(bits));
+    }
+    text += buffer;
+    return in + 8;
+}
+
+// Single producer (the owning thread), single consumer (the writer)
+class _LogRing final {
+public:
+    explicit _LogRing(size_t capacity):
+        thread(static_cast<uint32_t>(GetCurrentThreadId())),
+        _capacity(capacity),
+        _buffer(new char[capacity])
+    {}
+
+    // Space for a message of size bytes (aligned), or nullptr if full
+    char* reserve(size_t size) noexcept {
+        const size_t head   = _head.load(std::memory_order_relaxed);
+        const size_t offset = head & (_capacity - 1);
+        const size_t skip   = _capacity - offset < size ? _capacity - offset : 0;
+        if ( head + skip + size - _tail.load(std::memory_order_acquire) > _capacity )
+            return nullptr;
+
+        if ( skip ) { // Not enough left before the end, start over at the beginning
+            std::memcpy(_buffer.get() + offset, &_log_wrap, sizeof(_log_wrap));
+            _skip = skip;
+            return _buffer.get();
+        }
+        _skip = 0;
+        return _buffer.get() + offset;
+    }
+
+    void commit(size_t size) noexcept {
+        _head.store(_head.load(std::memory_order_relaxed) + _skip + size, std::memory_order_release);
+    }
+
+    // Calls f(header, arguments) for each message
+    template <class F>
+    void drain(F&& f) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t head = _head.load(std::memory_order_acquire);
+        while ( tail != head ) {
+            const size_t offset = tail & (_capacity - 1);
+            _LogHeader header;
+            std::memcpy(&header.size, _buffer.get() + offset, sizeof(header.size));
+            if ( header.size == _log_wrap ) {
+                tail += _capacity - offset;
+                continue;
+            }
+            std::memcpy(&header, _buffer.get() + offset, sizeof(header));
+            f(header, _buffer.get() + offset + sizeof(header));
+            tail += _log_align(header.size);
+        }
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    size_t capacity() const noexcept { return _capacity; }
+
+    const uint32_t thread;              // Owning thread's id
+
+    std::atomic<uint64_t> dropped{0};   // Since last drained, for Overflow::COUNT
+
+private:
+    const size_t _capacity;
+    const std::unique_ptr<char[]> _buffer;
+    size_t _skip = 0;                   // Only used by the producer
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+};
+
+// =====================================================================
+// AsyncLogger >> Declaration
+// =====================================================================
+///   AsyncLogger
+/// Logs to an output stream, formatting and writing on a background thread
+///
+///   Behaviours
+/// - Full rings follow `Options::overflow`
+///     Each thread has its own ring, which fills if it logs faster than
+///     the background thread writes.
+/// - Format strings are not copied
+///     So they must outlive the logger, for example string literals.
+/// - Written on destruction
+///     Everything logged before the destructor is written.
+///
+///   Example
+/// ```
+/// simply::AsyncLogger log(std::cout);
+///
+/// simply::Thread worker([&log](){
+///     log.log("loaded {} files in {}ms", count, elapsed);
+/// });
+/// ```
+/// Writes a line such as
+/// ```
+/// 2025-01-31 12:00:00.123456 [4242] loaded 12 files in 3.5ms
+/// ```
+class AsyncLogger final {
+public:
+    ///   Overflow
+    /// What to do when a thread's ring is full
+    enum class Overflow {
+        DROP,   // Discard the message, counted by `dropped`
+        BLOCK,  // Wait for the background thread to make space
+        COUNT   // As DROP, and also write how many were dropped
+    };
+
+    ///   Options
+    /// Settings for a logger
+    struct Options {
+        ///   ring_bytes
+        /// Size of each thread's ring, a power of 2 of at least 1KB
+        size_t ring_bytes = 64 * 1024;
+
+        ///   flush_interval
+        /// How often the background thread writes, at most
+        std::chrono::milliseconds flush_interval = std::chrono::milliseconds(10);
+
+        ///   overflow
+        Overflow overflow = Overflow::DROP;
+
+        ///   priority
+        /// Priority of the background thread
+        Thread::Priority priority = Thread::Priority::LOW;
+    };
+
+public:
+    ///   Constructor
+    /// Start logging to out, which must outlive the logger
+    explicit AsyncLogger(std::ostream& out);
+
+    ///   Constructor
+    /// Throws `system_error` for invalid options
+    AsyncLogger(std::ostream& out, Options opt);
+
+    ///   Destructor
+    /// Write everything logged, and stop the background thread
+    ~AsyncLogger();
+
+    ///   No copying or moving
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    ///   log
+    /// Log a message, replacing each `{}` in format by the next argument
+    ///
+    /// format must outlive the logger, for example a string literal
+    template <class... Args>
+    void log(const char* format, const Args&... args) noexcept;
+
+    ///   flush
+    /// Block until everything logged so far (by any thread) is written
+    void flush();
+
+    ///   dropped
+    /// Number of messages discarded as rings were full
+    SIMPLY_NODISCARD uint64_t dropped() const noexcept;
+
+private:
+    _LogRing* _local_ring() noexcept;
+    void _run();
+    void _write_all();
+    void _format(std::string& text, const _LogHeader& header, const char* args);
+
+    std::ostream& _out;
+    const Options _opt;
+    const uint64_t _id;                 // Tells loggers apart in threads' ring caches
+
+    std::atomic<uint64_t> _dropped{0};
+
+    // Rings are shared by their thread and this list, so the writer can
+    // still drain a ring after its thread has exited
+    Mutex _rings_mutex;
+    std::vector<std::shared_ptr<_LogRing>> _rings;
+
+    Mutex _mutex;
+    ConditionVariable _wake;
+    bool _stopping = false;
+    bool _space_wanted = false;         // A BLOCK producer waits for its ring to drain
+    uint64_t _flush_requested = 0;
+    uint64_t _flush_done = 0;
+
+    Thread _writer;
+};
+
+// =====================================================================
+// AsyncLogger >> Implementations
+// =====================================================================
+inline std::atomic<uint64_t> _logger_ids{1};
+
+inline AsyncLogger::AsyncLogger(std::ostream& out): AsyncLogger(out, Options()) {}
+
+inline AsyncLogger::AsyncLogger(std::ostream& out, Options opt):
+    _out(out),
+    _opt(opt),
+    _id(_logger_ids.fetch_add(1, std::memory_order_relaxed))
+{
+    if ( _opt.ring_bytes < 1024 || (_opt.ring_bytes & (_opt.ring_bytes - 1)) != 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "AsyncLogger: ring_bytes must be a power of 2 of at least 1KB"
+        );
+    if ( _opt.flush_interval.count() <= 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "AsyncLogger: flush_interval must be positive"
+        );
+
+    Thread::Options thread_opt;
+    thread_opt.name = "simply::logger";
+    thread_opt.priority = _opt.priority;
+    _writer = Thread(thread_opt, [this](){ _run(); });
+}
+
+inline AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+    _writer.join();
+}
+
+inline _LogRing* AsyncLogger::_local_ring() noexcept {
+    // Few loggers per thread, so a list beats a map
+    thread_local std::vector<std::pair<uint64_t, std::shared_ptr<_LogRing>>> rings;
+    for ( auto& [id, ring]: rings )
+        if ( id == _id )
+            return ring.get();
+
+    try {
+        // Forget rings of destroyed loggers
+        rings.erase(std::remove_if(rings.begin(), rings.end(), [](const auto& entry){
+            return entry.second.use_count() == 1;
+        }), rings.end());
+
+        auto made = std::make_shared<_LogRing>(_opt.ring_bytes);
+        {
+            std::lock_guard<Mutex> guard(_rings_mutex);
+            _rings.push_back(made);
+        }
+        rings.emplace_back(_id, made);
+        return made.get();
+    }
+    catch ( ... ) {
+        return nullptr; // Could not allocate - the message is dropped
+    }
+}
+
+template <class... Args>
+void AsyncLogger::log(const char* format, const Args&... args) noexcept {
+    const size_t used = sizeof(_LogHeader) + (size_t(0) + ... + _log_size(args));
+    const size_t size = _log_align(used);
+
+    _LogRing* ring = _local_ring();
+    if ( !ring || size > ring->capacity() / 2 ) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    char* out = ring->reserve(size);
+    while ( !out ) {
+        if ( _opt.overflow != Overflow::BLOCK ) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            if ( _opt.overflow == Overflow::COUNT )
+                ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        {
+            std::lock_guard<Mutex> guard(_mutex);
+            _space_wanted = true;
+        }
+        _wake.notify_all();
+        this_thread::yield();
+        out = ring->reserve(size);
+    }
+
+    const _LogHeader header{
+        static_cast<uint32_t>(used),
+        ring->thread,
+        std::chrono::system_clock::now().time_since_epoch().count(),
+        format
+    };
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    (_log_put(out, args), ...);
+    ring->commit(size);
+}
+
+inline void AsyncLogger::flush() {
+    std::unique_lock<Mutex> lock(_mutex);
+    const uint64_t request = ++_flush_requested;
+    _wake.notify_all();
+    _wake.wait(lock, [&](){ return _flush_done >= request; });
+}
+
+inline uint64_t AsyncLogger::dropped() const noexcept {
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+inline void AsyncLogger::_run() {
+    std::unique_lock<Mutex> lock(_mutex);
+    for ( ;; ) {
+        _wake.wait_for(lock, _opt.flush_interval, [this](){
+            return _stopping || _space_wanted || _flush_done < _flush_requested;
+        });
+        _space_wanted = false;
+        const bool stopping   = _stopping;
+        const uint64_t request = _flush_requested;
+
+        lock.unlock();
+        _write_all();
+        lock.lock();
+
+        if ( request > _flush_done ) {
+            _flush_done = request;
+            _wake.notify_all();
+        }
+        if ( stopping )
+            return;
+    }
+}
+
+// Drains every ring, forgetting rings of exited threads once empty
+inline void AsyncLogger::_write_all() {
+    struct Line {
+        int64_t time;
+        std::string text;
+    };
+    std::vector<Line> lines;
+
+    {
+        std::lock_guard<Mutex> guard(_rings_mutex);
+        for ( size_t i = 0; i < _rings.size(); ) {
+            // Orphaned before draining, so nothing can be logged into it after
+            const bool orphaned = _rings[i].use_count() == 1;
+            _LogRing& ring = *_rings[i];
+            ring.drain([&](const _LogHeader& header, const char* args){
+                lines.push_back({header.time, std::string()});
+                _format(lines.back().text, header, args);
+            });
+
+            if ( const uint64_t dropped = ring.dropped.exchange(0, std::memory_order_relaxed) ) {
+                const int64_t now = std::chrono::system_clock::now().time_since_epoch().count();
+                lines.push_back({now, std::string()});
+                char args[9];
+                char* out = args;
+                _log_put(out, dropped);
+                const _LogHeader header{
+                    static_cast<uint32_t>(sizeof(_LogHeader) + sizeof(args)), 0, now, "[{} messages dropped]"
+                };
+                _format(lines.back().text, header, args);
+            }
+
+            if ( orphaned ) {
+                _rings[i] = std::move(_rings.back());
+                _rings.pop_back();
+            }
+            else
+                i++;
+        }
+    }
+
+    if ( lines.empty() )
+        return;
+
+    std::stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b){
+        return a.time < b.time;
+    });
+    std::string batch;
+    for ( const Line& line: lines )
+        batch += line.text;
+    _out.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    _out.flush();
+}
+
+// Writes "YYYY-MM-DD hh:mm:ss.uuuuuu [thread] message\n", in UTC
+inline void AsyncLogger::_format(std::string& text, const _LogHeader& header, const char* args) {
+    using namespace std::chrono;
+    const system_clock::time_point time{system_clock::duration(header.time)};
+    const std::time_t seconds = system_clock::to_time_t(time);
+    const auto micros = duration_cast<microseconds>(time.time_since_epoch()).count() % 1000000;
+
+    std::tm utc;
+    gmtime_s(&utc, &seconds);
+    char stamp[64];
+    const int length = std::snprintf(stamp, sizeof(stamp), "%04d-%02d-%02d %02d:%02d:%02d.%06d [%u] ",
+        utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec,
+        static_cast<int>(micros), header.thread);
+    text.append(stamp, static_cast<size_t>(length));
+
+    const char* end = args - sizeof(_LogHeader) + header.size;
+    for ( const char* in = header.format; *in; in++ ) {
+        if ( in[0] == '{' && in[1] == '}' && args < end ) {
+            args = _log_format_arg(text, args);
+            in++;
+        }
+        else
+            text += *in;
+    }
+    text += '\n';
+}
+}
+
+#endif // SIMPLY_LOGGER_HPP_
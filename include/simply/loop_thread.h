@@ -0,0 +1,367 @@
+/// loop_thread.h
+/// Thread running a loop, onto which other threads post work
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Some things are best owned by a single thread - a window, a device,
+/// a library which is not thread-safe. A `LoopThread` is such a thread:
+/// it runs a loop, and other threads `post` work to it (fire and
+/// forget), or `invoke` work on it (waiting for the result).
+///
+/// Posting takes a lock only to append to a queue, and only the post
+/// making the queue non-empty wakes the loop - which then runs every
+/// task queued meanwhile, as one batch.
+///
+/// The loop can also wait on handles (events, processes, waitable
+/// timers, ...), calling back when one is signalled.
+///
+/// The loop records through a single `ExecutorMetrics` worker, and
+/// given a `Watchdog`, marks a `Heartbeat` around each task and callback.
+///
+/// {note: Windows} The loop waits with `WaitForMultipleObjects`, on an
+///                 event for posted work and on the watched handles,
+///                 so at most 63 handles may be watched.
+///
+///   Classes
+/// simply::LoopThread
+///     Thread running posted tasks and handle callbacks.
+#ifndef SIMPLY_LOOP_THREAD_HPP_
+#define SIMPLY_LOOP_THREAD_HPP_
+
+#include "concurrency.h"
+#include "executor_metrics.h"
+#include "mutex.h"
+#include "task.h"
+#include "watchdog.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// LoopThread >> Declaration
+// =====================================================================
+///   LoopThread
+/// Thread running tasks posted by other threads, and handle callbacks
+///
+///   Behaviours
+/// - In order
+///     Tasks posted by one thread run in the order posted.
+/// - Tasks must not throw
+///     Anything thrown by a posted task terminates the program, as for
+///     `Thread`. `invoke` instead rethrows in the calling thread.
+/// - Runs everything on destruction
+///     Tasks posted before the destructor are run before it returns.
+/// - Callbacks are tasks too
+///     `metrics()` counts each handle callback as a task, started as
+///     soon as the loop saw its handle signalled.
+///
+///   Example
+/// ```
+/// simply::LoopThread device;
+/// device.post([](){ open_device(); });
+/// int status = device.invoke([](){ return read_status(); }); // Waits
+///
+/// device.watch(data_ready_event, [](){
+///     read_data(); // On the loop, each time the event is signalled
+/// });
+/// ```
+class LoopThread final {
+public:
+    ///   Options
+    /// Settings for the loop's thread
+    struct Options {
+        ///   name
+        /// Name of the loop's thread, and of its metrics
+        std::string name = "simply::loop";
+
+        ///   priority
+        std::optional<Thread::Priority> priority;
+
+        ///   affinity
+        /// Optionally pin the loop, as `Thread::Options::affinity`
+        std::optional<uint64_t> affinity;
+
+        ///   watchdog
+        /// Optionally, watchdog for a heartbeat in the loop, marked
+        /// around each task and callback. Must outlive the loop.
+        Watchdog* watchdog = nullptr;
+    };
+
+public:
+    ///   Constructor
+    /// Start the loop, with default options
+    LoopThread();
+
+    ///   Constructor
+    /// Start the loop
+    ///
+    /// Throws `system_error` if the thread or its event cannot be made
+    explicit LoopThread(Options opt);
+
+    ///   Destructor
+    /// Run all posted tasks, then stop the loop
+    ~LoopThread();
+
+    ///   No copying or moving
+    LoopThread(const LoopThread&) = delete;
+    LoopThread& operator=(const LoopThread&) = delete;
+
+    ///   post
+    /// Queue task to run on the loop, returning at once
+    void post(Task task);
+
+    ///   invoke
+    /// Run f on the loop, and return its result (or throw what it threw)
+    ///
+    /// Called from the loop itself, f is run directly.
+    template <class F>
+    std::invoke_result_t<std::decay_t<F>&> invoke(F&& f);
+
+    ///   watch
+    /// Call on_signalled on the loop whenever handle is signalled
+    ///
+    /// A handle which stays signalled (such as a manual-reset event, or
+    /// an exited process) is called back on every turn of the loop, so
+    /// should be reset or unwatched by the callback. An abandoned mutex
+    /// counts as signalled. handle needs `SYNCHRONIZE` access, and must
+    /// stay open until unwatched - one closed anyway is unwatched once
+    /// the loop's wait fails on it.
+    /// Throws `system_error` if already watched, or if 63 handles already
+    /// are.
+    void watch(HANDLE handle, std::function<void()> on_signalled);
+
+    ///   unwatch
+    /// Stop watching handle, if watched
+    ///
+    /// Once returned, the handle's callback is not running, and will
+    /// not be called again.
+    void unwatch(HANDLE handle);
+
+    ///   in_loop
+    /// Whether the calling thread is the loop's
+    SIMPLY_NODISCARD bool in_loop() const noexcept;
+
+    ///   get_id
+    /// Id of the loop's thread
+    SIMPLY_NODISCARD Thread::id get_id() const noexcept;
+
+    ///   metrics
+    /// Metrics of the loop, as its single worker
+    SIMPLY_NODISCARD const ExecutorMetrics& metrics() const noexcept;
+
+private:
+    struct _Posted {
+        Task task;
+        ExecutorMetrics::Clock::time_point enqueued;
+    };
+
+    void _run();
+    void _unwatch_failed();
+
+    HANDLE _wake;                           // Auto-reset, set when the queue becomes non-empty
+    Watchdog* _watchdog;
+    ExecutorMetrics _metrics;
+
+    Mutex _mutex;                           // Guards the queue, and stopping
+    std::vector<_Posted> _queue;
+    bool _stopping = false;
+
+    // Only used on the loop
+    std::vector<HANDLE> _handles;           // _wake first, then the watched handles
+    std::vector<std::function<void()>> _callbacks;
+
+    Thread _thread;
+};
+
+// =====================================================================
+// LoopThread >> Implementations
+// =====================================================================
+inline LoopThread::LoopThread(): LoopThread(Options()) {}
+
+inline LoopThread::LoopThread(Options opt):
+    _wake(CreateEventW(nullptr, FALSE, FALSE, nullptr)),
+    _watchdog(opt.watchdog),
+    _metrics(opt.name, 1)
+{
+    if ( !_wake )
+        throw std::system_error(GetLastError(), std::system_category());
+
+    try {
+        _handles.push_back(_wake);
+        _callbacks.emplace_back();
+
+        Thread::Options thread_opt;
+        thread_opt.name = std::move(opt.name);
+        thread_opt.priority = opt.priority;
+        thread_opt.affinity = opt.affinity;
+        _thread = Thread(thread_opt, [this](){ _run(); });
+    }
+    catch ( ... ) {
+        CloseHandle(_wake);
+        throw;
+    }
+}
+
+inline LoopThread::~LoopThread() {
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        _stopping = true;
+    }
+    SetEvent(_wake);
+    _thread.join();
+    CloseHandle(_wake);
+}
+
+inline void LoopThread::post(Task task) {
+    bool was_empty;
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        was_empty = _queue.empty();
+        _queue.push_back({std::move(task), ExecutorMetrics::Clock::now()});
+        _metrics.enqueued();
+    }
+    if ( was_empty ) // Otherwise the loop is already woken, and takes this in the same batch
+        SetEvent(_wake);
+}
+
+template <class F>
+std::invoke_result_t<std::decay_t<F>&> LoopThread::invoke(F&& f) {
+    if ( in_loop() )
+        return f();
+
+    using Result = std::invoke_result_t<std::decay_t<F>&>;
+    std::packaged_task<Result()> call(std::forward<F>(f));
+    std::future<Result> result = call.get_future();
+    post(Task(std::move(call)));
+    return result.get();
+}
+
+inline void LoopThread::watch(HANDLE handle, std::function<void()> on_signalled) {
+    invoke([this, handle, &on_signalled](){
+        if ( std::find(_handles.begin(), _handles.end(), handle) != _handles.end() )
+            throw std::system_error(
+                std::make_error_code(std::errc::invalid_argument),
+                "LoopThread::watch: handle already watched"
+            );
+        if ( _handles.size() >= MAXIMUM_WAIT_OBJECTS )
+            throw std::system_error(
+                std::make_error_code(std::errc::too_many_files_open),
+                "LoopThread::watch: too many handles"
+            );
+        _handles.push_back(handle);
+        _callbacks.push_back(std::move(on_signalled));
+    });
+}
+
+inline void LoopThread::unwatch(HANDLE handle) {
+    invoke([this, handle](){
+        auto found = std::find(_handles.begin() + 1, _handles.end(), handle);
+        if ( found == _handles.end() )
+            return;
+        _callbacks.erase(_callbacks.begin() + (found - _handles.begin()));
+        _handles.erase(found);
+    });
+}
+
+inline bool LoopThread::in_loop() const noexcept {
+    return this_thread::get_id() == _thread.get_id();
+}
+
+inline Thread::id LoopThread::get_id() const noexcept {
+    return _thread.get_id();
+}
+
+inline const ExecutorMetrics& LoopThread::metrics() const noexcept {
+    return _metrics;
+}
+
+inline void LoopThread::_run() {
+    std::optional<Heartbeat> heartbeat;
+    if ( _watchdog )
+        heartbeat.emplace(*_watchdog);
+    ExecutorMetrics::Worker& recorder = _metrics.worker(0);
+
+    std::vector<_Posted> batch;
+    for ( ;; ) {
+        recorder.park();
+        const DWORD waited = WaitForMultipleObjects(static_cast<DWORD>(_handles.size()), _handles.data(),
+                                                    FALSE, INFINITE);
+        recorder.unpark();
+        DWORD index = waited - WAIT_OBJECT_0;
+        if ( waited >= WAIT_ABANDONED_0 && waited < WAIT_ABANDONED_0 + _handles.size() )
+            index = waited - WAIT_ABANDONED_0; // A mutex whose owner exited, now owned by the loop
+
+        if ( index > 0 && index < _handles.size() ) {
+            // Copied, as the callback may unwatch itself
+            std::function<void()> callback = _callbacks[index];
+            _metrics.enqueued();
+            const auto started = recorder.task_started(ExecutorMetrics::Clock::now());
+            if ( heartbeat )
+                heartbeat->begin("LoopThread callback");
+            callback();
+            if ( heartbeat )
+                heartbeat->end();
+            recorder.task_finished(started);
+            continue;
+        }
+        if ( waited == WAIT_FAILED ) // Such as a handle closed while watched
+            _unwatch_failed();     // Then run whatever was posted meanwhile
+
+        // Run the batch - tasks posted meanwhile set the event again
+        bool stopping;
+        {
+            std::lock_guard<Mutex> guard(_mutex);
+            batch.swap(_queue);
+            stopping = _stopping;
+        }
+        for ( _Posted& posted: batch ) {
+            const auto started = recorder.task_started(posted.enqueued);
+            if ( heartbeat )
+                heartbeat->begin("LoopThread task");
+            posted.task();
+            if ( heartbeat )
+                heartbeat->end();
+            recorder.task_finished(started);
+        }
+        batch.clear();
+
+        if ( stopping ) {
+            std::lock_guard<Mutex> guard(_mutex);
+            if ( _queue.empty() )
+                return;
+        }
+    }
+}
+
+// Unwatches handles closed while watched - found without waiting on
+// them, which would take a signal from those still open
+inline void LoopThread::_unwatch_failed() {
+    for ( size_t i = _handles.size() - 1; i > 0; i-- ) {
+        DWORD flags;
+        if ( !GetHandleInformation(_handles[i], &flags) ) {
+            _handles.erase(_handles.begin() + i);
+            _callbacks.erase(_callbacks.begin() + i);
+        }
+    }
+}
+}
+
+#endif // SIMPLY_LOOP_THREAD_HPP_
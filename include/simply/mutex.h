@@ -0,0 +1,736 @@
+/// mutex.h
+/// Mutexes and condition variables, with optional contention profiling
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Drop-in replacements for `std::mutex`, `std::shared_mutex` and
+/// `std::condition_variable`, built directly on the system's slim
+/// reader/writer locks. They work with `std::lock_guard`,
+/// `std::unique_lock`, `std::shared_lock` and `std::scoped_lock`.
+///
+///   Contention profiling
+/// Defining `SIMPLY_PROFILE_LOCKS` (for the whole program, as it
+/// changes the size of the classes) makes every acquisition record,
+/// per lock site:
+/// - acquisitions, and how many had to wait (were contended)
+/// - total and longest time spent waiting
+/// - total and longest time held (exclusive locks only)
+///
+/// A lock site is the call stack acquiring the lock, so acquisitions
+/// through `std::lock_guard` etc. are still told apart by their caller.
+/// `lock_profile::dump` writes all sites, most waited-on first, with
+/// stacks as `module+offset` for symbolizing offline (like Go's mutex
+/// profile, but also counting uncontended acquisitions).
+///
+/// Capturing the stack makes each profiled acquisition cost around a
+/// microsecond, so `lock_profile::set_fraction` may profile only 1 in N.
+/// Without `SIMPLY_PROFILE_LOCKS`, none of this is compiled in, and the
+/// classes are exactly the bare system locks.
+///
+/// Either way, waits for a contended lock are seen by trace.h and
+/// flight_recorder.h, costing a single branch while neither is running.
+///
+///   Classes
+/// simply::Mutex
+///     Exclusive lock, like `std::mutex`.
+/// simply::SharedMutex
+///     Reader/writer lock, like `std::shared_mutex`.
+/// simply::ConditionVariable
+///     Waits on a `Mutex`, like `std::condition_variable`.
+///
+///   Functions
+/// simply::lock_profile::dump / sites / reset / set_fraction
+///     Read and control the contention profile.
+#ifndef SIMPLY_MUTEX_HPP_
+#define SIMPLY_MUTEX_HPP_
+
+#include "concurrency.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <system_error>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// lock_profile >> Declarations
+// =====================================================================
+///   lock_profile
+/// Contention profile of `Mutex`, `SharedMutex` and `ConditionVariable`
+///
+/// Only collected when `SIMPLY_PROFILE_LOCKS` is defined, otherwise
+/// `sites` is always empty.
+namespace lock_profile {
+    ///   enabled
+    /// Whether profiling is compiled in
+#ifdef SIMPLY_PROFILE_LOCKS
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    ///   Site
+    /// Statistics of acquisitions from one call stack
+    struct Site {
+        ///   kind
+        /// 'x' exclusive lock, 's' shared lock or 'c' condition wait
+        char kind;
+
+        uint64_t acquisitions;
+        uint64_t contended;
+        std::chrono::nanoseconds total_wait;
+        std::chrono::nanoseconds max_wait;
+        std::chrono::nanoseconds total_hold;
+        std::chrono::nanoseconds max_hold;
+
+        ///   stack
+        /// Return addresses, innermost first (which may be in this library)
+        std::vector<void*> stack;
+    };
+
+    ///   sites
+    /// Statistics of all lock sites, most total wait first
+    SIMPLY_NODISCARD std::vector<Site> sites();
+
+    ///   dump
+    /// Write all lock sites as a table, most total wait first
+    void dump(std::ostream& ost);
+
+    ///   reset
+    /// Clear all statistics
+    void reset() noexcept;
+
+    ///   set_fraction
+    /// Profile 1 in every `fraction` acquisitions (per thread)
+    ///
+    /// Defaults to 1, every acquisition. 0 stops profiling.
+    void set_fraction(uint32_t fraction) noexcept;
+}
+
+// =====================================================================
+// Mutex & SharedMutex >> Helpers
+// =====================================================================
+// Acquires, telling hooks (such as flight_recorder.h) when it must wait.
+// Trying first costs nothing extra, as acquiring starts the same way.
+template <class TryAcquire, class Acquire>
+void _acquire(const void* lock, TryAcquire&& try_acquire, Acquire&& acquire) noexcept {
+    if ( try_acquire() )
+        return;
+    _notify(_HookEvent::LOCK_WAIT_BEGIN, reinterpret_cast<uintptr_t>(lock));
+    acquire();
+    _notify(_HookEvent::LOCK_WAIT_END, reinterpret_cast<uintptr_t>(lock));
+}
+
+// =====================================================================
+// lock_profile >> Helpers
+// =====================================================================
+#ifdef SIMPLY_PROFILE_LOCKS
+constexpr size_t _lock_site_count  = 1024; // Power of 2
+constexpr size_t _lock_stack_depth = 12;
+
+struct _LockSite {
+    std::atomic<uint32_t> key{0};       // Hash of the stack, 0 while unclaimed
+    std::atomic<bool> ready{false};     // Set once kind and stack are written
+    char kind;
+    void* stack[_lock_stack_depth];
+    size_t depth;
+
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<int64_t> total_wait{0};
+    std::atomic<int64_t> max_wait{0};
+    std::atomic<int64_t> total_hold{0};
+    std::atomic<int64_t> max_hold{0};
+};
+
+inline _LockSite _lock_sites[_lock_site_count];
+inline std::atomic<uint32_t> _lock_fraction{1};
+
+inline int64_t _lock_now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+inline void _lock_max(std::atomic<int64_t>& max, int64_t value) noexcept {
+    int64_t current = max.load(std::memory_order_relaxed);
+    while ( value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed) )
+        ;
+}
+
+inline bool _lock_sampled() noexcept {
+    thread_local uint32_t counter = 0;
+    const uint32_t fraction = _lock_fraction.load(std::memory_order_relaxed);
+    return fraction && ++counter % fraction == 0;
+}
+
+// Site of the calling stack, or nullptr if all sites are taken
+inline _LockSite* _lock_site(char kind) noexcept {
+    void* stack[_lock_stack_depth];
+    DWORD hash = 0;
+    // Skip nothing - with inlining, even this frame may be the caller's
+    const size_t depth = RtlCaptureStackBackTrace(0, _lock_stack_depth, stack, &hash);
+    const uint32_t key = (static_cast<uint32_t>(hash) ^ static_cast<uint32_t>(kind) * 0x9E3779B9u) | 1;
+
+    for ( size_t probe = 0; probe < _lock_site_count; probe++ ) {
+        _LockSite& site = _lock_sites[(key + probe) & (_lock_site_count - 1)];
+        uint32_t found = site.key.load(std::memory_order_acquire);
+        if ( found == 0 && site.key.compare_exchange_strong(found, key, std::memory_order_acq_rel) ) {
+            site.kind  = kind;
+            site.depth = depth;
+            std::copy(stack, stack + depth, site.stack);
+            site.ready.store(true, std::memory_order_release);
+            return &site;
+        }
+        if ( found == key )
+            return &site;
+    }
+    return nullptr;
+}
+
+inline void _lock_record_wait(_LockSite* site, bool contended, int64_t wait) noexcept {
+    if ( !site )
+        return;
+    site->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if ( contended ) {
+        site->contended.fetch_add(1, std::memory_order_relaxed);
+        site->total_wait.fetch_add(wait, std::memory_order_relaxed);
+        _lock_max(site->max_wait, wait);
+    }
+}
+
+inline void _lock_record_hold(_LockSite* site, int64_t hold) noexcept {
+    if ( !site )
+        return;
+    site->total_hold.fetch_add(hold, std::memory_order_relaxed);
+    _lock_max(site->max_hold, hold);
+}
+
+// Profiles one acquisition, returning its site (nullptr if not sampled)
+template <class TryAcquire, class Acquire>
+_LockSite* _profiled_acquire(char kind, const void* lock, TryAcquire&& try_acquire, Acquire&& acquire) {
+    if ( !_lock_sampled() ) {
+        _acquire(lock, try_acquire, acquire);
+        return nullptr;
+    }
+
+    _LockSite* site = _lock_site(kind);
+    int64_t wait = 0;
+    const bool contended = !try_acquire();
+    if ( contended ) {
+        const int64_t start = _lock_now();
+        _notify(_HookEvent::LOCK_WAIT_BEGIN, reinterpret_cast<uintptr_t>(lock));
+        acquire();
+        _notify(_HookEvent::LOCK_WAIT_END, reinterpret_cast<uintptr_t>(lock));
+        wait = _lock_now() - start;
+    }
+    _lock_record_wait(site, contended, wait);
+    return site;
+}
+#endif
+
+// =====================================================================
+// Mutex >> Declaration
+// =====================================================================
+///   Mutex
+/// Exclusive lock, with the same interface as `std::mutex`
+///
+///   Behaviours
+/// - Not recursive
+///     Locking a mutex already held by the calling thread deadlocks.
+/// - Not fair
+///     Waiting threads are not necessarily woken in order.
+/// - Profiled when `SIMPLY_PROFILE_LOCKS` is defined
+///     See notes at start of file.
+///
+///   Example
+/// ```
+/// simply::Mutex mutex;
+/// {
+///     std::lock_guard<simply::Mutex> guard(mutex);
+///     ... // Exclusive access
+/// }
+/// ```
+class Mutex final {
+public:
+    Mutex() noexcept = default;
+
+    ///   No copying or moving
+    Mutex(const Mutex&) = delete;
+    Mutex& operator=(const Mutex&) = delete;
+
+    ///   lock
+    /// Block until the lock is acquired
+    void lock() noexcept;
+
+    ///   try_lock
+    /// Acquire the lock if free, returns whether acquired
+    SIMPLY_NODISCARD bool try_lock() noexcept;
+
+    ///   unlock
+    /// Release the lock, which must be held by the calling thread
+    void unlock() noexcept;
+
+private:
+    friend class ConditionVariable;
+
+#ifdef SIMPLY_PROFILE_LOCKS
+    void _begin_hold(_LockSite* site) noexcept;
+    void _end_hold() noexcept;
+
+    _LockSite* _site = nullptr; // Of the current holder, if profiled
+    int64_t _since   = 0;
+#endif
+
+    SRWLOCK _lock = SRWLOCK_INIT;
+};
+
+// =====================================================================
+// SharedMutex >> Declaration
+// =====================================================================
+///   SharedMutex
+/// Reader/writer lock, with the same interface as `std::shared_mutex`
+///
+///   Behaviours
+/// - As `Mutex`
+///     Neither recursive nor fair, in either mode.
+/// - Profiled when `SIMPLY_PROFILE_LOCKS` is defined
+///     Hold time is only measured for exclusive locks, as any number of
+///     threads may hold the shared lock at once.
+///
+///   Example
+/// ```
+/// simply::SharedMutex mutex;
+///
+/// std::shared_lock<simply::SharedMutex> reading(mutex); // Many at once
+/// std::unique_lock<simply::SharedMutex> writing(mutex); // One at a time
+/// ```
+class SharedMutex final {
+public:
+    SharedMutex() noexcept = default;
+
+    ///   No copying or moving
+    SharedMutex(const SharedMutex&) = delete;
+    SharedMutex& operator=(const SharedMutex&) = delete;
+
+    ///   lock
+    /// Block until the exclusive lock is acquired
+    void lock() noexcept;
+
+    ///   try_lock
+    /// Acquire the exclusive lock if free, returns whether acquired
+    SIMPLY_NODISCARD bool try_lock() noexcept;
+
+    ///   unlock
+    /// Release the exclusive lock
+    void unlock() noexcept;
+
+    ///   lock_shared
+    /// Block until the shared lock is acquired
+    void lock_shared() noexcept;
+
+    ///   try_lock_shared
+    /// Acquire the shared lock if not held exclusively, returns whether acquired
+    SIMPLY_NODISCARD bool try_lock_shared() noexcept;
+
+    ///   unlock_shared
+    /// Release the shared lock
+    void unlock_shared() noexcept;
+
+private:
+#ifdef SIMPLY_PROFILE_LOCKS
+    _LockSite* _site = nullptr; // Of the exclusive holder, if profiled
+    int64_t _since   = 0;
+#endif
+
+    SRWLOCK _lock = SRWLOCK_INIT;
+};
+
+// =====================================================================
+// ConditionVariable >> Declaration
+// =====================================================================
+///   ConditionVariable
+/// Waits on a `Mutex`, with the same interface as `std::condition_variable`
+///
+///   Behaviours
+/// - Spurious wake-ups
+///     As for `std::condition_variable`, `wait` may return without a
+///     notification, so prefer the overloads taking a predicate.
+/// - Profiled when `SIMPLY_PROFILE_LOCKS` is defined
+///     Each wait is recorded as contended, at the waiting call stack,
+///     and ends the mutex's hold time until it is reacquired.
+///
+///   Example
+/// ```
+/// simply::Mutex mutex;
+/// simply::ConditionVariable ready_cv;
+/// bool ready = false;
+///
+/// std::unique_lock<simply::Mutex> lock(mutex);
+/// ready_cv.wait(lock, [&](){ return ready; });
+/// ```
+class ConditionVariable final {
+public:
+    ConditionVariable() noexcept = default;
+
+    ///   No copying or moving
+    ConditionVariable(const ConditionVariable&) = delete;
+    ConditionVariable& operator=(const ConditionVariable&) = delete;
+
+    ///   notify_one
+    /// Wake one waiting thread, if any
+    void notify_one() noexcept;
+
+    ///   notify_all
+    /// Wake all waiting threads
+    void notify_all() noexcept;
+
+    ///   wait
+    /// Release the lock and wait for a notification, then reacquire it
+    void wait(std::unique_lock<Mutex>& lock);
+
+    ///   wait
+    /// Wait until pred returns true
+    template <class Predicate>
+    void wait(std::unique_lock<Mutex>& lock, Predicate pred);
+
+    ///   wait_for
+    /// As `wait`, giving up after the given duration
+    ///
+    /// Returns `std::cv_status::timeout` if it gave up
+    template <class Rep, class Period>
+    std::cv_status wait_for(std::unique_lock<Mutex>& lock,
+                            const std::chrono::duration<Rep, Period>& duration);
+
+    ///   wait_for
+    /// Wait until pred returns true, giving up after the given duration
+    ///
+    /// Returns the last result of pred
+    template <class Rep, class Period, class Predicate>
+    bool wait_for(std::unique_lock<Mutex>& lock,
+                  const std::chrono::duration<Rep, Period>& duration, Predicate pred);
+
+private:
+    // Returns false on timeout
+    bool _wait(std::unique_lock<Mutex>& lock, DWORD ms);
+
+    CONDITION_VARIABLE _cv = CONDITION_VARIABLE_INIT;
+};
+
+// =====================================================================
+// Mutex >> Implementations
+// =====================================================================
+#ifdef SIMPLY_PROFILE_LOCKS
+inline void Mutex::_begin_hold(_LockSite* site) noexcept {
+    _site  = site;
+    _since = site ? _lock_now() : 0;
+}
+
+inline void Mutex::_end_hold() noexcept {
+    if ( _site ) {
+        _lock_record_hold(_site, _lock_now() - _since);
+        _site = nullptr;
+    }
+}
+
+inline void Mutex::lock() noexcept {
+    _begin_hold(_profiled_acquire('x', this,
+        [this](){ return TryAcquireSRWLockExclusive(&_lock) != 0; },
+        [this](){ AcquireSRWLockExclusive(&_lock); }
+    ));
+}
+
+inline bool Mutex::try_lock() noexcept {
+    if ( !TryAcquireSRWLockExclusive(&_lock) )
+        return false;
+    _LockSite* site = _lock_sampled() ? _lock_site('x') : nullptr;
+    _lock_record_wait(site, false, 0);
+    _begin_hold(site);
+    return true;
+}
+
+inline void Mutex::unlock() noexcept {
+    _end_hold();
+    ReleaseSRWLockExclusive(&_lock);
+}
+#else
+inline void Mutex::lock() noexcept {
+    _acquire(this,
+        [this](){ return TryAcquireSRWLockExclusive(&_lock) != 0; },
+        [this](){ AcquireSRWLockExclusive(&_lock); }
+    );
+}
+
+inline bool Mutex::try_lock() noexcept {
+    return TryAcquireSRWLockExclusive(&_lock) != 0;
+}
+
+inline void Mutex::unlock() noexcept {
+    ReleaseSRWLockExclusive(&_lock);
+}
+#endif
+
+// =====================================================================
+// SharedMutex >> Implementations
+// =====================================================================
+#ifdef SIMPLY_PROFILE_LOCKS
+inline void SharedMutex::lock() noexcept {
+    _site = _profiled_acquire('x', this,
+        [this](){ return TryAcquireSRWLockExclusive(&_lock) != 0; },
+        [this](){ AcquireSRWLockExclusive(&_lock); }
+    );
+    _since = _site ? _lock_now() : 0;
+}
+
+inline bool SharedMutex::try_lock() noexcept {
+    if ( !TryAcquireSRWLockExclusive(&_lock) )
+        return false;
+    _site = _lock_sampled() ? _lock_site('x') : nullptr;
+    _lock_record_wait(_site, false, 0);
+    _since = _site ? _lock_now() : 0;
+    return true;
+}
+
+inline void SharedMutex::unlock() noexcept {
+    if ( _site ) {
+        _lock_record_hold(_site, _lock_now() - _since);
+        _site = nullptr;
+    }
+    ReleaseSRWLockExclusive(&_lock);
+}
+
+inline void SharedMutex::lock_shared() noexcept {
+    _profiled_acquire('s', this,
+        [this](){ return TryAcquireSRWLockShared(&_lock) != 0; },
+        [this](){ AcquireSRWLockShared(&_lock); }
+    );
+}
+
+inline bool SharedMutex::try_lock_shared() noexcept {
+    if ( !TryAcquireSRWLockShared(&_lock) )
+        return false;
+    if ( _lock_sampled() )
+        _lock_record_wait(_lock_site('s'), false, 0);
+    return true;
+}
+#else
+inline void SharedMutex::lock() noexcept {
+    _acquire(this,
+        [this](){ return TryAcquireSRWLockExclusive(&_lock) != 0; },
+        [this](){ AcquireSRWLockExclusive(&_lock); }
+    );
+}
+
+inline bool SharedMutex::try_lock() noexcept {
+    return TryAcquireSRWLockExclusive(&_lock) != 0;
+}
+
+inline void SharedMutex::unlock() noexcept {
+    ReleaseSRWLockExclusive(&_lock);
+}
+
+inline void SharedMutex::lock_shared() noexcept {
+    _acquire(this,
+        [this](){ return TryAcquireSRWLockShared(&_lock) != 0; },
+        [this](){ AcquireSRWLockShared(&_lock); }
+    );
+}
+
+inline bool SharedMutex::try_lock_shared() noexcept {
+    return TryAcquireSRWLockShared(&_lock) != 0;
+}
+#endif
+
+inline void SharedMutex::unlock_shared() noexcept {
+    ReleaseSRWLockShared(&_lock);
+}
+
+// =====================================================================
+// ConditionVariable >> Implementations
+// =====================================================================
+inline void ConditionVariable::notify_one() noexcept {
+    WakeConditionVariable(&_cv);
+}
+
+inline void ConditionVariable::notify_all() noexcept {
+    WakeAllConditionVariable(&_cv);
+}
+
+inline bool ConditionVariable::_wait(std::unique_lock<Mutex>& lock, DWORD ms) {
+    if ( !lock.owns_lock() )
+        throw std::system_error(
+            std::make_error_code(std::errc::operation_not_permitted),
+            "ConditionVariable::wait: lock not held"
+        );
+    Mutex& mutex = *lock.mutex();
+
+#ifdef SIMPLY_PROFILE_LOCKS
+    _LockSite* site = _lock_sampled() ? _lock_site('c') : nullptr;
+    _LockSite* held = mutex._site; // Where the mutex was locked, which holds it again after
+    mutex._end_hold();
+    const int64_t start = site ? _lock_now() : 0;
+#endif
+
+    const bool woken = SleepConditionVariableSRW(&_cv, &mutex._lock, ms, 0) != 0;
+    const DWORD err  = woken ? 0 : GetLastError();
+
+#ifdef SIMPLY_PROFILE_LOCKS
+    if ( site )
+        _lock_record_wait(site, true, _lock_now() - start);
+    mutex._begin_hold(held);
+#endif
+
+    if ( !woken && err != ERROR_TIMEOUT )
+        throw std::system_error(err, std::system_category());
+    return woken;
+}
+
+inline void ConditionVariable::wait(std::unique_lock<Mutex>& lock) {
+    _wait(lock, INFINITE);
+}
+
+template <class Predicate>
+void ConditionVariable::wait(std::unique_lock<Mutex>& lock, Predicate pred) {
+    while ( !pred() )
+        _wait(lock, INFINITE);
+}
+
+template <class Rep, class Period>
+std::cv_status ConditionVariable::wait_for(std::unique_lock<Mutex>& lock,
+                                           const std::chrono::duration<Rep, Period>& duration) {
+    // Round up, so that waiting never ends early
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(duration).count();
+    ms = std::clamp<decltype(ms)>(ms, 0, MAXDWORD - 1);
+    return _wait(lock, static_cast<DWORD>(ms)) ? std::cv_status::no_timeout : std::cv_status::timeout;
+}
+
+template <class Rep, class Period, class Predicate>
+bool ConditionVariable::wait_for(std::unique_lock<Mutex>& lock,
+                                 const std::chrono::duration<Rep, Period>& duration, Predicate pred) {
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while ( !pred() ) {
+        const auto remaining = deadline - std::chrono::steady_clock::now();
+        if ( remaining <= remaining.zero() )
+            return pred();
+        wait_for(lock, remaining);
+    }
+    return true;
+}
+
+// =====================================================================
+// lock_profile >> Implementations
+// =====================================================================
+#ifdef SIMPLY_PROFILE_LOCKS
+inline std::vector<lock_profile::Site> lock_profile::sites() {
+    std::vector<Site> found;
+    for ( const _LockSite& site: _lock_sites ) {
+        if ( !site.ready.load(std::memory_order_acquire) )
+            continue;
+        found.push_back({
+            site.kind,
+            site.acquisitions.load(std::memory_order_relaxed),
+            site.contended.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds(site.total_wait.load(std::memory_order_relaxed)),
+            std::chrono::nanoseconds(site.max_wait.load(std::memory_order_relaxed)),
+            std::chrono::nanoseconds(site.total_hold.load(std::memory_order_relaxed)),
+            std::chrono::nanoseconds(site.max_hold.load(std::memory_order_relaxed)),
+            std::vector<void*>(site.stack, site.stack + site.depth)
+        });
+    }
+    std::sort(found.begin(), found.end(), [](const Site& a, const Site& b){
+        return a.total_wait > b.total_wait;
+    });
+    return found;
+}
+
+inline void lock_profile::reset() noexcept {
+    for ( _LockSite& site: _lock_sites ) {
+        site.acquisitions.store(0, std::memory_order_relaxed);
+        site.contended.store(0, std::memory_order_relaxed);
+        site.total_wait.store(0, std::memory_order_relaxed);
+        site.max_wait.store(0, std::memory_order_relaxed);
+        site.total_hold.store(0, std::memory_order_relaxed);
+        site.max_hold.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline void lock_profile::set_fraction(uint32_t fraction) noexcept {
+    _lock_fraction.store(fraction, std::memory_order_relaxed);
+}
+#else
+inline std::vector<lock_profile::Site> lock_profile::sites() {
+    return {};
+}
+
+inline void lock_profile::reset() noexcept {}
+
+inline void lock_profile::set_fraction(uint32_t) noexcept {}
+#endif
+
+// Writes an address as module+offset, which symbolizes without the
+// module's load address
+inline void _write_address(std::ostream& ost, void* address) {
+    HMODULE module = nullptr;
+    char path[MAX_PATH];
+    if ( GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            static_cast<LPCSTR>(address), &module)
+         && GetModuleFileNameA(module, path, MAX_PATH) ) {
+        const char* name = path;
+        for ( const char* c = path; *c; c++ )
+            if ( *c == '\\' || *c == '/' )
+                name = c + 1;
+        ost << name << "+0x" << std::hex
+            << (reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(module)) << std::dec;
+    }
+    else
+        ost << address;
+}
+
+inline void lock_profile::dump(std::ostream& ost) {
+    if ( !enabled ) {
+        ost << "Lock profiling not compiled in, define SIMPLY_PROFILE_LOCKS\n";
+        return;
+    }
+
+    auto us = [](std::chrono::nanoseconds ns){ return ns.count() / 1e3; };
+    const std::ios_base::fmtflags flags = ost.flags(); // Restored after, for the caller
+    const std::streamsize precision = ost.precision();
+
+    ost << std::right << std::setw(4) << "kind" << std::setw(14) << "acquisitions"
+        << std::setw(12) << "contended" << std::setw(14) << "wait us" << std::setw(12) << "max wait"
+        << std::setw(14) << "hold us" << std::setw(12) << "max hold" << '\n';
+
+    for ( const Site& site: sites() ) {
+        ost << std::fixed << std::setprecision(1)
+            << std::setw(4) << site.kind << std::setw(14) << site.acquisitions
+            << std::setw(12) << site.contended
+            << std::setw(14) << us(site.total_wait) << std::setw(12) << us(site.max_wait)
+            << std::setw(14) << us(site.total_hold) << std::setw(12) << us(site.max_hold) << '\n';
+        for ( void* address: site.stack ) {
+            ost << "        ";
+            _write_address(ost, address);
+            ost << '\n';
+        }
+    }
+
+    ost.flags(flags);
+    ost.precision(precision);
+}
+}
+
+#endif // SIMPLY_MUTEX_HPP_
@@ -0,0 +1,337 @@
+/// parallel_memory.h
+/// Multi-threaded memcpy and memset for large buffers
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// A single thread copying or zeroing gigabytes uses a fraction of the
+/// machine's memory bandwidth. `parallel_memcpy` and `parallel_memset`
+/// split the buffer into one cache-line aligned segment per thread,
+/// the calling thread included. Helper threads are pinned to CPUs
+/// spread across the process' affinity mask, and each always takes the
+/// same segment - so with the same thread count, each part of a buffer
+/// is always touched from the same CPU.
+///
+/// Buffers of at least 8MB - larger than most caches, so nothing would
+/// be left of them in cache anyway - are written with non-temporal
+/// stores, which bypass the cache instead of evicting everything else
+/// (and spare the read of each line before it is written). On x64 the
+/// widest available stores are picked at runtime: AVX (32 bytes) where
+/// the CPU and OS support it, else SSE2 (16 bytes). Elsewhere, each
+/// segment is a plain `std::memcpy`/`std::memset`.
+///
+///   Thread count
+/// Bandwidth stops growing well before every CPU is copying - more
+/// threads only contend for the same memory channels. By default up to
+/// 4 threads are used. `calibrate_parallel_memory` instead measures
+/// copy bandwidth at 1, 2, 4, ... threads, and from then on uses the
+/// fewest threads reaching 90% of the best.
+///
+///   Functions
+/// simply::parallel_memcpy
+///     Copy a large buffer using several threads.
+/// simply::parallel_memset
+///     Fill a large buffer using several threads.
+/// simply::calibrate_parallel_memory
+///     Pick the thread count from measured bandwidth.
+/// simply::parallel_memory_threads
+///     Thread count used when none is given.
+#ifndef SIMPLY_PARALLEL_MEMORY_HPP_
+#define SIMPLY_PARALLEL_MEMORY_HPP_
+
+#include "concurrency.h"
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#define SIMPLY_STREAM_STORES SIMPLY_X64
+
+namespace simply {
+// =====================================================================
+// parallel_memory >> Declarations
+// =====================================================================
+///   parallel_memcpy
+/// Copy size bytes from src to dest, which must not overlap
+///
+/// threads is the most threads to use, or 0 for `parallel_memory_threads`.
+/// Fewer are used for small sizes, at most one per MB.
+void parallel_memcpy(void* dest, const void* src, size_t size, unsigned threads = 0);
+
+///   parallel_memset
+/// Fill size bytes at dest with value (converted to unsigned char)
+///
+/// threads as for `parallel_memcpy`.
+void parallel_memset(void* dest, int value, size_t size, unsigned threads = 0);
+
+///   calibrate_parallel_memory
+/// Measure copy bandwidth per thread count, and use the fewest threads
+/// reaching 90% of the best from now on
+///
+/// Copies between two buffers of the given size (at least 8MB, for
+/// non-temporal stores), a few times per thread count. Returns the
+/// thread count picked.
+unsigned calibrate_parallel_memory(size_t bytes = size_t(64) << 20);
+
+///   parallel_memory_threads
+/// Threads used when none are given - calibrated, or else up to 4
+SIMPLY_NODISCARD unsigned parallel_memory_threads() noexcept;
+
+// =====================================================================
+// parallel_memory >> Helpers
+// =====================================================================
+constexpr size_t _stream_bytes     = size_t(8) << 20;  // Non-temporal stores from here
+constexpr size_t _per_thread_bytes = size_t(1) << 20;  // Least worth a thread
+constexpr unsigned _default_memory_threads = 4;
+
+inline std::atomic<unsigned> _memory_threads{0};       // 0 until calibrated
+
+#if SIMPLY_STREAM_STORES
+// Bytes until dest is aligned to alignment, at most size
+inline size_t _align_head(const char* dest, size_t size, size_t alignment) noexcept {
+    const size_t misaligned = reinterpret_cast<uintptr_t>(dest) & (alignment - 1);
+    return std::min(size, misaligned ? alignment - misaligned : 0);
+}
+
+inline void _stream_copy_sse2(char* dest, const char* src, size_t size) noexcept {
+    const size_t head = _align_head(dest, size, 16);
+    std::memcpy(dest, src, head);
+    dest += head; src += head; size -= head;
+
+    for ( ; size >= 64; dest += 64, src += 64, size -= 64 ) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest + 48), d);
+    }
+    _mm_sfence(); // Non-temporal stores are weakly ordered
+    std::memcpy(dest, src, size);
+}
+
+SIMPLY_TARGET_AVX inline void _stream_copy_avx(char* dest, const char* src, size_t size) noexcept {
+    const size_t head = _align_head(dest, size, 32);
+    std::memcpy(dest, src, head);
+    dest += head; src += head; size -= head;
+
+    for ( ; size >= 128; dest += 128, src += 128, size -= 128 ) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + 96), d);
+    }
+    _mm_sfence();
+    _mm256_zeroupper();
+    std::memcpy(dest, src, size);
+}
+
+inline void _stream_fill_sse2(char* dest, int value, size_t size) noexcept {
+    const size_t head = _align_head(dest, size, 16);
+    std::memset(dest, value, head);
+    dest += head; size -= head;
+
+    const __m128i fill = _mm_set1_epi8(static_cast<char>(value));
+    for ( ; size >= 64; dest += 64, size -= 64 ) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest), fill);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest + 16), fill);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest + 32), fill);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest + 48), fill);
+    }
+    _mm_sfence();
+    std::memset(dest, value, size);
+}
+
+SIMPLY_TARGET_AVX inline void _stream_fill_avx(char* dest, int value, size_t size) noexcept {
+    const size_t head = _align_head(dest, size, 32);
+    std::memset(dest, value, head);
+    dest += head; size -= head;
+
+    const __m256i fill = _mm256_set1_epi8(static_cast<char>(value));
+    for ( ; size >= 128; dest += 128, size -= 128 ) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest), fill);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + 32), fill);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + 64), fill);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest + 96), fill);
+    }
+    _mm_sfence();
+    _mm256_zeroupper();
+    std::memset(dest, value, size);
+}
+#endif
+
+// Copies and fills for a segment, non-temporal if stream
+struct _MemoryKernels {
+    void (*copy)(char*, const char*, size_t) noexcept;
+    void (*fill)(char*, int, size_t) noexcept;
+};
+
+inline void _plain_copy(char* dest, const char* src, size_t size) noexcept { std::memcpy(dest, src, size); }
+inline void _plain_fill(char* dest, int value, size_t size) noexcept { std::memset(dest, value, size); }
+
+inline _MemoryKernels _pick_stream_kernels() noexcept {
+#if SIMPLY_STREAM_STORES
+    // Detected here, as _cpu_features may not be initialised yet
+    if ( _detect_cpu_features().avx )
+        return {&_stream_copy_avx, &_stream_fill_avx};
+    return {&_stream_copy_sse2, &_stream_fill_sse2};
+#else
+    return {&_plain_copy, &_plain_fill};
+#endif
+}
+
+// Picked on first use, so usable during static initialisation
+inline const _MemoryKernels& _stream_kernels() noexcept {
+    static const _MemoryKernels kernels = _pick_stream_kernels();
+    return kernels;
+}
+
+inline const _MemoryKernels _plain_kernels  = {&_plain_copy, &_plain_fill};
+
+// Affinity masks of n CPUs, spread evenly across the process' affinity
+inline std::vector<uint64_t> _spread_cpus(size_t n) {
+    DWORD_PTR process_mask, system_mask;
+    std::vector<uint64_t> masks;
+    if ( !GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) )
+        return masks;
+
+    std::vector<uint64_t> cpus;
+    for ( unsigned cpu = 0; cpu < 64; cpu++ )
+        if ( uint64_t(process_mask) & (uint64_t(1) << cpu) )
+            cpus.push_back(uint64_t(1) << cpu);
+    if ( cpus.empty() )
+        return masks;
+
+    // Siblings of a core, and cores of a node, are numbered next to each other
+    const size_t stride = std::max<size_t>(cpus.size() / (n + 1), 1);
+    for ( size_t i = 1; i <= n; i++ )
+        masks.push_back(cpus[(i * stride) % cpus.size()]);
+    return masks;
+}
+
+// Calls segment(offset, length, kernels) over size bytes, on up to threads threads
+template <class Segment>
+void _parallel_memory(size_t size, unsigned threads, Segment&& segment) {
+    const _MemoryKernels& kernels = size >= _stream_bytes ? _stream_kernels() : _plain_kernels;
+    const size_t workers = std::min<size_t>(threads ? threads : parallel_memory_threads(),
+                                            std::max<size_t>(size / _per_thread_bytes, 1));
+    if ( workers <= 1 ) {
+        segment(0, size, kernels);
+        return;
+    }
+
+    // Whole cache lines per segment, so segments share none
+    const size_t length = (size / workers + 63) & ~size_t(63);
+    auto work = [&](size_t i){
+        const size_t offset = i * length;
+        if ( offset < size )
+            segment(offset, std::min(length, size - offset), kernels);
+    };
+
+    // Segment i + 1 on helper i, always on the same CPU
+    std::vector<Thread> helpers;
+    try {
+        const std::vector<uint64_t> cpus = _spread_cpus(workers - 1);
+        helpers.reserve(workers - 1);
+        for ( size_t i = 0; i < workers - 1; i++ ) {
+            Thread::Options opt;
+            if ( i < cpus.size() )
+                opt.affinity = cpus[i];
+            helpers.emplace_back(opt, [&work, i](){ work(i + 1); });
+        }
+    }
+    catch ( const std::system_error& ) {} // Fewer threads, the rest still runs
+    work(0);
+    for ( size_t i = helpers.size() + 1; i < workers; i++ )
+        work(i); // Of helpers which failed to start
+    for ( Thread& helper: helpers )
+        helper.join();
+}
+
+// =====================================================================
+// parallel_memory >> Implementations
+// =====================================================================
+inline void parallel_memcpy(void* dest, const void* src, size_t size, unsigned threads) {
+    char* const to = static_cast<char*>(dest);
+    const char* const from = static_cast<const char*>(src);
+    _parallel_memory(size, threads, [to, from](size_t offset, size_t length, const _MemoryKernels& kernels){
+        kernels.copy(to + offset, from + offset, length);
+    });
+}
+
+inline void parallel_memset(void* dest, int value, size_t size, unsigned threads) {
+    char* const to = static_cast<char*>(dest);
+    _parallel_memory(size, threads, [to, value](size_t offset, size_t length, const _MemoryKernels& kernels){
+        kernels.fill(to + offset, value, length);
+    });
+}
+
+inline unsigned calibrate_parallel_memory(size_t bytes) {
+    if ( bytes < _stream_bytes )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "calibrate_parallel_memory: bytes must be at least 8MB"
+        );
+
+    std::vector<char> from(bytes, 1); // Touched, so page faults are not measured
+    std::vector<char> to(bytes, 0);
+    const unsigned most = std::max(Thread::hardware_concurrency(), 1u);
+
+    // Best bandwidth (bytes per second) at 1, 2, 4, ... threads
+    std::vector<std::pair<unsigned, double>> curve;
+    for ( unsigned threads = 1; ; threads = std::min(threads * 2, most) ) {
+        auto fastest = std::chrono::steady_clock::duration::max();
+        for ( int repeat = 0; repeat < 3; repeat++ ) {
+            const auto start = std::chrono::steady_clock::now();
+            parallel_memcpy(to.data(), from.data(), bytes, threads);
+            fastest = std::min(fastest, std::chrono::steady_clock::now() - start);
+        }
+        const double seconds = std::chrono::duration<double>(fastest).count();
+        curve.emplace_back(threads, static_cast<double>(bytes) / std::max(seconds, 1e-9));
+        if ( threads == most )
+            break;
+    }
+
+    double best = 0;
+    for ( const auto& point: curve )
+        best = std::max(best, point.second);
+    unsigned picked = most;
+    for ( const auto& point: curve )
+        if ( point.second >= 0.9 * best ) {
+            picked = point.first;
+            break;
+        }
+
+    _memory_threads.store(picked, std::memory_order_relaxed);
+    return picked;
+}
+
+inline unsigned parallel_memory_threads() noexcept {
+    const unsigned calibrated = _memory_threads.load(std::memory_order_relaxed);
+    if ( calibrated )
+        return calibrated;
+    return std::min(std::max(Thread::hardware_concurrency(), 1u), _default_memory_threads);
+}
+}
+
+#endif // SIMPLY_PARALLEL_MEMORY_HPP_
@@ -0,0 +1,333 @@
+/// parallel_read.h
+/// Memory-mapped files, processed in record-aligned chunks by many threads
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Reading a multi-GB log or CSV file through a single `std::ifstream`
+/// copies every byte, and parses on one thread. `parallel_read_chunks`
+/// instead maps the file, splits it into chunks of about `chunk_size`
+/// bytes - each extended to end just after a `delimiter`, so no record
+/// is split - and has one `Thread` per CPU call f on each chunk as a
+/// `std::string_view` into the mapping. Nothing is copied.
+///
+/// Before parsing a chunk, each thread asks the system to read all of
+/// it in, in as few large reads as possible, rather than taking a page
+/// fault per page as parsing goes.
+///
+/// Results are merged either in file order (returned as a vector), or
+/// as chunks finish (passed to a callback).
+///
+/// {note: Windows} Mapped with `MapViewOfFile`, and read ahead with
+///                 `PrefetchVirtualMemory` on Windows 8 or later. The
+///                 file is opened with `FILE_FLAG_SEQUENTIAL_SCAN`.
+///
+///   Classes
+/// simply::MappedFile
+///     Read-only memory mapping of a whole file.
+///
+///   Functions
+/// simply::parallel_read_chunks
+///     Call a function on each chunk of a file, in parallel.
+#ifndef SIMPLY_PARALLEL_READ_HPP_
+#define SIMPLY_PARALLEL_READ_HPP_
+
+#include "concurrency.h"
+#include "mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace simply {
+// =====================================================================
+// MappedFile >> Declaration
+// =====================================================================
+///   MappedFile
+/// Read-only memory mapping of a whole file
+///
+///   Behaviours
+/// - Empty files
+///     Cannot be mapped, so give an empty `view`.
+/// - Changes to the file
+///     Are seen through the mapping. Truncating a mapped file fails.
+class MappedFile final {
+public:
+    ///   Constructor
+    /// Map the file at path, throws `system_error` on failure
+    explicit MappedFile(const std::string& path);
+
+    ///   Destructor
+    /// Unmap the file
+    ~MappedFile();
+
+    ///   No copying or moving
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ///   view
+    /// The whole file
+    SIMPLY_NODISCARD std::string_view view() const noexcept;
+
+    ///   prefetch
+    /// Start reading part of the file in, if not already
+    ///
+    /// Returns at once, the pages are read in the background. Does
+    /// nothing before Windows 8.
+    void prefetch(std::string_view part) const noexcept;
+
+private:
+    HANDLE _file;
+    HANDLE _mapping;
+    const char* _data;
+    size_t _size;
+};
+
+// =====================================================================
+// parallel_read_chunks >> Declaration
+// =====================================================================
+///   parallel_read_chunks
+/// Call f on each chunk of the file at path, in parallel
+///
+/// Chunks are about chunk_size bytes, each ending just after a
+/// delimiter (or at the end of the file), so a record longer than
+/// chunk_size makes a longer chunk. f is called as
+/// `f(std::string_view chunk)`, from several threads at once.
+///
+/// Returns f's results in the order of the chunks in the file, if f
+/// returns anything. Rethrows the first exception thrown by f, after
+/// all threads have stopped. Throws `system_error` if the file cannot
+/// be mapped, or chunk_size is 0.
+///
+///   Example
+/// ```
+/// // Lines per chunk, in file order
+/// std::vector<size_t> lines = simply::parallel_read_chunks("big.log", 1 << 24, '\n',
+///     [](std::string_view chunk){
+///         return static_cast<size_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+///     });
+/// ```
+template <class F>
+auto parallel_read_chunks(const std::string& path, size_t chunk_size, char delimiter, F&& f);
+
+///   parallel_read_chunks
+/// As above, passing each result to `on_result(index, result)` as soon
+/// as its chunk is done, in any order
+///
+/// Calls to on_result are never concurrent, so it may merge into shared
+/// state without locking.
+///
+///   Example
+/// ```
+/// std::map<std::string, size_t> totals;
+/// simply::parallel_read_chunks("big.csv", 1 << 24, '\n', count_by_key,
+///     [&totals](size_t, std::map<std::string, size_t>&& counts){
+///         for ( auto& [key, count]: counts )
+///             totals[key] += count;
+///     });
+/// ```
+template <class F, class OnResult>
+void parallel_read_chunks(const std::string& path, size_t chunk_size, char delimiter,
+                          F&& f, OnResult&& on_result);
+
+// =====================================================================
+// MappedFile >> Implementations
+// =====================================================================
+inline MappedFile::MappedFile(const std::string& path):
+    _file(INVALID_HANDLE_VALUE),
+    _mapping(nullptr),
+    _data(nullptr),
+    _size(0)
+{
+    _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if ( _file == INVALID_HANDLE_VALUE )
+        throw std::system_error(GetLastError(), std::system_category(), "MappedFile: " + path);
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx(_file, &size) ) {
+        const DWORD error = GetLastError();
+        CloseHandle(_file);
+        throw std::system_error(error, std::system_category(), "MappedFile: " + path);
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    if ( _size == 0 )
+        return;
+
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if ( _mapping )
+        _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+    if ( !_data ) {
+        const DWORD error = GetLastError();
+        if ( _mapping )
+            CloseHandle(_mapping);
+        CloseHandle(_file);
+        throw std::system_error(error, std::system_category(), "MappedFile: " + path);
+    }
+}
+
+inline MappedFile::~MappedFile() {
+    if ( _data )
+        UnmapViewOfFile(_data);
+    if ( _mapping )
+        CloseHandle(_mapping);
+    CloseHandle(_file);
+}
+
+inline std::string_view MappedFile::view() const noexcept {
+    return std::string_view(_data, _data ? _size : 0);
+}
+
+// As WIN32_MEMORY_RANGE_ENTRY, only declared when targeting Windows 8
+struct _MemoryRange {
+    PVOID VirtualAddress;
+    SIZE_T NumberOfBytes;
+};
+
+inline void MappedFile::prefetch(std::string_view part) const noexcept {
+    // PrefetchVirtualMemory needs Windows 8, before which pages are
+    // just faulted in as read
+    using Prefetch = BOOL (WINAPI*)(HANDLE, ULONG_PTR, _MemoryRange*, ULONG);
+    static const Prefetch prefetch_memory = reinterpret_cast<Prefetch>(
+        GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory"));
+    if ( part.empty() || !prefetch_memory )
+        return;
+    _MemoryRange range;
+    range.VirtualAddress = const_cast<char*>(part.data());
+    range.NumberOfBytes  = part.size();
+    prefetch_memory(GetCurrentProcess(), 1, &range, 0); // Only a hint
+}
+
+// =====================================================================
+// parallel_read_chunks >> Helpers
+// =====================================================================
+// Splits data into chunks of about chunk_size, each ending after a delimiter
+inline std::vector<std::string_view> _split_chunks(std::string_view data, size_t chunk_size, char delimiter) {
+    std::vector<std::string_view> chunks;
+    chunks.reserve(data.size() / chunk_size + 1);
+    size_t start = 0;
+    while ( start < data.size() ) {
+        size_t end = std::min(start + chunk_size, data.size());
+        if ( end < data.size() && data[end - 1] != delimiter ) {
+            const void* found = std::memchr(data.data() + end, delimiter, data.size() - end);
+            end = found ? static_cast<size_t>(static_cast<const char*>(found) - data.data()) + 1
+                        : data.size();
+        }
+        chunks.push_back(data.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+// Calls prepare(chunks), then process(index, chunk) for each chunk, on
+// one thread per CPU
+template <class Prepare, class Process>
+void _process_chunks(const std::string& path, size_t chunk_size, char delimiter,
+                     Prepare&& prepare, Process&& process) {
+    if ( chunk_size == 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "parallel_read_chunks: chunk_size must be at least 1"
+        );
+
+    MappedFile file(path);
+    const std::vector<std::string_view> chunks = _split_chunks(file.view(), chunk_size, delimiter);
+    prepare(chunks.size());
+    if ( chunks.empty() )
+        return;
+
+    std::atomic<size_t> next{0};
+    Mutex error_mutex;
+    std::exception_ptr error;
+
+    auto work = [&](){
+        for ( ;; ) {
+            const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if ( index >= chunks.size() )
+                return;
+            file.prefetch(chunks[index]);
+            try {
+                process(index, chunks[index]);
+            }
+            catch ( ... ) {
+                std::lock_guard<Mutex> guard(error_mutex);
+                if ( !error )
+                    error = std::current_exception();
+                next.store(chunks.size(), std::memory_order_relaxed); // Take no more
+            }
+        }
+    };
+
+    const size_t workers = std::min<size_t>(std::max(Thread::hardware_concurrency(), 1u), chunks.size());
+    std::vector<Thread> threads;
+    threads.reserve(workers - 1);
+    try {
+        for ( size_t i = 1; i < workers; i++ )
+            threads.emplace_back(work);
+    }
+    catch ( const std::system_error& ) {} // Fewer threads, the rest still runs
+    work(); // This thread as well
+    for ( Thread& thread: threads )
+        thread.join();
+
+    if ( error )
+        std::rethrow_exception(error);
+}
+
+// =====================================================================
+// parallel_read_chunks >> Implementations
+// =====================================================================
+template <class F>
+auto parallel_read_chunks(const std::string& path, size_t chunk_size, char delimiter, F&& f) {
+    using Result = std::invoke_result_t<F&, std::string_view>;
+
+    if constexpr ( std::is_void_v<Result> ) {
+        _process_chunks(path, chunk_size, delimiter, [](size_t){}, [&f](size_t, std::string_view chunk){
+            f(chunk);
+        });
+    }
+    else {
+        // Each chunk's result has its own slot, so no locking
+        std::vector<std::optional<Result>> slots;
+        _process_chunks(path, chunk_size, delimiter,
+            [&slots](size_t chunks){ slots.resize(chunks); },
+            [&f, &slots](size_t index, std::string_view chunk){ slots[index].emplace(f(chunk)); }
+        );
+        std::vector<Result> results;
+        results.reserve(slots.size());
+        for ( auto& slot: slots )
+            results.push_back(std::move(*slot));
+        return results;
+    }
+}
+
+template <class F, class OnResult>
+void parallel_read_chunks(const std::string& path, size_t chunk_size, char delimiter,
+                          F&& f, OnResult&& on_result) {
+    Mutex merge_mutex;
+    _process_chunks(path, chunk_size, delimiter, [](size_t){}, [&](size_t index, std::string_view chunk){
+        auto result = f(chunk);
+        std::lock_guard<Mutex> guard(merge_mutex);
+        on_result(index, std::move(result));
+    });
+}
+}
+
+#endif // SIMPLY_PARALLEL_READ_HPP_
@@ -0,0 +1,887 @@
+/// parallel_reduce.h
+/// Multi-threaded sum, dot product, min/max and counting over arrays,
+/// with SIMD inner loops
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// Splitting a reduction across threads only pays off fully if each
+/// thread's own loop keeps its core's vector units busy. Compilers will
+/// not vectorize a floating-point sum by themselves (that reorders the
+/// additions), so these functions run hand-written kernels instead,
+/// picked at runtime for the widest instructions the CPU and OS support:
+/// AVX-512, AVX2 or SSE2. Each kernel keeps several independent
+/// accumulators, so it is limited by throughput rather than latency.
+///
+/// The array is split into fixed blocks of 256KB, taken in turn by one
+/// `Thread` per CPU (the caller included). Block results are combined
+/// in order, so the result does not depend on the thread count.
+///
+///   Element types
+/// Any arithmetic type except `bool`. `float`, `double` and `int32_t`
+/// have SIMD kernels, other types use the portable kernel. Integer
+/// sums and dot products wrap around on overflow, in the element type.
+///
+///   Reproducibility
+/// SIMD kernels add floating-point values in a different order to each
+/// other, so sums and dot products may differ in the last bits between
+/// CPUs. With `ReduceOptions::reproducible`, every CPU instead runs the
+/// portable kernel, which adds in one fixed order - the same bits for
+/// the same input, whatever the thread count, `Simd` or CPU. Counting
+/// is always exact, and so unaffected.
+///
+///   Classes
+/// simply::Simd
+///     Instruction sets for the kernels.
+/// simply::ReduceOptions
+///     Threads, kernels and reproducibility for one call.
+/// simply::Compare
+///     Comparisons for `parallel_count_if`.
+///
+///   Functions
+/// simply::parallel_sum
+///     Sum of an array.
+/// simply::parallel_dot
+///     Dot product of two arrays.
+/// simply::parallel_min, simply::parallel_max, simply::parallel_minmax
+///     Smallest and/or largest element of an array.
+/// simply::parallel_count_if
+///     Number of elements comparing true against a value.
+/// simply::supported_simd
+///     Widest kernels this CPU can run.
+#ifndef SIMPLY_PARALLEL_REDUCE_HPP_
+#define SIMPLY_PARALLEL_REDUCE_HPP_
+
+#include "concurrency.h"
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define SIMPLY_SIMD_KERNELS SIMPLY_X64
+
+namespace simply {
+// =====================================================================
+// parallel_reduce >> Declarations
+// =====================================================================
+///   Simd
+/// Instruction sets for the kernels, widest first
+///
+/// A `ReduceOptions::simd` is the widest to use - kernels this CPU
+/// cannot run are never used, so `AVX512` on an AVX2 machine gives AVX2.
+enum class Simd {
+    BEST,    // Widest the CPU supports
+    AVX512,  // 64-byte vectors, AVX-512F
+    AVX2,    // 32-byte vectors
+    SSE2,    // 16-byte vectors, on every x64 CPU
+    SCALAR   // Portable kernel only
+};
+
+///   ReduceOptions
+/// Settings for one reduction
+struct ReduceOptions {
+    ///   threads
+    /// Most threads to use, the caller included, or 0 for one per CPU
+    unsigned threads = 0;
+
+    ///   simd
+    /// Widest kernels to use
+    Simd simd = Simd::BEST;
+
+    ///   reproducible
+    /// Give the same bits whatever the threads, simd and CPU, using the
+    /// portable kernel for sums, dot products, min and max
+    bool reproducible = false;
+};
+
+///   Compare
+/// How `parallel_count_if` compares each element against its value
+///
+/// As the operators, so NaN elements only count for `NOT_EQUAL`.
+enum class Compare {
+    EQUAL,          // element == value
+    NOT_EQUAL,      // element != value
+    LESS,           // element <  value
+    LESS_EQUAL,     // element <= value
+    GREATER,        // element >  value
+    GREATER_EQUAL   // element >= value
+};
+
+///   parallel_sum
+/// Sum of size elements at data, 0 if size is 0
+///
+///   Example
+/// ```
+/// std::vector<float> samples = load();
+/// float total = simply::parallel_sum(samples.data(), samples.size());
+/// ```
+template <class T>
+SIMPLY_NODISCARD T parallel_sum(const T* data, size_t size, const ReduceOptions& options = {});
+
+///   parallel_dot
+/// Sum of a[i] * b[i] over size elements, 0 if size is 0
+///
+/// Multiplies and adds separately (no fused multiply-add), so that
+/// reproducible results match the portable kernel exactly.
+template <class T>
+SIMPLY_NODISCARD T parallel_dot(const T* a, const T* b, size_t size, const ReduceOptions& options = {});
+
+///   parallel_min
+/// Smallest of size elements at data
+///
+/// Throws `system_error` if size is 0. The result is unspecified if
+/// there are NaNs, and may be either zero if both -0.0 and 0.0 are
+/// smallest (unless reproducible).
+template <class T>
+SIMPLY_NODISCARD T parallel_min(const T* data, size_t size, const ReduceOptions& options = {});
+
+///   parallel_max
+/// Largest of size elements at data, as `parallel_min`
+template <class T>
+SIMPLY_NODISCARD T parallel_max(const T* data, size_t size, const ReduceOptions& options = {});
+
+///   parallel_minmax
+/// Smallest and largest of size elements at data, in one pass, as
+/// `parallel_min`
+template <class T>
+SIMPLY_NODISCARD std::pair<T, T> parallel_minmax(const T* data, size_t size, const ReduceOptions& options = {});
+
+template <class T>
+struct _Identity { using type = T; };
+
+///   parallel_count_if
+/// Number of the size elements at data for which `element op value`
+///
+///   Example
+/// ```
+/// // Readings above the limit
+/// size_t over = simply::parallel_count_if(readings.data(), readings.size(),
+///                                         simply::Compare::GREATER, 0.75f);
+/// ```
+template <class T>
+SIMPLY_NODISCARD size_t parallel_count_if(const T* data, size_t size, Compare op,
+                                          typename _Identity<T>::type value,
+                                          const ReduceOptions& options = {});
+
+///   supported_simd
+/// Widest kernels this CPU and OS support, `SCALAR` if not x64
+SIMPLY_NODISCARD Simd supported_simd() noexcept;
+
+// =====================================================================
+// parallel_reduce >> Portable kernels
+// =====================================================================
+constexpr size_t _reduce_block_bytes = size_t(256) << 10; // Split into blocks of this size
+
+// Integers are summed as unsigned, so overflow wraps around
+template <class T>
+using _Acc = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, _Identity<T>>::type;
+
+template <class T>
+constexpr bool _has_simd_kernels = std::is_same_v<T, float> || std::is_same_v<T, double>
+                                || std::is_same_v<T, int32_t>;
+
+template <Compare Op, class T>
+constexpr bool _compare(T element, T value) noexcept {
+    if constexpr ( Op == Compare::EQUAL )          return element == value;
+    else if constexpr ( Op == Compare::NOT_EQUAL ) return element != value;
+    else if constexpr ( Op == Compare::LESS )      return element <  value;
+    else if constexpr ( Op == Compare::LESS_EQUAL ) return element <= value;
+    else if constexpr ( Op == Compare::GREATER )   return element >  value;
+    else                                           return element >= value;
+}
+
+// The fixed order of reproducible results: 8 interleaved accumulators,
+// added pairwise, then the remaining elements one by one
+template <class T>
+_Acc<T> _fold_lanes(const _Acc<T> (&lanes)[8]) noexcept {
+    return _Acc<T>(_Acc<T>(_Acc<T>(lanes[0] + lanes[4]) + _Acc<T>(lanes[2] + lanes[6]))
+                 + _Acc<T>(_Acc<T>(lanes[1] + lanes[5]) + _Acc<T>(lanes[3] + lanes[7])));
+}
+
+template <class T>
+_Acc<T> _sum_scalar(const T* data, size_t size) noexcept {
+    _Acc<T> lanes[8] = {};
+    size_t i = 0;
+    for ( ; i + 8 <= size; i += 8 )
+        for ( size_t k = 0; k < 8; k++ )
+            lanes[k] = _Acc<T>(lanes[k] + _Acc<T>(data[i + k]));
+    _Acc<T> total = _fold_lanes<T>(lanes);
+    for ( ; i < size; i++ )
+        total = _Acc<T>(total + _Acc<T>(data[i]));
+    return total;
+}
+
+template <class T>
+_Acc<T> _dot_scalar(const T* a, const T* b, size_t size) noexcept {
+    _Acc<T> lanes[8] = {};
+    size_t i = 0;
+    for ( ; i + 8 <= size; i += 8 )
+        for ( size_t k = 0; k < 8; k++ )
+            lanes[k] = _Acc<T>(lanes[k] + _Acc<T>(_Acc<T>(a[i + k]) * _Acc<T>(b[i + k])));
+    _Acc<T> total = _fold_lanes<T>(lanes);
+    for ( ; i < size; i++ )
+        total = _Acc<T>(total + _Acc<T>(_Acc<T>(a[i]) * _Acc<T>(b[i])));
+    return total;
+}
+
+// Widens lo and hi to cover size elements at data
+template <class T>
+void _minmax_scalar(const T* data, size_t size, T& lo, T& hi) noexcept {
+    for ( size_t i = 0; i < size; i++ ) {
+        lo = std::min(lo, data[i]);
+        hi = std::max(hi, data[i]);
+    }
+}
+
+template <Compare Op, class T>
+size_t _count_scalar(const T* data, size_t size, T value) noexcept {
+    size_t count = 0;
+    for ( size_t i = 0; i < size; i++ )
+        count += _compare<Op>(data[i], value);
+    return count;
+}
+
+#if SIMPLY_SIMD_KERNELS
+// =====================================================================
+// parallel_reduce >> SIMD kernels
+// =====================================================================
+// Each instruction set has a traits struct per element type, with:
+//   Vec, width                  a vector of width elements
+//   zero, set1, load, store     unaligned loads and stores
+//   add, mul, min, max          per element, wrapping for integers
+//   Mask, cmp<Op>               per element comparison
+//   Counts, count, total        per lane counts of true comparisons
+// and kernels generic over the element type, on the traits.
+template <Compare Op>
+constexpr int _cmp_predicate = Op == Compare::EQUAL      ? _CMP_EQ_OQ
+                             : Op == Compare::NOT_EQUAL  ? _CMP_NEQ_UQ
+                             : Op == Compare::LESS       ? _CMP_LT_OQ
+                             : Op == Compare::LESS_EQUAL ? _CMP_LE_OQ
+                             : Op == Compare::GREATER    ? _CMP_GT_OQ
+                                                         : _CMP_GE_OQ;
+
+// Sum of n lanes, stored as Lane
+template <class Lane, size_t n>
+size_t _lane_total(const Lane (&lanes)[n]) noexcept {
+    size_t total = 0;
+    for ( Lane lane: lanes )
+        total += static_cast<size_t>(lane);
+    return total;
+}
+
+// ===== SIMD kernels >> SSE2 =====
+template <class T>
+struct _Sse2;
+
+template <>
+struct _Sse2<float> {
+    using Vec = __m128;
+    using Mask = __m128;
+    using Counts = __m128i;
+    static constexpr size_t width = 4;
+    static Vec zero() noexcept { return _mm_setzero_ps(); }
+    static Vec set1(float value) noexcept { return _mm_set1_ps(value); }
+    static Vec load(const float* data) noexcept { return _mm_loadu_ps(data); }
+    static void store(float* data, Vec v) noexcept { _mm_storeu_ps(data, v); }
+    static Vec add(Vec a, Vec b) noexcept { return _mm_add_ps(a, b); }
+    static Vec mul(Vec a, Vec b) noexcept { return _mm_mul_ps(a, b); }
+    static Vec min(Vec a, Vec b) noexcept { return _mm_min_ps(a, b); }
+    static Vec max(Vec a, Vec b) noexcept { return _mm_max_ps(a, b); }
+    template <Compare Op>
+    static Mask cmp(Vec a, Vec b) noexcept {
+        if constexpr ( Op == Compare::EQUAL )          return _mm_cmpeq_ps(a, b);
+        else if constexpr ( Op == Compare::NOT_EQUAL ) return _mm_cmpneq_ps(a, b);
+        else if constexpr ( Op == Compare::LESS )      return _mm_cmplt_ps(a, b);
+        else if constexpr ( Op == Compare::LESS_EQUAL ) return _mm_cmple_ps(a, b);
+        else if constexpr ( Op == Compare::GREATER )   return _mm_cmpgt_ps(a, b);
+        else                                           return _mm_cmpge_ps(a, b);
+    }
+    static Counts no_counts() noexcept { return _mm_setzero_si128(); }
+    static Counts count(Counts counts, Mask mask) noexcept { return _mm_sub_epi32(counts, _mm_castps_si128(mask)); }
+    static size_t total(Counts counts) noexcept {
+        uint32_t lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        return _lane_total(lanes);
+    }
+};
+
+template <>
+struct _Sse2<double> {
+    using Vec = __m128d;
+    using Mask = __m128d;
+    using Counts = __m128i;
+    static constexpr size_t width = 2;
+    static Vec zero() noexcept { return _mm_setzero_pd(); }
+    static Vec set1(double value) noexcept { return _mm_set1_pd(value); }
+    static Vec load(const double* data) noexcept { return _mm_loadu_pd(data); }
+    static void store(double* data, Vec v) noexcept { _mm_storeu_pd(data, v); }
+    static Vec add(Vec a, Vec b) noexcept { return _mm_add_pd(a, b); }
+    static Vec mul(Vec a, Vec b) noexcept { return _mm_mul_pd(a, b); }
+    static Vec min(Vec a, Vec b) noexcept { return _mm_min_pd(a, b); }
+    static Vec max(Vec a, Vec b) noexcept { return _mm_max_pd(a, b); }
+    template <Compare Op>
+    static Mask cmp(Vec a, Vec b) noexcept {
+        if constexpr ( Op == Compare::EQUAL )          return _mm_cmpeq_pd(a, b);
+        else if constexpr ( Op == Compare::NOT_EQUAL ) return _mm_cmpneq_pd(a, b);
+        else if constexpr ( Op == Compare::LESS )      return _mm_cmplt_pd(a, b);
+        else if constexpr ( Op == Compare::LESS_EQUAL ) return _mm_cmple_pd(a, b);
+        else if constexpr ( Op == Compare::GREATER )   return _mm_cmpgt_pd(a, b);
+        else                                           return _mm_cmpge_pd(a, b);
+    }
+    static Counts no_counts() noexcept { return _mm_setzero_si128(); }
+    static Counts count(Counts counts, Mask mask) noexcept { return _mm_sub_epi64(counts, _mm_castpd_si128(mask)); }
+    static size_t total(Counts counts) noexcept {
+        uint64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        return _lane_total(lanes);
+    }
+};
+
+template <>
+struct _Sse2<int32_t> {
+    using Vec = __m128i;
+    using Mask = __m128i;
+    using Counts = __m128i;
+    static constexpr size_t width = 4;
+    static Vec zero() noexcept { return _mm_setzero_si128(); }
+    static Vec set1(int32_t value) noexcept { return _mm_set1_epi32(value); }
+    static Vec load(const int32_t* data) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); }
+    static void store(int32_t* data, Vec v) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(data), v); }
+    static Vec add(Vec a, Vec b) noexcept { return _mm_add_epi32(a, b); }
+    static Vec mul(Vec a, Vec b) noexcept {
+        // No 32-bit multiply before SSE4.1 - multiply even and odd lanes to 64 bits
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    static Vec min(Vec a, Vec b) noexcept {
+        const __m128i greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+    }
+    static Vec max(Vec a, Vec b) noexcept {
+        const __m128i greater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+    }
+    template <Compare Op>
+    static Mask cmp(Vec a, Vec b) noexcept {
+        const __m128i all = _mm_set1_epi32(-1);
+        if constexpr ( Op == Compare::EQUAL )          return _mm_cmpeq_epi32(a, b);
+        else if constexpr ( Op == Compare::NOT_EQUAL ) return _mm_xor_si128(_mm_cmpeq_epi32(a, b), all);
+        else if constexpr ( Op == Compare::LESS )      return _mm_cmplt_epi32(a, b);
+        else if constexpr ( Op == Compare::LESS_EQUAL ) return _mm_xor_si128(_mm_cmpgt_epi32(a, b), all);
+        else if constexpr ( Op == Compare::GREATER )   return _mm_cmpgt_epi32(a, b);
+        else                                           return _mm_xor_si128(_mm_cmplt_epi32(a, b), all);
+    }
+    static Counts no_counts() noexcept { return _mm_setzero_si128(); }
+    static Counts count(Counts counts, Mask mask) noexcept { return _mm_sub_epi32(counts, mask); }
+    static size_t total(Counts counts) noexcept {
+        uint32_t lanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        return _lane_total(lanes);
+    }
+};
+
+// ===== SIMD kernels >> AVX2 =====
+template <class T>
+struct _Avx2;
+
+template <>
+struct _Avx2<float> {
+    using Vec = __m256;
+    using Mask = __m256;
+    using Counts = __m256i;
+    static constexpr size_t width = 8;
+    SIMPLY_TARGET_AVX2 static Vec zero() noexcept { return _mm256_setzero_ps(); }
+    SIMPLY_TARGET_AVX2 static Vec set1(float value) noexcept { return _mm256_set1_ps(value); }
+    SIMPLY_TARGET_AVX2 static Vec load(const float* data) noexcept { return _mm256_loadu_ps(data); }
+    SIMPLY_TARGET_AVX2 static void store(float* data, Vec v) noexcept { _mm256_storeu_ps(data, v); }
+    SIMPLY_TARGET_AVX2 static Vec add(Vec a, Vec b) noexcept { return _mm256_add_ps(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec mul(Vec a, Vec b) noexcept { return _mm256_mul_ps(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec min(Vec a, Vec b) noexcept { return _mm256_min_ps(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec max(Vec a, Vec b) noexcept { return _mm256_max_ps(a, b); }
+    template <Compare Op>
+    SIMPLY_TARGET_AVX2 static Mask cmp(Vec a, Vec b) noexcept { return _mm256_cmp_ps(a, b, _cmp_predicate<Op>); }
+    SIMPLY_TARGET_AVX2 static Counts no_counts() noexcept { return _mm256_setzero_si256(); }
+    SIMPLY_TARGET_AVX2 static Counts count(Counts counts, Mask mask) noexcept {
+        return _mm256_sub_epi32(counts, _mm256_castps_si256(mask));
+    }
+    SIMPLY_TARGET_AVX2 static size_t total(Counts counts) noexcept {
+        uint32_t lanes[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), counts);
+        return _lane_total(lanes);
+    }
+};
+
+template <>
+struct _Avx2<double> {
+    using Vec = __m256d;
+    using Mask = __m256d;
+    using Counts = __m256i;
+    static constexpr size_t width = 4;
+    SIMPLY_TARGET_AVX2 static Vec zero() noexcept { return _mm256_setzero_pd(); }
+    SIMPLY_TARGET_AVX2 static Vec set1(double value) noexcept { return _mm256_set1_pd(value); }
+    SIMPLY_TARGET_AVX2 static Vec load(const double* data) noexcept { return _mm256_loadu_pd(data); }
+    SIMPLY_TARGET_AVX2 static void store(double* data, Vec v) noexcept { _mm256_storeu_pd(data, v); }
+    SIMPLY_TARGET_AVX2 static Vec add(Vec a, Vec b) noexcept { return _mm256_add_pd(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec mul(Vec a, Vec b) noexcept { return _mm256_mul_pd(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec min(Vec a, Vec b) noexcept { return _mm256_min_pd(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec max(Vec a, Vec b) noexcept { return _mm256_max_pd(a, b); }
+    template <Compare Op>
+    SIMPLY_TARGET_AVX2 static Mask cmp(Vec a, Vec b) noexcept { return _mm256_cmp_pd(a, b, _cmp_predicate<Op>); }
+    SIMPLY_TARGET_AVX2 static Counts no_counts() noexcept { return _mm256_setzero_si256(); }
+    SIMPLY_TARGET_AVX2 static Counts count(Counts counts, Mask mask) noexcept {
+        return _mm256_sub_epi64(counts, _mm256_castpd_si256(mask));
+    }
+    SIMPLY_TARGET_AVX2 static size_t total(Counts counts) noexcept {
+        uint64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), counts);
+        return _lane_total(lanes);
+    }
+};
+
+template <>
+struct _Avx2<int32_t> {
+    using Vec = __m256i;
+    using Mask = __m256i;
+    using Counts = __m256i;
+    static constexpr size_t width = 8;
+    SIMPLY_TARGET_AVX2 static Vec zero() noexcept { return _mm256_setzero_si256(); }
+    SIMPLY_TARGET_AVX2 static Vec set1(int32_t value) noexcept { return _mm256_set1_epi32(value); }
+    SIMPLY_TARGET_AVX2 static Vec load(const int32_t* data) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    }
+    SIMPLY_TARGET_AVX2 static void store(int32_t* data, Vec v) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data), v);
+    }
+    SIMPLY_TARGET_AVX2 static Vec add(Vec a, Vec b) noexcept { return _mm256_add_epi32(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec mul(Vec a, Vec b) noexcept { return _mm256_mullo_epi32(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec min(Vec a, Vec b) noexcept { return _mm256_min_epi32(a, b); }
+    SIMPLY_TARGET_AVX2 static Vec max(Vec a, Vec b) noexcept { return _mm256_max_epi32(a, b); }
+    template <Compare Op>
+    SIMPLY_TARGET_AVX2 static Mask cmp(Vec a, Vec b) noexcept {
+        const __m256i all = _mm256_set1_epi32(-1);
+        if constexpr ( Op == Compare::EQUAL )          return _mm256_cmpeq_epi32(a, b);
+        else if constexpr ( Op == Compare::NOT_EQUAL ) return _mm256_xor_si256(_mm256_cmpeq_epi32(a, b), all);
+        else if constexpr ( Op == Compare::LESS )      return _mm256_cmpgt_epi32(b, a);
+        else if constexpr ( Op == Compare::LESS_EQUAL ) return _mm256_xor_si256(_mm256_cmpgt_epi32(a, b), all);
+        else if constexpr ( Op == Compare::GREATER )   return _mm256_cmpgt_epi32(a, b);
+        else                                           return _mm256_xor_si256(_mm256_cmpgt_epi32(b, a), all);
+    }
+    SIMPLY_TARGET_AVX2 static Counts no_counts() noexcept { return _mm256_setzero_si256(); }
+    SIMPLY_TARGET_AVX2 static Counts count(Counts counts, Mask mask) noexcept { return _mm256_sub_epi32(counts, mask); }
+    SIMPLY_TARGET_AVX2 static size_t total(Counts counts) noexcept {
+        uint32_t lanes[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), counts);
+        return _lane_total(lanes);
+    }
+};
+
+// ===== SIMD kernels >> AVX-512 =====
+template <class T>
+struct _Avx512;
+
+template <>
+struct _Avx512<float> {
+    using Vec = __m512;
+    using Mask = __mmask16;
+    using Counts = __m512i;
+    static constexpr size_t width = 16;
+    SIMPLY_TARGET_AVX512 static Vec zero() noexcept { return _mm512_setzero_ps(); }
+    SIMPLY_TARGET_AVX512 static Vec set1(float value) noexcept { return _mm512_set1_ps(value); }
+    SIMPLY_TARGET_AVX512 static Vec load(const float* data) noexcept { return _mm512_loadu_ps(data); }
+    SIMPLY_TARGET_AVX512 static void store(float* data, Vec v) noexcept { _mm512_storeu_ps(data, v); }
+    SIMPLY_TARGET_AVX512 static Vec add(Vec a, Vec b) noexcept { return _mm512_add_ps(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec mul(Vec a, Vec b) noexcept { return _mm512_mul_ps(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec min(Vec a, Vec b) noexcept { return _mm512_min_ps(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec max(Vec a, Vec b) noexcept { return _mm512_max_ps(a, b); }
+    template <Compare Op>
+    SIMPLY_TARGET_AVX512 static Mask cmp(Vec a, Vec b) noexcept { return _mm512_cmp_ps_mask(a, b, _cmp_predicate<Op>); }
+    SIMPLY_TARGET_AVX512 static Counts no_counts() noexcept { return _mm512_setzero_si512(); }
+    SIMPLY_TARGET_AVX512 static Counts count(Counts counts, Mask mask) noexcept {
+        return _mm512_mask_add_epi32(counts, mask, counts, _mm512_set1_epi32(1));
+    }
+    SIMPLY_TARGET_AVX512 static size_t total(Counts counts) noexcept {
+        uint32_t lanes[16];
+        _mm512_storeu_si512(lanes, counts);
+        return _lane_total(lanes);
+    }
+};
+
+template <>
+struct _Avx512<double> {
+    using Vec = __m512d;
+    using Mask = __mmask8;
+    using Counts = __m512i;
+    static constexpr size_t width = 8;
+    SIMPLY_TARGET_AVX512 static Vec zero() noexcept { return _mm512_setzero_pd(); }
+    SIMPLY_TARGET_AVX512 static Vec set1(double value) noexcept { return _mm512_set1_pd(value); }
+    SIMPLY_TARGET_AVX512 static Vec load(const double* data) noexcept { return _mm512_loadu_pd(data); }
+    SIMPLY_TARGET_AVX512 static void store(double* data, Vec v) noexcept { _mm512_storeu_pd(data, v); }
+    SIMPLY_TARGET_AVX512 static Vec add(Vec a, Vec b) noexcept { return _mm512_add_pd(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec mul(Vec a, Vec b) noexcept { return _mm512_mul_pd(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec min(Vec a, Vec b) noexcept { return _mm512_min_pd(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec max(Vec a, Vec b) noexcept { return _mm512_max_pd(a, b); }
+    template <Compare Op>
+    SIMPLY_TARGET_AVX512 static Mask cmp(Vec a, Vec b) noexcept { return _mm512_cmp_pd_mask(a, b, _cmp_predicate<Op>); }
+    SIMPLY_TARGET_AVX512 static Counts no_counts() noexcept { return _mm512_setzero_si512(); }
+    SIMPLY_TARGET_AVX512 static Counts count(Counts counts, Mask mask) noexcept {
+        return _mm512_mask_add_epi64(counts, mask, counts, _mm512_set1_epi64(1));
+    }
+    SIMPLY_TARGET_AVX512 static size_t total(Counts counts) noexcept {
+        uint64_t lanes[8];
+        _mm512_storeu_si512(lanes, counts);
+        return _lane_total(lanes);
+    }
+};
+
+template <>
+struct _Avx512<int32_t> {
+    using Vec = __m512i;
+    using Mask = __mmask16;
+    using Counts = __m512i;
+    static constexpr size_t width = 16;
+    SIMPLY_TARGET_AVX512 static Vec zero() noexcept { return _mm512_setzero_si512(); }
+    SIMPLY_TARGET_AVX512 static Vec set1(int32_t value) noexcept { return _mm512_set1_epi32(value); }
+    SIMPLY_TARGET_AVX512 static Vec load(const int32_t* data) noexcept { return _mm512_loadu_si512(data); }
+    SIMPLY_TARGET_AVX512 static void store(int32_t* data, Vec v) noexcept { _mm512_storeu_si512(data, v); }
+    SIMPLY_TARGET_AVX512 static Vec add(Vec a, Vec b) noexcept { return _mm512_add_epi32(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec mul(Vec a, Vec b) noexcept { return _mm512_mullo_epi32(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec min(Vec a, Vec b) noexcept { return _mm512_min_epi32(a, b); }
+    SIMPLY_TARGET_AVX512 static Vec max(Vec a, Vec b) noexcept { return _mm512_max_epi32(a, b); }
+    template <Compare Op>
+    SIMPLY_TARGET_AVX512 static Mask cmp(Vec a, Vec b) noexcept {
+        if constexpr ( Op == Compare::EQUAL )          return _mm512_cmpeq_epi32_mask(a, b);
+        else if constexpr ( Op == Compare::NOT_EQUAL ) return _mm512_cmpneq_epi32_mask(a, b);
+        else if constexpr ( Op == Compare::LESS )      return _mm512_cmplt_epi32_mask(a, b);
+        else if constexpr ( Op == Compare::LESS_EQUAL ) return _mm512_cmple_epi32_mask(a, b);
+        else if constexpr ( Op == Compare::GREATER )   return _mm512_cmpgt_epi32_mask(a, b);
+        else                                           return _mm512_cmpge_epi32_mask(a, b);
+    }
+    SIMPLY_TARGET_AVX512 static Counts no_counts() noexcept { return _mm512_setzero_si512(); }
+    SIMPLY_TARGET_AVX512 static Counts count(Counts counts, Mask mask) noexcept {
+        return _mm512_mask_add_epi32(counts, mask, counts, _mm512_set1_epi32(1));
+    }
+    SIMPLY_TARGET_AVX512 static size_t total(Counts counts) noexcept {
+        uint32_t lanes[16];
+        _mm512_storeu_si512(lanes, counts);
+        return _lane_total(lanes);
+    }
+};
+
+// ===== SIMD kernels >> Kernels =====
+// One set per instruction set, differing only in traits and target -
+// a function using wider vectors must be compiled for them as a whole.
+// Four accumulators hide the latency of each add, min or max.
+#define SIMPLY_SIMD_REDUCE_KERNELS(suffix, Traits, TARGET)                                  \
+    template <class T>                                                                       \
+    TARGET _Acc<T> _sum_##suffix(const T* data, size_t size) noexcept {                      \
+        using V = Traits<T>;                                                                 \
+        typename V::Vec acc[4] = {V::zero(), V::zero(), V::zero(), V::zero()};               \
+        size_t i = 0;                                                                        \
+        for ( ; i + 4 * V::width <= size; i += 4 * V::width )                                \
+            for ( size_t k = 0; k < 4; k++ )                                                 \
+                acc[k] = V::add(acc[k], V::load(data + i + k * V::width));                   \
+        for ( ; i + V::width <= size; i += V::width )                                        \
+            acc[0] = V::add(acc[0], V::load(data + i));                                      \
+        T lanes[V::width];                                                                   \
+        V::store(lanes, V::add(V::add(acc[0], acc[1]), V::add(acc[2], acc[3])));             \
+        return _Acc<T>(_sum_scalar(lanes, V::width) + _sum_scalar(data + i, size - i));      \
+    }                                                                                        \
+                                                                                             \
+    template <class T>                                                                       \
+    TARGET _Acc<T> _dot_##suffix(const T* a, const T* b, size_t size) noexcept {             \
+        using V = Traits<T>;                                                                 \
+        typename V::Vec acc[4] = {V::zero(), V::zero(), V::zero(), V::zero()};               \
+        size_t i = 0;                                                                        \
+        for ( ; i + 4 * V::width <= size; i += 4 * V::width )                                \
+            for ( size_t k = 0; k < 4; k++ ) {                                               \
+                const size_t at = i + k * V::width;                                          \
+                acc[k] = V::add(acc[k], V::mul(V::load(a + at), V::load(b + at)));           \
+            }                                                                                \
+        for ( ; i + V::width <= size; i += V::width )                                        \
+            acc[0] = V::add(acc[0], V::mul(V::load(a + i), V::load(b + i)));                 \
+        T lanes[V::width];                                                                   \
+        V::store(lanes, V::add(V::add(acc[0], acc[1]), V::add(acc[2], acc[3])));             \
+        return _Acc<T>(_sum_scalar(lanes, V::width) + _dot_scalar(a + i, b + i, size - i));  \
+    }                                                                                        \
+                                                                                             \
+    template <class T>                                                                       \
+    TARGET void _minmax_##suffix(const T* data, size_t size, T& lo, T& hi) noexcept {        \
+        using V = Traits<T>;                                                                 \
+        size_t i = 0;                                                                        \
+        if ( size >= V::width ) {                                                            \
+            typename V::Vec low[4], high[4];                                                 \
+            for ( size_t k = 0; k < 4; k++ )                                                 \
+                low[k] = high[k] = V::load(data);                                            \
+            for ( ; i + 4 * V::width <= size; i += 4 * V::width )                            \
+                for ( size_t k = 0; k < 4; k++ ) {                                           \
+                    const typename V::Vec x = V::load(data + i + k * V::width);              \
+                    low[k]  = V::min(low[k], x);                                             \
+                    high[k] = V::max(high[k], x);                                            \
+                }                                                                            \
+            for ( ; i + V::width <= size; i += V::width ) {                                  \
+                const typename V::Vec x = V::load(data + i);                                 \
+                low[0]  = V::min(low[0], x);                                                 \
+                high[0] = V::max(high[0], x);                                                \
+            }                                                                                \
+            T lanes[V::width];                                                               \
+            V::store(lanes, V::min(V::min(low[0], low[1]), V::min(low[2], low[3])));         \
+            _minmax_scalar(lanes, V::width, lo, hi);                                         \
+            V::store(lanes, V::max(V::max(high[0], high[1]), V::max(high[2], high[3])));     \
+            _minmax_scalar(lanes, V::width, lo, hi);                                         \
+        }                                                                                    \
+        _minmax_scalar(data + i, size - i, lo, hi);                                          \
+    }                                                                                        \
+                                                                                             \
+    template <Compare Op, class T>                                                           \
+    TARGET size_t _count_##suffix(const T* data, size_t size, T value) noexcept {            \
+        using V = Traits<T>;                                                                 \
+        const typename V::Vec against = V::set1(value);                                      \
+        typename V::Counts counts = V::no_counts();                                          \
+        size_t i = 0;                                                                        \
+        for ( ; i + V::width <= size; i += V::width )                                        \
+            counts = V::count(counts, V::template cmp<Op>(V::load(data + i), against));      \
+        return V::total(counts) + _count_scalar<Op>(data + i, size - i, value);              \
+    }
+
+SIMPLY_SIMD_REDUCE_KERNELS(sse2, _Sse2, )
+SIMPLY_SIMD_REDUCE_KERNELS(avx2, _Avx2, SIMPLY_TARGET_AVX2)
+SIMPLY_SIMD_REDUCE_KERNELS(avx512, _Avx512, SIMPLY_TARGET_AVX512)
+#undef SIMPLY_SIMD_REDUCE_KERNELS
+
+inline Simd _detect_simd() noexcept {
+    if ( _cpu_features.avx512f )
+        return Simd::AVX512;
+    if ( _cpu_features.avx2 )
+        return Simd::AVX2;
+    return Simd::SSE2;
+}
+
+inline const Simd _simd_supported = _detect_simd();
+#else
+inline const Simd _simd_supported = Simd::SCALAR;
+#endif // SIMPLY_SIMD_KERNELS
+
+// =====================================================================
+// parallel_reduce >> Helpers
+// =====================================================================
+template <class T>
+constexpr void _check_reduce_type() noexcept {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                  "simply: parallel reductions need an arithmetic element type, other than bool");
+}
+
+// Kernels to run - the narrower of asked for and supported
+inline Simd _reduce_simd(const ReduceOptions& options, bool exact) noexcept {
+    if ( options.reproducible && !exact )
+        return Simd::SCALAR;
+    return options.simd == Simd::BEST ? _simd_supported : std::max(options.simd, _simd_supported);
+}
+
+// Calls block(offset, length) per block of size elements, on up to
+// threads threads, and returns the results in block order
+template <class R, class Block>
+std::vector<R> _reduce_blocks(size_t size, size_t block_size, unsigned threads, Block&& block) {
+    const size_t blocks = (size + block_size - 1) / block_size;
+    std::vector<R> results(blocks);
+
+    std::atomic<size_t> next{0};
+    auto work = [&](){
+        for ( size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < blocks; ) {
+            const size_t offset = i * block_size;
+            results[i] = block(offset, std::min(block_size, size - offset));
+        }
+    };
+
+    const size_t workers = std::min<size_t>(threads ? threads : std::max(Thread::hardware_concurrency(), 1u),
+                                            blocks);
+    std::vector<Thread> helpers;
+    if ( workers > 1 ) {
+        helpers.reserve(workers - 1);
+        try {
+            for ( size_t i = 1; i < workers; i++ )
+                helpers.emplace_back(work);
+        }
+        catch ( const std::system_error& ) {} // Fewer threads, the rest still runs
+    }
+    work();
+    for ( Thread& helper: helpers )
+        helper.join();
+    return results;
+}
+
+template <class T>
+_Acc<T> _sum_block(Simd simd, const T* data, size_t size) noexcept {
+#if SIMPLY_SIMD_KERNELS
+    if constexpr ( _has_simd_kernels<T> ) {
+        switch ( simd ) {
+        case Simd::AVX512: return _sum_avx512(data, size);
+        case Simd::AVX2:   return _sum_avx2(data, size);
+        case Simd::SSE2:   return _sum_sse2(data, size);
+        default:           break;
+        }
+    }
+#endif
+    return _sum_scalar(data, size);
+}
+
+template <class T>
+_Acc<T> _dot_block(Simd simd, const T* a, const T* b, size_t size) noexcept {
+#if SIMPLY_SIMD_KERNELS
+    if constexpr ( _has_simd_kernels<T> ) {
+        switch ( simd ) {
+        case Simd::AVX512: return _dot_avx512(a, b, size);
+        case Simd::AVX2:   return _dot_avx2(a, b, size);
+        case Simd::SSE2:   return _dot_sse2(a, b, size);
+        default:           break;
+        }
+    }
+#endif
+    return _dot_scalar(a, b, size);
+}
+
+// Smallest and largest of a block of at least 1 element
+template <class T>
+std::pair<T, T> _minmax_block(Simd simd, const T* data, size_t size) noexcept {
+    T lo = data[0], hi = data[0];
+#if SIMPLY_SIMD_KERNELS
+    if constexpr ( _has_simd_kernels<T> ) {
+        switch ( simd ) {
+        case Simd::AVX512: _minmax_avx512(data, size, lo, hi); return {lo, hi};
+        case Simd::AVX2:   _minmax_avx2(data, size, lo, hi);   return {lo, hi};
+        case Simd::SSE2:   _minmax_sse2(data, size, lo, hi);   return {lo, hi};
+        default:           break;
+        }
+    }
+#endif
+    _minmax_scalar(data + 1, size - 1, lo, hi);
+    return {lo, hi};
+}
+
+template <Compare Op, class T>
+size_t _count_block(Simd simd, const T* data, size_t size, T value) noexcept {
+#if SIMPLY_SIMD_KERNELS
+    if constexpr ( _has_simd_kernels<T> ) {
+        switch ( simd ) {
+        case Simd::AVX512: return _count_avx512<Op>(data, size, value);
+        case Simd::AVX2:   return _count_avx2<Op>(data, size, value);
+        case Simd::SSE2:   return _count_sse2<Op>(data, size, value);
+        default:           break;
+        }
+    }
+#endif
+    return _count_scalar<Op>(data, size, value);
+}
+
+// Calls f with op as a `std::integral_constant`, so kernels are compiled per comparison
+template <class F>
+decltype(auto) _with_compare(Compare op, F&& f) {
+    switch ( op ) {
+    case Compare::EQUAL:      return f(std::integral_constant<Compare, Compare::EQUAL>());
+    case Compare::NOT_EQUAL:  return f(std::integral_constant<Compare, Compare::NOT_EQUAL>());
+    case Compare::LESS:       return f(std::integral_constant<Compare, Compare::LESS>());
+    case Compare::LESS_EQUAL: return f(std::integral_constant<Compare, Compare::LESS_EQUAL>());
+    case Compare::GREATER:    return f(std::integral_constant<Compare, Compare::GREATER>());
+    default:                  return f(std::integral_constant<Compare, Compare::GREATER_EQUAL>());
+    }
+}
+
+template <class T>
+std::pair<T, T> _parallel_minmax(const char* name, const T* data, size_t size, const ReduceOptions& options) {
+    _check_reduce_type<T>();
+    if ( size == 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            std::string(name) + ": no elements"
+        );
+
+    const Simd simd = _reduce_simd(options, false);
+    const std::vector<std::pair<T, T>> blocks = _reduce_blocks<std::pair<T, T>>(
+        size, _reduce_block_bytes / sizeof(T), options.threads,
+        [simd, data](size_t offset, size_t length){ return _minmax_block(simd, data + offset, length); }
+    );
+    std::pair<T, T> result = blocks[0];
+    for ( const auto& block: blocks ) {
+        result.first  = std::min(result.first, block.first);
+        result.second = std::max(result.second, block.second);
+    }
+    return result;
+}
+
+// =====================================================================
+// parallel_reduce >> Implementations
+// =====================================================================
+template <class T>
+T parallel_sum(const T* data, size_t size, const ReduceOptions& options) {
+    _check_reduce_type<T>();
+    const Simd simd = _reduce_simd(options, std::is_integral_v<T>);
+    _Acc<T> total = 0;
+    for ( _Acc<T> block: _reduce_blocks<_Acc<T>>(size, _reduce_block_bytes / sizeof(T), options.threads,
+            [simd, data](size_t offset, size_t length){ return _sum_block(simd, data + offset, length); }) )
+        total = _Acc<T>(total + block);
+    return static_cast<T>(total);
+}
+
+template <class T>
+T parallel_dot(const T* a, const T* b, size_t size, const ReduceOptions& options) {
+    _check_reduce_type<T>();
+    const Simd simd = _reduce_simd(options, std::is_integral_v<T>);
+    _Acc<T> total = 0;
+    for ( _Acc<T> block: _reduce_blocks<_Acc<T>>(size, _reduce_block_bytes / sizeof(T), options.threads,
+            [simd, a, b](size_t offset, size_t length){ return _dot_block(simd, a + offset, b + offset, length); }) )
+        total = _Acc<T>(total + block);
+    return static_cast<T>(total);
+}
+
+template <class T>
+T parallel_min(const T* data, size_t size, const ReduceOptions& options) {
+    return _parallel_minmax("parallel_min", data, size, options).first;
+}
+
+template <class T>
+T parallel_max(const T* data, size_t size, const ReduceOptions& options) {
+    return _parallel_minmax("parallel_max", data, size, options).second;
+}
+
+template <class T>
+std::pair<T, T> parallel_minmax(const T* data, size_t size, const ReduceOptions& options) {
+    return _parallel_minmax("parallel_minmax", data, size, options);
+}
+
+template <class T>
+size_t parallel_count_if(const T* data, size_t size, Compare op, typename _Identity<T>::type value,
+                         const ReduceOptions& options) {
+    _check_reduce_type<T>();
+    const Simd simd = _reduce_simd(options, true);
+    return _with_compare(op, [&](auto compare){
+        size_t total = 0;
+        for ( size_t block: _reduce_blocks<size_t>(size, _reduce_block_bytes / sizeof(T), options.threads,
+                [simd, data, value](size_t offset, size_t length){
+                    return _count_block<decltype(compare)::value>(simd, data + offset, length, value);
+                }) )
+            total += block;
+        return total;
+    });
+}
+
+inline Simd supported_simd() noexcept {
+    return _simd_supported;
+}
+}
+
+#endif // SIMPLY_PARALLEL_REDUCE_HPP_
@@ -0,0 +1,201 @@
+/// rate_limiter.h
+/// Lock-free rate limiter shared between threads
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// A token bucket behind a mutex serializes every caller. `RateLimiter`
+/// instead follows the Generic Cell Rate Algorithm (GCRA), where the
+/// whole state is a single timestamp - the "theoretical arrival time"
+/// at which the bucket would next be full. Taking tokens moves it
+/// forward, so `try_acquire` is a single compare-and-swap (retried only
+/// if another thread changed it in between).
+///
+///   Classes
+/// simply::RateLimiter
+///     Limits to some rate per second, allowing bursts up to some size.
+#ifndef SIMPLY_RATE_LIMITER_HPP_
+#define SIMPLY_RATE_LIMITER_HPP_
+
+#include "concurrency.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <system_error>
+
+namespace simply {
+// =====================================================================
+// RateLimiter >> Declaration
+// =====================================================================
+///   RateLimiter
+/// Limits tokens taken per second, across any number of threads
+///
+///   Behaviours
+/// - Bursts
+///     Up to `burst` tokens may be taken at once after a quiet period,
+///     after which tokens become available at the given rate.
+/// - Fair waiting
+///     `acquire` reserves its tokens before sleeping, so waiting threads
+///     are served in the order they called, and never more than the
+///     rate allows.
+/// - `system_error` thrown for invalid arguments
+///     For example a non-positive rate, or more tokens than `burst`.
+///     A token interval (`1/rate`) or burst span (`burst/rate`) of over
+///     about 70 years is also refused, as times are kept in nanoseconds.
+///
+///   Example
+/// ```
+/// simply::RateLimiter limiter(100.0, 10); // 100/s, bursts of 10
+///
+/// if ( limiter.try_acquire() )
+///     send_request();
+///
+/// limiter.acquire(); // Sleeps until allowed
+/// send_request();
+/// ```
+class RateLimiter final {
+public:
+    ///   Constructor
+    ///
+    ///   Params
+    /// rate Tokens per second
+    /// burst Most tokens which may be taken at once
+    RateLimiter(double rate, size_t burst = 1);
+
+    ///   No copying or moving
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    ///   try_acquire
+    /// Take tokens if available right now
+    ///
+    /// Returns whether they were taken
+    SIMPLY_NODISCARD bool try_acquire(size_t tokens = 1);
+
+    ///   acquire
+    /// Take tokens, sleeping until they are available
+    void acquire(size_t tokens = 1);
+
+    ///   rate
+    /// Tokens per second, as given to the constructor
+    SIMPLY_NODISCARD double rate() const noexcept;
+
+    ///   burst
+    /// Most tokens which may be taken at once, as given to the constructor
+    SIMPLY_NODISCARD size_t burst() const noexcept;
+
+private:
+    // Longest interval or burst span, in nanoseconds. Leaves the steady
+    // clock (itself below this, for decades of uptime) room to add a span
+    // to the arrival time without overflowing.
+    static constexpr int64_t _max_span = std::numeric_limits<int64_t>::max() / 4;
+
+    // Nanoseconds since the steady clock's epoch
+    static int64_t _now() noexcept;
+
+    int64_t _cost(size_t tokens) const;
+
+    double _rate;
+    size_t _burst;
+    int64_t _interval;          // Nanoseconds per token
+    int64_t _tolerance;         // Nanoseconds of burst allowed
+    std::atomic<int64_t> _tat;  // Theoretical arrival time
+};
+
+// =====================================================================
+// RateLimiter >> Implementations
+// =====================================================================
+inline RateLimiter::RateLimiter(double rate, size_t burst):
+    _rate(rate),
+    _burst(burst),
+    _interval(0),
+    _tolerance(0),
+    _tat(0)
+{
+    if ( !(rate > 0.0) || burst == 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "RateLimiter: rate and burst must be positive"
+        );
+    const double interval = 1e9 / rate;
+    if ( !(interval <= static_cast<double>(_max_span)) )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "RateLimiter: rate too low, over 70 years per token"
+        );
+    _interval = std::max<int64_t>(static_cast<int64_t>(interval), 1); // Clamped, for rates over 1e9/s
+
+    if ( burst > static_cast<uint64_t>(_max_span / _interval) )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "RateLimiter: burst too large for rate, over 70 years of tokens"
+        );
+    _tolerance = _interval * static_cast<int64_t>(burst);
+}
+
+inline int64_t RateLimiter::_now() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+inline int64_t RateLimiter::_cost(size_t tokens) const {
+    if ( tokens > _burst )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "RateLimiter: tokens exceed burst"
+        );
+    return _interval * static_cast<int64_t>(tokens);
+}
+
+inline bool RateLimiter::try_acquire(size_t tokens) {
+    const int64_t cost = _cost(tokens);
+    const int64_t now  = _now();
+
+    int64_t tat = _tat.load(std::memory_order_relaxed);
+    for (;;) {
+        int64_t next = std::max(tat, now) + cost;
+        if ( next - now > _tolerance )
+            return false;
+        if ( _tat.compare_exchange_weak(tat, next, std::memory_order_relaxed) )
+            return true;
+    }
+}
+
+inline void RateLimiter::acquire(size_t tokens) {
+    const int64_t cost = _cost(tokens);
+    const int64_t now  = _now();
+
+    // Reserve unconditionally, then wait for the reservation to be due
+    int64_t tat = _tat.load(std::memory_order_relaxed);
+    int64_t next;
+    do {
+        next = std::max(tat, now) + cost;
+    } while ( !_tat.compare_exchange_weak(tat, next, std::memory_order_relaxed) );
+
+    int64_t wait = next - now - _tolerance;
+    if ( wait > 0 )
+        this_thread::sleep_for(std::chrono::nanoseconds(wait));
+}
+
+inline double RateLimiter::rate() const noexcept {
+    return _rate;
+}
+
+inline size_t RateLimiter::burst() const noexcept {
+    return _burst;
+}
+}
+
+#endif // SIMPLY_RATE_LIMITER_HPP_
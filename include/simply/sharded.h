@@ -0,0 +1,371 @@
+/// sharded.h
+/// Per-thread sharded counters, maxima and histograms
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// A single atomic counter updated from many threads makes every core
+/// fight over the same cache line. The classes here instead keep one
+/// padded cell per shard, and each thread only touches the shard picked
+/// by its `this_thread::get_index()`. Updates are relaxed atomics on a
+/// (nearly always) uncontended cache line, and reads sum/merge all cells.
+///
+/// Reads are therefore more expensive than updates, and are not a
+/// consistent snapshot while updates are still ongoing. This suits
+/// statistics which are updated often, but read rarely.
+///
+///   Classes
+/// simply::ShardedCounter
+///     A counter (or gauge, if also decremented), summed on read.
+///
+/// simply::ShardedMax
+///     A running maximum, maxed on read.
+///
+/// simply::ShardedHistogram
+///     Counts of values within user-provided bucket bounds.
+#ifndef SIMPLY_SHARDED_HPP_
+#define SIMPLY_SHARDED_HPP_
+
+#include "concurrency.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+namespace simply {
+// =====================================================================
+// Shards >> Helpers
+// =====================================================================
+// Kept fixed rather than using `std::hardware_destructive_interference_size`,
+// as not all supported compilers provide it
+constexpr size_t _cache_line = 64;
+
+inline size_t _round_shards(size_t shards) noexcept {
+    size_t count = 1;
+    while ( count < shards )
+        count <<= 1;
+    return count;
+}
+
+// Enough shards for all hardware threads, so that each running thread
+// usually has a shard to itself
+inline size_t _shard_count() noexcept {
+    return _round_shards(Thread::hardware_concurrency());
+}
+
+// Array of cells, each on its own cache line(s)
+template <class Cell>
+class _Shards final {
+public:
+    explicit _Shards(size_t shards):
+        _cells(new _Padded[_round_shards(shards)]),
+        _mask(_round_shards(shards) - 1) {}
+
+    Cell& local() noexcept
+        { return _cells[this_thread::get_index() & _mask].cell; }
+
+    Cell& operator[](size_t i) noexcept
+        { return _cells[i].cell; }
+
+    const Cell& operator[](size_t i) const noexcept
+        { return _cells[i].cell; }
+
+    size_t size() const noexcept
+        { return _mask + 1; }
+
+private:
+    struct alignas(_cache_line) _Padded { Cell cell; };
+
+    std::unique_ptr<_Padded[]> _cells;
+    size_t _mask;
+};
+
+// Shards of `size` counts each, every shard starting on its own cache line
+class _ShardedArray final {
+public:
+    _ShardedArray(size_t size, size_t shards):
+        _size(size),
+        _stride((size + _per_line - 1) / _per_line),
+        _mask(_round_shards(shards) - 1),
+        _lines(new _Line[(_mask + 1) * _stride])
+        { reset(); }
+
+    size_t local() const noexcept
+        { return this_thread::get_index() & _mask; }
+
+    std::atomic<uint64_t>& cell(size_t shard, size_t i) const noexcept
+        { return _lines[shard * _stride + i / _per_line].cells[i % _per_line]; }
+
+    size_t shards() const noexcept
+        { return _mask + 1; }
+
+    size_t size() const noexcept
+        { return _size; }
+
+    void reset() noexcept {
+        for ( size_t line = 0; line < (_mask + 1) * _stride; line++ )
+            for ( auto& cell: _lines[line].cells )
+                cell.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t _per_line = _cache_line / sizeof(std::atomic<uint64_t>);
+    struct alignas(_cache_line) _Line { std::atomic<uint64_t> cells[_per_line]; };
+
+    size_t _size;
+    size_t _stride; // Lines per shard
+    size_t _mask;
+    std::unique_ptr<_Line[]> _lines;
+};
+
+// =====================================================================
+// ShardedCounter >> Declaration
+// =====================================================================
+///   ShardedCounter
+/// A signed counter, cheap to update from many threads at once
+///
+/// May also be used as a gauge, by adding negative values.
+///
+///   Example
+/// ```
+/// simply::ShardedCounter requests;
+/// requests.add();      // From any number of threads...
+/// requests.read();     // Sum of all adds so far
+/// ```
+class ShardedCounter final {
+public:
+    ///   Constructor
+    /// Uses one shard per hardware thread (rounded up to a power of 2)
+    ShardedCounter();
+
+    ///   Constructor
+    /// Uses (at least) the given number of shards
+    explicit ShardedCounter(size_t shards);
+
+    ///   add
+    /// Add to the calling thread's shard
+    void add(int64_t value = 1) noexcept;
+
+    ///   read
+    /// Sum all shards
+    SIMPLY_NODISCARD int64_t read() const noexcept;
+
+    ///   reset
+    /// Set all shards to 0
+    ///
+    /// Any concurrent adds may or may not be kept
+    void reset() noexcept;
+
+private:
+    _Shards<std::atomic<int64_t>> _shards;
+};
+
+// =====================================================================
+// ShardedMax >> Declaration
+// =====================================================================
+///   ShardedMax
+/// A running maximum, cheap to update from many threads at once
+///
+/// Before any updates, `read` returns the lowest possible `int64_t`.
+class ShardedMax final {
+public:
+    ///   Constructor
+    /// Uses one shard per hardware thread (rounded up to a power of 2)
+    ShardedMax();
+
+    ///   Constructor
+    /// Uses (at least) the given number of shards
+    explicit ShardedMax(size_t shards);
+
+    ///   update
+    /// Raise the calling thread's shard to value, if it is higher
+    void update(int64_t value) noexcept;
+
+    ///   read
+    /// Maximum of all shards
+    SIMPLY_NODISCARD int64_t read() const noexcept;
+
+    ///   reset
+    /// Forget all updates so far
+    void reset() noexcept;
+
+private:
+    _Shards<std::atomic<int64_t>> _shards;
+};
+
+// =====================================================================
+// ShardedHistogram >> Declaration
+// =====================================================================
+///   ShardedHistogram
+/// Bucketed counts of values, cheap to update from many threads at once
+///
+/// Buckets are given by their (inclusive) upper bounds, and one extra
+/// bucket counts anything above the last bound. For example bounds
+/// `{10, 100}` give the buckets `<= 10`, `<= 100` and `> 100`.
+///
+/// For latencies spanning many orders of magnitude, see `LatencyHistogram`.
+class ShardedHistogram final {
+public:
+    ///   Constructor
+    /// Throws `system_error` if bounds are not sorted ascending
+    explicit ShardedHistogram(std::vector<int64_t> bounds);
+
+    ///   Constructor
+    /// Uses (at least) the given number of shards
+    ShardedHistogram(std::vector<int64_t> bounds, size_t shards);
+
+    ///   record
+    /// Count value in the calling thread's shard
+    void record(int64_t value) noexcept;
+
+    ///   read
+    /// Counts of each bucket summed across all shards
+    ///
+    /// Has `bounds().size() + 1` elements, the last being the overflow bucket
+    SIMPLY_NODISCARD std::vector<uint64_t> read() const;
+
+    ///   count
+    /// Total number of values recorded
+    SIMPLY_NODISCARD uint64_t count() const noexcept;
+
+    ///   sum
+    /// Sum of all values recorded
+    SIMPLY_NODISCARD int64_t sum() const noexcept;
+
+    ///   bounds
+    /// Upper bounds of each bucket, as given to the constructor
+    SIMPLY_NODISCARD const std::vector<int64_t>& bounds() const noexcept;
+
+    ///   reset
+    /// Set all buckets to 0
+    void reset() noexcept;
+
+private:
+    std::vector<int64_t> _bounds;
+    _ShardedArray _cells; // Per shard: [buckets..., overflow, sum]
+};
+
+// =====================================================================
+// ShardedCounter >> Implementations
+// =====================================================================
+inline ShardedCounter::ShardedCounter(): ShardedCounter(_shard_count()) {}
+
+inline ShardedCounter::ShardedCounter(size_t shards): _shards(shards) {
+    reset();
+}
+
+inline void ShardedCounter::add(int64_t value) noexcept {
+    _shards.local().fetch_add(value, std::memory_order_relaxed);
+}
+
+inline int64_t ShardedCounter::read() const noexcept {
+    int64_t total = 0;
+    for ( size_t i = 0; i < _shards.size(); i++ )
+        total += _shards[i].load(std::memory_order_relaxed);
+    return total;
+}
+
+inline void ShardedCounter::reset() noexcept {
+    for ( size_t i = 0; i < _shards.size(); i++ )
+        _shards[i].store(0, std::memory_order_relaxed);
+}
+
+// =====================================================================
+// ShardedMax >> Implementations
+// =====================================================================
+inline ShardedMax::ShardedMax(): ShardedMax(_shard_count()) {}
+
+inline ShardedMax::ShardedMax(size_t shards): _shards(shards) {
+    reset();
+}
+
+inline void ShardedMax::update(int64_t value) noexcept {
+    std::atomic<int64_t>& cell = _shards.local();
+    int64_t current = cell.load(std::memory_order_relaxed);
+    while ( value > current && !cell.compare_exchange_weak(current, value, std::memory_order_relaxed) )
+        ;
+}
+
+inline int64_t ShardedMax::read() const noexcept {
+    int64_t highest = std::numeric_limits<int64_t>::min();
+    for ( size_t i = 0; i < _shards.size(); i++ )
+        highest = std::max(highest, _shards[i].load(std::memory_order_relaxed));
+    return highest;
+}
+
+inline void ShardedMax::reset() noexcept {
+    for ( size_t i = 0; i < _shards.size(); i++ )
+        _shards[i].store(std::numeric_limits<int64_t>::min(), std::memory_order_relaxed);
+}
+
+// =====================================================================
+// ShardedHistogram >> Implementations
+// =====================================================================
+inline ShardedHistogram::ShardedHistogram(std::vector<int64_t> bounds):
+    ShardedHistogram(std::move(bounds), _shard_count()) {}
+
+// Validated before allocating any cells
+inline std::vector<int64_t> _sorted_bounds(std::vector<int64_t> bounds) {
+    if ( !std::is_sorted(bounds.begin(), bounds.end()) )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "ShardedHistogram: bounds must be sorted ascending"
+        );
+    return bounds;
+}
+
+inline ShardedHistogram::ShardedHistogram(std::vector<int64_t> bounds, size_t shards):
+    _bounds(_sorted_bounds(std::move(bounds))),
+    _cells(_bounds.size() + 2, shards) {}
+
+inline void ShardedHistogram::record(int64_t value) noexcept {
+    size_t shard  = _cells.local();
+    size_t bucket = std::lower_bound(_bounds.begin(), _bounds.end(), value) - _bounds.begin();
+    _cells.cell(shard, bucket).fetch_add(1, std::memory_order_relaxed);
+    _cells.cell(shard, _bounds.size() + 1).fetch_add(static_cast<uint64_t>(value), std::memory_order_relaxed);
+}
+
+inline std::vector<uint64_t> ShardedHistogram::read() const {
+    std::vector<uint64_t> counts(_bounds.size() + 1, 0);
+    for ( size_t shard = 0; shard < _cells.shards(); shard++ )
+        for ( size_t i = 0; i < counts.size(); i++ )
+            counts[i] += _cells.cell(shard, i).load(std::memory_order_relaxed);
+    return counts;
+}
+
+inline uint64_t ShardedHistogram::count() const noexcept {
+    uint64_t total = 0;
+    for ( size_t shard = 0; shard < _cells.shards(); shard++ )
+        for ( size_t i = 0; i <= _bounds.size(); i++ )
+            total += _cells.cell(shard, i).load(std::memory_order_relaxed);
+    return total;
+}
+
+inline int64_t ShardedHistogram::sum() const noexcept {
+    uint64_t total = 0; // Unsigned to wrap (rather than overflow) on negatives
+    for ( size_t shard = 0; shard < _cells.shards(); shard++ )
+        total += _cells.cell(shard, _bounds.size() + 1).load(std::memory_order_relaxed);
+    return static_cast<int64_t>(total);
+}
+
+inline const std::vector<int64_t>& ShardedHistogram::bounds() const noexcept {
+    return _bounds;
+}
+
+inline void ShardedHistogram::reset() noexcept {
+    _cells.reset();
+}
+}
+
+#endif // SIMPLY_SHARDED_HPP_
@@ -0,0 +1,304 @@
+/// task.h
+/// Move-only, type-erased task with inline storage
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// `std::function` requires copyable callables, and allocates for all
+/// but the smallest captures. `Task` is the library's payload for work
+/// handed between threads instead:
+/// - Move-only, so it may hold `std::unique_ptr`, `std::promise` etc.
+/// - Callables up to `Task::inline_size` bytes are stored inline,
+///   so `sizeof(Task)` is a single cache line and most lambdas never
+///   touch the heap.
+/// - Like `Thread`, it may be given arguments, which are copied (or
+///   moved) in alongside the callable.
+///
+///   Checking for heap use
+/// `Task::stores_inline<F>` tells whether a callable type is stored
+/// inline, for a `static_assert` at a specific call site. Defining
+/// `SIMPLY_TASK_REQUIRE_INLINE` before including this header instead
+/// turns every heap-allocating `Task` into a compile error.
+///
+///   Classes
+/// simply::Task
+///     Type-erased `void()` callable, which may be moved but not copied.
+#ifndef SIMPLY_TASK_HPP_
+#define SIMPLY_TASK_HPP_
+
+#include "concurrency.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <system_error>
+
+namespace simply {
+// =====================================================================
+// Task >> Helpers
+// =====================================================================
+// Operations for one stored type, shared by all tasks storing it
+struct _TaskOps {
+    void (*invoke)(void* storage);
+    void (*move)(void* dst, void* src) noexcept; // Also destroys src
+    void (*destroy)(void* storage) noexcept;
+};
+
+// Binds arguments the same way `Thread` does for its callable
+template <class F, class... Args>
+struct _TaskBound {
+    std::tuple<F, Args...> bound;
+
+    void operator()() {
+        std::apply([](auto&... parts){ std::invoke(std::move(parts)...); }, bound);
+    }
+};
+
+// Reports a task running to any event hooks, even if it throws
+struct _TaskScope {
+    _TaskScope() noexcept  { _notify(_HookEvent::TASK_BEGIN); }
+    ~_TaskScope()          { _notify(_HookEvent::TASK_END); }
+};
+
+// =====================================================================
+// Task >> Declaration
+// =====================================================================
+///   Task
+/// Type-erased, move-only callable taking no parameters
+///
+///   Behaviours
+/// - Return values are discarded
+///     To get a result back, capture a `std::promise` (see examples).
+/// - Exceptions are propagated
+///     Anything thrown by the callable is thrown by `operator()`.
+/// - Arguments are moved into the call
+///     As for `Thread`, so a task given arguments should only be called once.
+/// - `system_error` thrown when calling an empty task
+///
+///   Example
+/// ```
+/// std::promise<int> promise;
+/// auto future = promise.get_future();
+///
+/// simply::Task task([p = std::move(promise)]() mutable { p.set_value(5); });
+/// task();
+/// future.get(); // 5
+///
+/// simply::Task with_args([](int a, int b){ ... }, 1, 2);
+/// ```
+class Task final {
+public:
+    ///   inline_size
+    /// Largest callable (in bytes) stored without allocating
+    static constexpr size_t inline_size = 64 - sizeof(const _TaskOps*);
+
+    ///   stores_inline
+    /// Whether a callable of type F is stored without allocating
+    ///
+    /// It must also be nothrow move-constructible, so that moving a
+    /// `Task` can never throw.
+    template <class F>
+    static constexpr bool stores_inline =
+           sizeof(std::decay_t<F>)  <= inline_size
+        && alignof(std::decay_t<F>) <= alignof(std::max_align_t)
+        && std::is_nothrow_move_constructible_v<std::decay_t<F>>;
+
+public:
+    ///   Empty Constructor
+    /// Creates an empty task, which throws if called
+    Task() noexcept;
+
+    ///   Empty Constructor
+    Task(std::nullptr_t) noexcept;
+
+    ///   Constructor
+    /// Store a callable, and any arguments to call it with
+    ///
+    ///   Params
+    /// f Callable to store, invocable with args
+    /// args Any number of arguments to pass to f
+    ///     Unless explicitly passed with `std::ref`, will be copied
+    template <class F, class... Args,
+              class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>
+                                    && !std::is_same_v<std::decay_t<F>, std::nullptr_t>>>
+    Task(F&& f, Args&&... args);
+
+    ///   Destructor
+    ~Task();
+
+    ///   No copying
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ///   Move Constructor
+    Task(Task&& other) noexcept;
+
+    ///   Move Assignment
+    Task& operator=(Task&& other) noexcept;
+
+    ///   swap
+    /// Swap two instances of this object
+    void swap(Task& other) noexcept;
+
+    ///   operator()
+    /// Call the stored callable
+    ///
+    /// Throws `system_error` if empty
+    void operator()();
+
+    ///   operator bool
+    /// Whether a callable is stored
+    explicit operator bool() const noexcept;
+
+private:
+    template <class F>
+    void _store(F&& f);
+
+    template <class F>
+    static const _TaskOps* _inline_ops() noexcept;
+
+    template <class F>
+    static const _TaskOps* _heap_ops() noexcept;
+
+    void _reset() noexcept;
+
+    alignas(std::max_align_t) unsigned char _storage[inline_size];
+    const _TaskOps* _ops;
+};
+
+// =====================================================================
+// Task >> Implementations
+// =====================================================================
+inline Task::Task() noexcept: _ops(nullptr) {}
+
+inline Task::Task(std::nullptr_t) noexcept: Task() {}
+
+template <class F, class... Args, class>
+Task::Task(F&& f, Args&&... args): Task() {
+    static_assert(std::is_invocable_v<std::decay_t<F>, std::decay_t<Args>...>,
+        "Ensure function and arguments match!");
+
+    if constexpr (sizeof...(Args) == 0)
+        _store(std::forward<F>(f));
+    else
+        _store(_TaskBound<std::decay_t<F>, std::decay_t<Args>...>{
+            {std::forward<F>(f), std::forward<Args>(args)...}
+        });
+}
+
+template <class F>
+void Task::_store(F&& f) {
+    using T = std::decay_t<F>;
+
+#ifdef SIMPLY_TASK_REQUIRE_INLINE
+    static_assert(stores_inline<T>,
+        "Task: callable does not fit inline (SIMPLY_TASK_REQUIRE_INLINE is defined)");
+#endif
+
+    if constexpr (stores_inline<T>) {
+        ::new (static_cast<void*>(_storage)) T(std::forward<F>(f));
+        _ops = _inline_ops<T>();
+    }
+    else {
+        ::new (static_cast<void*>(_storage)) T*(new T(std::forward<F>(f)));
+        _ops = _heap_ops<T>();
+    }
+}
+
+template <class F>
+const _TaskOps* Task::_inline_ops() noexcept {
+    static constexpr _TaskOps ops = {
+        [](void* storage) {
+            (*static_cast<F*>(storage))();
+        },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* storage) noexcept {
+            static_cast<F*>(storage)->~F();
+        }
+    };
+    return &ops;
+}
+
+template <class F>
+const _TaskOps* Task::_heap_ops() noexcept {
+    static constexpr _TaskOps ops = {
+        [](void* storage) {
+            (**static_cast<F**>(storage))();
+        },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) F*(*static_cast<F**>(src));
+        },
+        [](void* storage) noexcept {
+            delete *static_cast<F**>(storage);
+        }
+    };
+    return &ops;
+}
+
+inline void Task::_reset() noexcept {
+    if ( _ops ) {
+        _ops->destroy(_storage);
+        _ops = nullptr;
+    }
+}
+
+inline Task::~Task() {
+    _reset();
+}
+
+inline Task::Task(Task&& other) noexcept: Task() {
+    if ( other._ops ) {
+        other._ops->move(_storage, other._storage);
+        _ops = other._ops;
+        other._ops = nullptr;
+    }
+}
+
+inline Task& Task::operator=(Task&& other) noexcept {
+    if ( this != &other ) {
+        _reset();
+        if ( other._ops ) {
+            other._ops->move(_storage, other._storage);
+            _ops = other._ops;
+            other._ops = nullptr;
+        }
+    }
+    return *this;
+}
+
+inline void Task::swap(Task& other) noexcept {
+    Task temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+}
+
+inline void Task::operator()() {
+    if ( !_ops )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "Task: calling an empty task"
+        );
+    _TaskScope scope;
+    _ops->invoke(_storage);
+}
+
+inline Task::operator bool() const noexcept {
+    return _ops != nullptr;
+}
+}
+
+#endif // SIMPLY_TASK_HPP_
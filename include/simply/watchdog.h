@@ -0,0 +1,438 @@
+/// watchdog.h
+/// Watchdog thread reporting stalled workers, with their stacks
+///
+/// Copyright (c) 2025 Ferdinand Oliver M Tonby-Strandborg
+/// SPDX-License-Identifier: MIT
+///
+/// Requirements:  See concurrency.h
+///
+/// Distribution:  Header-only - include alongside concurrency.h
+
+/// ====================================================================
+/// Introduction
+/// ====================================================================
+///   Brief
+/// A worker which never returns from a task hangs quietly. With a
+/// `Watchdog`, each worker owns a `Heartbeat`, which it marks when it
+/// begins a task (and optionally during long tasks). Marking is a single
+/// relaxed store on the worker's own counter.
+///
+/// The watchdog runs as its own `Thread`, and every `interval` checks
+/// which counters moved. A heartbeat which has been inside the same task
+/// without moving for longer than `threshold` is reported once - which
+/// thread, which task, for how long, and (optionally) the thread's stack.
+///
+///   Stack capture
+/// The stalled thread is suspended just long enough to read its
+/// registers and unwind its stack (x64 only), then resumed. Nothing is
+/// allocated while it is suspended, as it may hold the heap's lock.
+/// Unwinding stops at the first frame outside the thread's stack, so a
+/// corrupt stack gives a short report rather than a crash. Stacks are
+/// written as `module+offset`, for symbolizing offline.
+///
+/// {note: Windows} Unwinding looks up function tables, which may wait
+///                 on a lock the stalled thread holds (such as the
+///                 loader's). Captures are made without holding the
+///                 watchdog's own lock, so this can only hang further
+///                 reports, never the workers' heartbeats. Set
+///                 `capture_stacks` to false if that is a concern.
+///
+///   Classes
+/// simply::Watchdog
+///     Thread checking heartbeats, and reporting stalls.
+/// simply::Heartbeat
+///     Marks the progress of one worker thread.
+#ifndef SIMPLY_WATCHDOG_HPP_
+#define SIMPLY_WATCHDOG_HPP_
+
+#include "concurrency.h"
+#include "mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <vector>
+
+namespace simply {
+class Heartbeat;
+
+// =====================================================================
+// Watchdog >> Declaration
+// =====================================================================
+///   Watchdog
+/// Thread reporting heartbeats stalled inside a task
+///
+///   Behaviours
+/// - Idle threads are never stalled
+///     Only a heartbeat between `begin` and `end` can stall, so a worker
+///     waiting for work is not reported.
+/// - Reported once per stall
+///     Until the heartbeat moves again.
+/// - Must outlive its heartbeats
+///     Destroying a `Watchdog` with heartbeats still registered is
+///     undefined behaviour.
+///
+///   Example
+/// ```
+/// simply::Watchdog::Options opt;
+/// opt.threshold = std::chrono::seconds(5);
+/// simply::Watchdog watchdog(opt); // Reports to std::cerr by default
+///
+/// simply::Thread worker([&watchdog](){
+///     simply::Heartbeat heartbeat(watchdog);
+///     while ( auto job = next_job() ) {
+///         heartbeat.begin("job");
+///         job->run();
+///         heartbeat.end();
+///     }
+/// });
+/// ```
+class Watchdog final {
+public:
+    ///   Report
+    /// A stalled heartbeat
+    struct Report {
+        Thread::id thread;
+        const char* task;                   // As given to `Heartbeat::begin`
+        std::chrono::nanoseconds stalled;   // Since the heartbeat last moved
+        std::vector<void*> stack;           // Innermost first, empty if not captured
+    };
+
+    ///   Options
+    /// Settings for a watchdog
+    struct Options {
+        ///   threshold
+        /// How long a heartbeat may stay still inside a task
+        std::chrono::milliseconds threshold = std::chrono::seconds(1);
+
+        ///   interval
+        /// How often heartbeats are checked, which bounds precision
+        std::chrono::milliseconds interval = std::chrono::milliseconds(100);
+
+        ///   priority
+        /// Priority of the watchdog thread
+        ///
+        /// HIGH lets it report even while workers saturate all CPUs,
+        /// LOWEST keeps it out of their way.
+        Thread::Priority priority = Thread::Priority::HIGH;
+
+        ///   capture_stacks
+        /// Whether to capture the stack of stalled threads
+        bool capture_stacks = true;
+
+        ///   on_stall
+        /// Called (on the watchdog thread) for each stall
+        ///
+        /// If empty, reports are written to `std::cerr`
+        std::function<void(const Report&)> on_stall;
+    };
+
+public:
+    ///   Constructor
+    /// Start the watchdog thread, with default options
+    Watchdog();
+
+    ///   Constructor
+    /// Start the watchdog thread
+    explicit Watchdog(Options opt);
+
+    ///   Destructor
+    /// Stop the watchdog thread
+    ~Watchdog();
+
+    ///   No copying or moving
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    ///   write_report
+    /// Write a report as text, as done by default
+    static void write_report(std::ostream& ost, const Report& report);
+
+private:
+    friend Heartbeat;
+
+    void _run();
+    void _check();
+
+    Options _opt;
+
+    Mutex _mutex;                           // Guards all below
+    ConditionVariable _wake;
+    bool _stopping = false;
+    std::vector<Heartbeat*> _heartbeats;
+
+    Thread _thread;
+};
+
+// =====================================================================
+// Heartbeat >> Declaration
+// =====================================================================
+///   Heartbeat
+/// Progress of the thread which made it, checked by a `Watchdog`
+///
+/// Only to be marked by the thread which made it.
+class Heartbeat final {
+public:
+    ///   Constructor
+    /// Register the calling thread with the watchdog
+    explicit Heartbeat(Watchdog& watchdog);
+
+    ///   Destructor
+    /// Unregister from the watchdog
+    ~Heartbeat();
+
+    ///   No copying or moving
+    Heartbeat(const Heartbeat&) = delete;
+    Heartbeat& operator=(const Heartbeat&) = delete;
+
+    ///   begin
+    /// Mark the start of a task, which may now stall
+    ///
+    /// task must outlive the heartbeat, for example a string literal
+    void begin(const char* task) noexcept;
+
+    ///   beat
+    /// Mark progress within a long task
+    void beat() noexcept;
+
+    ///   end
+    /// Mark the end of a task, after which the thread cannot stall
+    void end() noexcept;
+
+private:
+    friend Watchdog;
+
+    Watchdog& _watchdog;
+    const Thread::id _thread;
+    HANDLE _handle;                         // Own handle, for stack capture
+    uintptr_t _stack_low  = 0;              // Own stack's reservation
+    uintptr_t _stack_high = 0;
+
+    std::atomic<uint64_t> _count{0};        // Moved by begin and beat
+    std::atomic<const char*> _task{nullptr};
+
+    // Only used by the watchdog thread
+    uint64_t _seen_count = 0;
+    std::chrono::steady_clock::time_point _seen_at = std::chrono::steady_clock::now();
+    bool _reported = false;
+};
+
+// =====================================================================
+// Watchdog >> Helpers
+// =====================================================================
+constexpr size_t _watchdog_stack_depth = 32;
+
+// A stall found under the watchdog's lock, captured after releasing it
+struct _Stall {
+    Watchdog::Report report;
+    HANDLE thread;                          // Duplicated, nullptr if not capturing
+    uintptr_t stack_low;
+    uintptr_t stack_high;
+};
+
+// Captures the stack of another thread, into frames
+// Stops at the first frame outside [stack_low, stack_high), or which
+// does not move up the stack, so a corrupt stack is never followed
+// Allocates nothing, as the suspended thread may hold the heap's lock
+inline size_t _capture_stack(HANDLE thread, uintptr_t stack_low, uintptr_t stack_high,
+                             void** frames, size_t depth) noexcept {
+#if defined(_M_X64) || defined(__x86_64__)
+    if ( SuspendThread(thread) == static_cast<DWORD>(-1) )
+        return 0;
+
+    size_t captured = 0;
+    CONTEXT context = {};
+    context.ContextFlags = CONTEXT_FULL;
+    if ( GetThreadContext(thread, &context) ) {
+        DWORD64 previous = 0;
+        while ( captured < depth && context.Rip ) {
+            frames[captured++] = reinterpret_cast<void*>(context.Rip);
+            if ( context.Rsp <= previous // Not moving up the stack
+                 || context.Rsp < stack_low || context.Rsp + 8 > stack_high )
+                break;
+            previous = context.Rsp;
+
+            DWORD64 image_base;
+            PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(context.Rip, &image_base, nullptr);
+            if ( function ) {
+                PVOID handler_data;
+                DWORD64 establisher_frame;
+                RtlVirtualUnwind(UNW_FLAG_NHANDLER, image_base, context.Rip, function,
+                                 &context, &handler_data, &establisher_frame, nullptr);
+            }
+            else { // Leaf function - the return address is on top of the stack
+                context.Rip = *reinterpret_cast<DWORD64*>(context.Rsp);
+                context.Rsp += 8;
+            }
+        }
+    }
+
+    ResumeThread(thread);
+    return captured;
+#else
+    (void)thread; (void)stack_low; (void)stack_high; (void)frames; (void)depth;
+    return 0; // Unwinding only implemented for x64
+#endif
+}
+
+// =====================================================================
+// Watchdog >> Implementations
+// =====================================================================
+inline Watchdog::Watchdog(): Watchdog(Options()) {}
+
+inline Watchdog::Watchdog(Options opt): _opt(std::move(opt)) {
+    if ( _opt.threshold.count() <= 0 || _opt.interval.count() <= 0 )
+        throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument),
+            "Watchdog: threshold and interval must be positive"
+        );
+
+    Thread::Options thread_opt;
+    thread_opt.name = "simply::watchdog";
+    thread_opt.priority = _opt.priority;
+    _thread = Thread(thread_opt, [this](){ _run(); });
+}
+
+inline Watchdog::~Watchdog() {
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+}
+
+inline void Watchdog::_run() {
+    std::unique_lock<Mutex> lock(_mutex);
+    while ( !_wake.wait_for(lock, _opt.interval, [this](){ return _stopping; }) ) {
+        lock.unlock();
+        _check();
+        lock.lock();
+    }
+}
+
+inline void Watchdog::_check() {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<_Stall> stalls;
+
+    {
+        std::lock_guard<Mutex> guard(_mutex);
+        stalls.reserve(_heartbeats.size()); // So no handle leaks on a throw
+        for ( Heartbeat* heartbeat: _heartbeats ) {
+            // Task first: seeing the task of a `begin` also shows its count
+            const char* task     = heartbeat->_task.load(std::memory_order_acquire);
+            const uint64_t count = heartbeat->_count.load(std::memory_order_relaxed);
+
+            if ( count != heartbeat->_seen_count ) {
+                heartbeat->_seen_count = count;
+                heartbeat->_seen_at    = now;
+                heartbeat->_reported   = false;
+                continue;
+            }
+            if ( !task || heartbeat->_reported || now - heartbeat->_seen_at < _opt.threshold )
+                continue;
+
+            heartbeat->_reported = true;
+            _Stall stall{
+                {
+                    heartbeat->_thread,
+                    task,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - heartbeat->_seen_at),
+                    {}
+                },
+                nullptr,
+                heartbeat->_stack_low,
+                heartbeat->_stack_high
+            };
+            // Own handle, still valid if the heartbeat goes once unlocked
+            if ( _opt.capture_stacks && heartbeat->_thread != this_thread::get_id()
+                 && stall.stack_low < stall.stack_high
+                 && !DuplicateHandle(GetCurrentProcess(), heartbeat->_handle, GetCurrentProcess(),
+                                     &stall.thread, 0, FALSE, DUPLICATE_SAME_ACCESS) )
+                stall.thread = nullptr;
+            stalls.push_back(std::move(stall));
+        }
+    }
+
+    // Outside the lock, so neither a hung capture nor reporting blocks
+    // heartbeats being made or destroyed
+    for ( _Stall& stall: stalls ) {
+        if ( stall.thread ) {
+            void* frames[_watchdog_stack_depth];
+            const size_t depth = _capture_stack(stall.thread, stall.stack_low, stall.stack_high,
+                                                frames, _watchdog_stack_depth);
+            CloseHandle(stall.thread);
+            stall.report.stack.assign(frames, frames + depth);
+        }
+    }
+    for ( const _Stall& stall: stalls ) {
+        if ( _opt.on_stall )
+            _opt.on_stall(stall.report);
+        else
+            write_report(std::cerr, stall.report);
+    }
+}
+
+inline void Watchdog::write_report(std::ostream& ost, const Report& report) {
+    ost << "Watchdog: thread " << report.thread << " stalled for "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(report.stalled).count()
+        << "ms in task \"" << report.task << "\"\n";
+    for ( void* address: report.stack ) {
+        ost << "    ";
+        _write_address(ost, address);
+        ost << '\n';
+    }
+}
+
+// =====================================================================
+// Heartbeat >> Implementations
+// =====================================================================
+inline Heartbeat::Heartbeat(Watchdog& watchdog):
+    _watchdog(watchdog),
+    _thread(this_thread::get_id()),
+    _handle(nullptr)
+{
+    if ( !DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &_handle,
+                          0, FALSE, DUPLICATE_SAME_ACCESS) )
+        throw std::system_error(GetLastError(), std::system_category());
+    _current_stack_limits(_stack_low, _stack_high);
+
+    try {
+        std::lock_guard<Mutex> guard(_watchdog._mutex);
+        _watchdog._heartbeats.push_back(this);
+    }
+    catch ( ... ) {
+        CloseHandle(_handle);
+        throw;
+    }
+}
+
+inline Heartbeat::~Heartbeat() {
+    {
+        std::lock_guard<Mutex> guard(_watchdog._mutex);
+        auto& heartbeats = _watchdog._heartbeats;
+        heartbeats.erase(std::find(heartbeats.begin(), heartbeats.end(), this));
+    }
+    CloseHandle(_handle);
+}
+
+inline void Heartbeat::begin(const char* task) noexcept {
+    _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _task.store(task, std::memory_order_release);
+}
+
+inline void Heartbeat::beat() noexcept {
+    _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline void Heartbeat::end() noexcept {
+    _task.store(nullptr, std::memory_order_release);
+}
+}
+
+#endif // SIMPLY_WATCHDOG_HPP_
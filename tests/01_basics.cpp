@@ -13,6 +13,8 @@
 #include <sstream>
 #include <system_error>
 #include <atomic>
+#include <chrono>
+#include <optional>
 
 TEST(ThreadIdBasics, ThreadIdComparison) {
     simply::Thread::id id1;
@@ -128,6 +130,146 @@ TEST(ThreadBasics, SetPriority) {
     }
 }
 
+TEST(ThreadBasics, SetAffinity) {
+    simply::Thread::Options opt;
+    bool executed = false;
+
+    opt.affinity = 1; // CPU 0 is always available
+    simply::Thread t1(opt, [&executed](){ executed = true; });
+    t1.join();
+    ASSERT_TRUE(executed);
+
+    opt.affinity = 0; // No CPUs
+    ASSERT_THROW(simply::Thread(opt, [](){}), std::system_error);
+}
+
+TEST(ThreadBasics, Stats) {
+    std::atomic<bool> stop = false;
+    simply::Thread t1([&stop](){
+        while ( !stop )
+            ;
+    });
+
+    simply::this_thread::sleep(50);
+    simply::Thread::Stats first = t1.stats();
+    simply::this_thread::sleep(50);
+    simply::Thread::Stats second = t1.stats();
+    stop = true;
+
+    EXPECT_GE(second.user_time, first.user_time);
+    EXPECT_GE(second.system_time, first.system_time);
+    if ( first.cycles && second.cycles ) {
+        EXPECT_GT(*first.cycles, 0u);
+        EXPECT_GT(*second.cycles, *first.cycles);
+    }
+
+    // Still available once the thread has finished, until joined
+    simply::this_thread::sleep(10);
+    simply::Thread::Stats last = t1.stats();
+    EXPECT_GE(last.user_time + last.system_time, second.user_time + second.system_time);
+    t1.join();
+
+    ASSERT_THROW((void)t1.stats(), std::system_error);
+    ASSERT_THROW((void)simply::Thread().stats(), std::system_error);
+}
+
+TEST(ThreadBasics, ThisThreadStats) {
+    auto start = std::chrono::steady_clock::now();
+    while ( std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50) )
+        ;
+
+    simply::Thread::Stats stats = simply::this_thread::stats();
+    EXPECT_GE(stats.user_time.count(), 0);
+    if ( stats.cycles ) {
+        EXPECT_GT(*stats.cycles, 0u);
+    }
+}
+
+TEST(ThreadBasics, Enumerate) {
+    auto find = [](simply::Thread::id id) -> std::optional<simply::Thread::Info> {
+        for ( auto& info: simply::Thread::enumerate() )
+            if ( info.id == id )
+                return info;
+        return std::nullopt;
+    };
+
+    simply::Thread::Options opt;
+    opt.name = "sleeper";
+    opt.affinity = 1;
+    const auto before = std::chrono::system_clock::now();
+    simply::Thread sleeper(opt, [](){ simply::this_thread::sleep(200); });
+    const auto sleeper_id = sleeper.get_id(); // Before it is joined by joiner
+
+    opt = simply::Thread::Options();
+    opt.name = std::string(40, 'x'); // Cut short
+    simply::Thread joiner(opt, [&sleeper](){ sleeper.join(); });
+    const auto joiner_id = joiner.get_id();
+
+    simply::this_thread::sleep(50);
+    auto sleeping = find(sleeper_id);
+    ASSERT_TRUE(sleeping.has_value());
+    EXPECT_EQ(sleeping->name, "sleeper");
+    EXPECT_EQ(sleeping->affinity, std::optional<uint64_t>(1));
+    EXPECT_EQ(sleeping->state, simply::Thread::Info::State::SLEEPING);
+    EXPECT_FALSE(sleeping->waiting_on.has_value());
+    EXPECT_GE(sleeping->started, before - std::chrono::seconds(1)); // Leeway for clock adjustments
+    EXPECT_TRUE(sleeping->priority.has_value());
+    EXPECT_TRUE(sleeping->stats.has_value());
+
+    auto joining = find(joiner_id);
+    ASSERT_TRUE(joining.has_value());
+    EXPECT_EQ(joining->name, std::string(31, 'x'));
+    EXPECT_FALSE(joining->affinity.has_value());
+    EXPECT_EQ(joining->state, simply::Thread::Info::State::JOINING);
+    EXPECT_EQ(joining->waiting_on, std::optional<simply::Thread::id>(sleeper_id));
+
+    // Not listed: this thread, and threads which have finished
+    EXPECT_FALSE(find(simply::this_thread::get_id()).has_value());
+    joiner.join();
+    EXPECT_FALSE(find(sleeper_id).has_value());
+    EXPECT_FALSE(find(joiner_id).has_value());
+}
+
+namespace {
+// Touches about depth * 4KB of stack
+size_t use_stack(size_t depth) {
+    volatile char buffer[4096];
+    buffer[0] = static_cast<char>(depth);
+    if ( depth == 0 )
+        return buffer[0];
+    return use_stack(depth - 1) + buffer[0];
+}
+}
+
+TEST(ThreadBasics, StackHighWater) {
+    constexpr size_t used = 256 * 1024;
+    std::atomic<bool> stop = false;
+    size_t before = 0, after = 0;
+
+    simply::Thread::Options opt;
+    opt.stack_size = 4 * 1024 * 1024;
+    simply::Thread t1(opt, [&](){
+        before = simply::this_thread::stack_high_water();
+        (void)use_stack(used / 4096);
+        after = simply::this_thread::stack_high_water();
+        while ( !stop )
+            simply::this_thread::sleep(1);
+    });
+
+    simply::this_thread::sleep(50);
+    auto high_water = t1.stack_high_water();
+    stop = true;
+
+    EXPECT_GT(before, 0u);
+    EXPECT_GE(after, before + used);
+    EXPECT_LT(after, opt.stack_size.value());
+    ASSERT_TRUE(high_water.has_value());
+    EXPECT_GE(*high_water, after);
+
+    t1.join();
+    ASSERT_THROW((void)t1.stack_high_water(), std::system_error);
+}
+
 TEST(ThreadBasics, ThreadDetach) {
     std::atomic<int> counter = 0;
     simply::Thread t1([&counter](){
@@ -151,6 +293,56 @@ TEST(ThreadBasics, ThreadTimeout) {
     EXPECT_TRUE(t2.join(100));
 }
 
+TEST(ThreadBasics, JoinTimeoutTooLong) {
+    if ( SIZE_MAX <= MAXDWORD )
+        GTEST_SKIP() << "size_t cannot exceed MAXDWORD";
+
+    simply::Thread sleeper([](){ simply::this_thread::sleep(100); });
+    std::atomic<bool> threw = false, stop = false;
+    simply::Thread joiner([&](){
+        try {
+            (void)sleeper.join(static_cast<size_t>(MAXDWORD) + 1);
+        }
+        catch ( const std::system_error& ) {
+            threw = true;
+        }
+        while ( !stop )
+            simply::this_thread::yield(); // Sleeping would change the state
+    });
+    const auto joiner_id = joiner.get_id();
+
+    simply::this_thread::sleep(50);
+    std::optional<simply::Thread::Info::State> state;
+    for ( auto& info: simply::Thread::enumerate() )
+        if ( info.id == joiner_id )
+            state = info.state;
+    stop = true;
+    joiner.join();
+
+    EXPECT_TRUE(threw);
+    EXPECT_EQ(state, std::optional(simply::Thread::Info::State::RUNNING)); // Never left joining
+    EXPECT_TRUE(sleeper.joinable());
+}
+
+TEST(ThreadBasics, SleepFor) {
+    auto start = std::chrono::steady_clock::now();
+    simply::this_thread::sleep_for(std::chrono::microseconds(500));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_GE(elapsed, std::chrono::microseconds(500));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(20));
+}
+
+TEST(ThreadBasics, SleepUntil) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(3);
+    simply::this_thread::sleep_until(deadline);
+
+    ASSERT_GE(std::chrono::steady_clock::now(), deadline);
+
+    // Deadlines in the past return immediately
+    simply::this_thread::sleep_until(deadline - std::chrono::seconds(1));
+}
+
 TEST(ThreadRAIIBasics, MoveConstructor) {
     bool executed = false;
     simply::Thread::id current;
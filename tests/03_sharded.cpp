@@ -0,0 +1,102 @@
+// Tests for simply/sharded.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/sharded.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <vector>
+#include <set>
+#include <system_error>
+
+TEST(ThreadIndex, StableWithinThread) {
+    ASSERT_EQ(simply::this_thread::get_index(), simply::this_thread::get_index());
+}
+
+TEST(ThreadIndex, UniqueAmongLiveThreads) {
+    constexpr size_t n_threads = 8;
+    std::atomic<size_t> started = 0;
+    std::vector<size_t> indices(n_threads);
+    std::vector<simply::Thread> threads;
+
+    for ( size_t i = 0; i < n_threads; i++ )
+        threads.emplace_back([&started, &indices, i](){
+            indices[i] = simply::this_thread::get_index();
+            started++;
+            while ( started < n_threads )
+                simply::this_thread::sleep(1);
+        });
+
+    for ( auto& t: threads )
+        t.join();
+
+    std::set<size_t> unique(indices.begin(), indices.end());
+    unique.insert(simply::this_thread::get_index());
+    ASSERT_EQ(unique.size(), n_threads + 1);
+}
+
+TEST(ShardedCounter, SumsAcrossThreads) {
+    simply::ShardedCounter counter;
+    std::vector<simply::Thread> threads;
+
+    for ( int i = 0; i < 4; i++ )
+        threads.emplace_back([&counter](){
+            for ( int j = 0; j < 10000; j++ )
+                counter.add();
+        });
+
+    for ( auto& t: threads )
+        t.join();
+
+    ASSERT_EQ(counter.read(), 40000);
+
+    counter.add(-40000);
+    ASSERT_EQ(counter.read(), 0);
+
+    counter.add(5);
+    counter.reset();
+    ASSERT_EQ(counter.read(), 0);
+}
+
+TEST(ShardedMax, MaxAcrossThreads) {
+    simply::ShardedMax highest(4);
+
+    ASSERT_EQ(highest.read(), std::numeric_limits<int64_t>::min());
+
+    {
+        simply::Thread t1([&highest](){ highest.update(10); highest.update(3); });
+        simply::Thread t2([&highest](){ highest.update(-5); highest.update(7); });
+    }
+
+    ASSERT_EQ(highest.read(), 10);
+
+    highest.reset();
+    ASSERT_EQ(highest.read(), std::numeric_limits<int64_t>::min());
+}
+
+TEST(ShardedHistogram, Buckets) {
+    simply::ShardedHistogram histogram({10, 100});
+
+    ASSERT_EQ(histogram.bounds().size(), 2);
+
+    {
+        simply::Thread t1([&histogram](){ histogram.record(5); histogram.record(10); });
+        simply::Thread t2([&histogram](){ histogram.record(50); histogram.record(1000); });
+    }
+
+    std::vector<uint64_t> counts = histogram.read();
+    ASSERT_EQ(counts.size(), 3);
+    ASSERT_EQ(counts[0], 2);
+    ASSERT_EQ(counts[1], 1);
+    ASSERT_EQ(counts[2], 1);
+    ASSERT_EQ(histogram.count(), 4);
+    ASSERT_EQ(histogram.sum(), 1065);
+
+    histogram.reset();
+    ASSERT_EQ(histogram.count(), 0);
+}
+
+TEST(ShardedHistogram, UnsortedBounds) {
+    ASSERT_THROW(simply::ShardedHistogram({100, 10}), std::system_error);
+}
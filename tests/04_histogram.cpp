@@ -0,0 +1,112 @@
+// Tests for simply/histogram.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/histogram.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <vector>
+#include <limits>
+#include <system_error>
+
+TEST(LatencyHistogram, Empty) {
+    simply::LatencyHistogram histogram;
+    auto snapshot = histogram.snapshot();
+
+    ASSERT_EQ(snapshot.count(), 0);
+    ASSERT_EQ(snapshot.min(), 0);
+    ASSERT_EQ(snapshot.max(), 0);
+    ASSERT_EQ(snapshot.percentile(50), 0);
+}
+
+TEST(LatencyHistogram, SmallValuesExact) {
+    simply::LatencyHistogram histogram(5);
+
+    for ( int64_t i = 1; i <= 20; i++ )
+        histogram.record(i);
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(snapshot.count(), 20);
+    ASSERT_EQ(snapshot.min(), 1);
+    ASSERT_EQ(snapshot.max(), 20);
+    ASSERT_EQ(snapshot.percentile(50), 10);
+    ASSERT_EQ(snapshot.percentile(100), 20);
+    ASSERT_DOUBLE_EQ(snapshot.mean(), 10.5);
+}
+
+TEST(LatencyHistogram, RelativeError) {
+    simply::LatencyHistogram histogram(5);
+
+    int64_t values[] = {1000, 123456, 98765432, 5000000000};
+    for ( int64_t value: values ) {
+        histogram.reset();
+        histogram.record(value);
+        auto snapshot = histogram.snapshot();
+
+        int64_t lowest = snapshot.min();
+        ASSERT_LE(lowest, value);
+        ASSERT_GE(static_cast<double>(lowest), value * (1.0 - 1.0 / 32));
+        ASSERT_EQ(snapshot.percentile(50), value); // Capped at max
+    }
+}
+
+TEST(LatencyHistogram, BucketsContiguous) {
+    simply::LatencyHistogram::Snapshot snapshot(3);
+
+    for ( size_t i = 1; i < snapshot.counts().size(); i++ )
+        ASSERT_EQ(snapshot.lowest(i), snapshot.highest(i - 1) + 1);
+    ASSERT_EQ(snapshot.highest(snapshot.counts().size() - 1), simply::LatencyHistogram::max_value);
+}
+
+TEST(LatencyHistogram, Clamped) {
+    simply::LatencyHistogram histogram;
+    histogram.record(-5);
+    histogram.record(std::numeric_limits<int64_t>::max());
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(snapshot.count(), 2);
+    ASSERT_EQ(snapshot.min(), 0);
+    ASSERT_EQ(snapshot.max(), simply::LatencyHistogram::max_value);
+}
+
+TEST(LatencyHistogram, RecordFromThreads) {
+    simply::LatencyHistogram histogram;
+    std::vector<simply::Thread> threads;
+
+    for ( int i = 0; i < 4; i++ )
+        threads.emplace_back([&histogram](){
+            for ( int j = 0; j < 1000; j++ )
+                histogram.record(std::chrono::microseconds(j));
+        });
+
+    for ( auto& t: threads )
+        t.join();
+
+    auto snapshot = histogram.snapshot();
+    ASSERT_EQ(snapshot.count(), 4000);
+    ASSERT_EQ(snapshot.max(), 999000);
+    EXPECT_NEAR(static_cast<double>(snapshot.percentile(50)), 500000, 500000 / 32.0);
+}
+
+TEST(LatencyHistogram, Merge) {
+    simply::LatencyHistogram a, b;
+    a.record(10);
+    b.record(20);
+    b.record(30);
+
+    auto merged = a.snapshot();
+    merged.merge(b.snapshot());
+
+    ASSERT_EQ(merged.count(), 3);
+    ASSERT_EQ(merged.max(), 30);
+    ASSERT_EQ(merged.min(), 10);
+
+    simply::LatencyHistogram::Snapshot other(6);
+    ASSERT_THROW(merged.merge(other), std::system_error);
+}
+
+TEST(LatencyHistogram, InvalidPrecision) {
+    ASSERT_THROW(simply::LatencyHistogram(0), std::system_error);
+    ASSERT_THROW(simply::LatencyHistogram(11), std::system_error);
+}
@@ -0,0 +1,76 @@
+// Tests for simply/bag.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/bag.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <set>
+
+TEST(ConcurrentBag, AddTake) {
+    simply::ConcurrentBag<int> bag;
+
+    ASSERT_TRUE(bag.empty());
+    ASSERT_FALSE(bag.try_take().has_value());
+
+    bag.add(1);
+    bag.emplace(2);
+
+    ASSERT_EQ(bag.size(), 2);
+    ASSERT_EQ(bag.try_take(), 2); // Own list is LIFO
+    ASSERT_EQ(bag.try_take(), 1);
+    ASSERT_TRUE(bag.empty());
+}
+
+TEST(ConcurrentBag, MoveOnly) {
+    simply::ConcurrentBag<std::unique_ptr<int>> bag;
+
+    bag.add(std::make_unique<int>(5));
+    auto item = bag.try_take();
+
+    ASSERT_TRUE(item.has_value());
+    ASSERT_EQ(**item, 5);
+}
+
+TEST(ConcurrentBag, StealFromOtherThread) {
+    simply::ConcurrentBag<int> bag;
+
+    simply::Thread t([&bag](){
+        for ( int i = 0; i < 100; i++ )
+            bag.add(i);
+    });
+    t.join();
+
+    std::set<int> taken;
+    while ( auto item = bag.try_take() )
+        taken.insert(*item);
+
+    ASSERT_EQ(taken.size(), 100);
+    ASSERT_TRUE(bag.empty());
+}
+
+TEST(ConcurrentBag, ConcurrentAddTake) {
+    simply::ConcurrentBag<int> bag;
+    std::atomic<int> taken = 0;
+    std::vector<simply::Thread> threads;
+
+    for ( int i = 0; i < 4; i++ )
+        threads.emplace_back([&bag, &taken](){
+            for ( int j = 0; j < 10000; j++ ) {
+                bag.add(j);
+                if ( bag.try_take() )
+                    taken++;
+            }
+        });
+
+    for ( auto& t: threads )
+        t.join();
+
+    while ( bag.try_take() )
+        taken++;
+
+    ASSERT_EQ(taken, 40000);
+}
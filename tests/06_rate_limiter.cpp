@@ -0,0 +1,82 @@
+// Tests for simply/rate_limiter.h
+// Uses Google Test framework
+//
+// Note - Timing tests use EXPECT where fragile, see 01_basics.cpp
+
+#include <simply/concurrency.h>
+#include <simply/rate_limiter.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <system_error>
+
+TEST(RateLimiter, Burst) {
+    simply::RateLimiter limiter(10.0, 5);
+
+    for ( int i = 0; i < 5; i++ )
+        ASSERT_TRUE(limiter.try_acquire());
+    ASSERT_FALSE(limiter.try_acquire());
+}
+
+TEST(RateLimiter, MultipleTokens) {
+    simply::RateLimiter limiter(10.0, 5);
+
+    ASSERT_TRUE(limiter.try_acquire(3));
+    ASSERT_FALSE(limiter.try_acquire(3));
+    ASSERT_TRUE(limiter.try_acquire(2));
+    ASSERT_THROW((void)limiter.try_acquire(6), std::system_error);
+}
+
+TEST(RateLimiter, Refills) {
+    simply::RateLimiter limiter(1000.0, 1);
+
+    ASSERT_TRUE(limiter.try_acquire());
+    ASSERT_FALSE(limiter.try_acquire());
+    simply::this_thread::sleep(5);
+    ASSERT_TRUE(limiter.try_acquire());
+}
+
+TEST(RateLimiter, AcquireWaits) {
+    simply::RateLimiter limiter(1000.0, 1);
+
+    auto start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < 21; i++ )
+        limiter.acquire();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_GE(elapsed, std::chrono::milliseconds(20));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(40));
+}
+
+TEST(RateLimiter, SharedBetweenThreads) {
+    simply::RateLimiter limiter(1.0, 100);
+    std::atomic<int> acquired = 0;
+    std::vector<simply::Thread> threads;
+
+    for ( int i = 0; i < 4; i++ )
+        threads.emplace_back([&limiter, &acquired](){
+            for ( int j = 0; j < 100; j++ )
+                if ( limiter.try_acquire() )
+                    acquired++;
+        });
+
+    for ( auto& t: threads )
+        t.join();
+
+    ASSERT_EQ(acquired, 100);
+}
+
+TEST(RateLimiter, InvalidArguments) {
+    ASSERT_THROW(simply::RateLimiter(0.0), std::system_error);
+    ASSERT_THROW(simply::RateLimiter(1.0, 0), std::system_error);
+
+    // Spans which would overflow nanoseconds
+    ASSERT_THROW(simply::RateLimiter(1e-12), std::system_error);
+    ASSERT_THROW(simply::RateLimiter(1.0, std::numeric_limits<size_t>::max()), std::system_error);
+    ASSERT_THROW(simply::RateLimiter(1e-9, 3), std::system_error);
+    ASSERT_NO_THROW(simply::RateLimiter(1e-9, 2));   // 2 tokens in 63 years
+    ASSERT_NO_THROW(simply::RateLimiter(std::numeric_limits<double>::infinity(), 1000));
+}
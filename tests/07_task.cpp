@@ -0,0 +1,105 @@
+// Tests for simply/task.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/task.h>
+#include "gtest/gtest.h"
+
+#include <array>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+
+static_assert(sizeof(simply::Task) == 64, "Task should fill a single cache line");
+
+TEST(Task, Empty) {
+    simply::Task task;
+
+    ASSERT_FALSE(task);
+    ASSERT_THROW(task(), std::system_error);
+
+    simply::Task null_task = nullptr;
+    ASSERT_FALSE(null_task);
+}
+
+TEST(Task, CallsLambda) {
+    int value = 0;
+    simply::Task task([&value](){ value = 5; });
+
+    ASSERT_TRUE(task);
+    task();
+    ASSERT_EQ(value, 5);
+}
+
+TEST(Task, BindsArguments) {
+    int value = 0;
+    auto add = [](int& out, int a, std::string b) { out = a + static_cast<int>(b.size()); };
+
+    simply::Task task(add, std::ref(value), 2, std::string("abc"));
+    task();
+    ASSERT_EQ(value, 5);
+}
+
+TEST(Task, MoveOnlyCapture) {
+    std::promise<int> promise;
+    auto future = promise.get_future();
+
+    simply::Task task([p = std::move(promise)]() mutable { p.set_value(7); });
+    simply::Task moved(std::move(task));
+
+    ASSERT_FALSE(task);
+    moved();
+    ASSERT_EQ(future.get(), 7);
+}
+
+TEST(Task, InlineOrHeap) {
+    std::array<char, simply::Task::inline_size> fits{};
+    std::array<char, simply::Task::inline_size + 1> spills{};
+
+    auto small = [fits](){ (void)fits; };
+    auto large = [spills](){ (void)spills; };
+
+    static_assert(simply::Task::stores_inline<decltype(small)>);
+    static_assert(!simply::Task::stores_inline<decltype(large)>);
+
+    int calls = 0;
+    simply::Task a([large, &calls](){ (void)large; calls++; });
+    simply::Task b(std::move(a));
+    b();
+    ASSERT_EQ(calls, 1);
+}
+
+TEST(Task, DestroysCallable) {
+    auto counter = std::make_shared<int>(0);
+    {
+        simply::Task task([counter](){});
+        ASSERT_EQ(counter.use_count(), 2);
+
+        simply::Task other;
+        other = std::move(task);
+        ASSERT_EQ(counter.use_count(), 2);
+    }
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+TEST(Task, Swap) {
+    int value = 0;
+    simply::Task a([&value](){ value = 1; });
+    simply::Task b([&value](){ value = 2; });
+
+    a.swap(b);
+    a();
+    ASSERT_EQ(value, 2);
+    b();
+    ASSERT_EQ(value, 1);
+}
+
+TEST(Task, RunOnThread) {
+    int value = 0;
+    simply::Task task([&value](){ value = 3; });
+
+    simply::Thread t(std::move(task));
+    t.join();
+    ASSERT_EQ(value, 3);
+}
@@ -0,0 +1,96 @@
+// Tests for simply/trace.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/task.h>
+#include <simply/trace.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+namespace {
+std::string trace_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+size_t count(const std::string& text, const std::string& part) {
+    size_t found = 0;
+    for ( size_t pos = text.find(part); pos != std::string::npos; pos = text.find(part, pos + 1) )
+        found++;
+    return found;
+}
+}
+
+TEST(Trace, DisabledRecordsNothing) {
+    ASSERT_FALSE(simply::trace::enabled());
+    simply::trace::Span span("ignored");
+    simply::trace::instant("ignored");
+    simply::trace::stop(); // No trace running - does nothing
+}
+
+TEST(Trace, RecordsLifecycles) {
+    const std::string path = trace_path("simply_trace_lifecycles.json");
+    simply::trace::start(path, std::chrono::milliseconds(5));
+    ASSERT_TRUE(simply::trace::enabled());
+
+    simply::Thread t1([](){
+        simply::trace::Span span("work");
+        simply::trace::instant("marker");
+        simply::this_thread::sleep(1);
+        simply::Task([](){})();
+    });
+    t1.join();
+
+    simply::trace::stop();
+    ASSERT_FALSE(simply::trace::enabled());
+
+    const std::string json = read_file(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(json.rfind("{\"traceEvents\": [", 0), 0u);
+    EXPECT_NE(json.find("]}"), std::string::npos);
+
+    for ( const char* name: {"thread", "work", "sleep", "task", "join"} ) {
+        const std::string quoted = std::string("\"name\": \"") + name + "\", \"ph\": \"";
+        EXPECT_EQ(count(json, quoted + "B\""), 1u) << name;
+        EXPECT_EQ(count(json, quoted + "E\""), 1u) << name;
+    }
+    EXPECT_EQ(count(json, "\"name\": \"marker\", \"ph\": \"i\""), 1u);
+    EXPECT_EQ(simply::trace::dropped(), 0u);
+}
+
+TEST(Trace, StartTwiceThrows) {
+    const std::string path = trace_path("simply_trace_twice.json");
+    simply::trace::start(path);
+    ASSERT_THROW(simply::trace::start(path), std::system_error);
+    simply::trace::stop();
+    std::remove(path.c_str());
+}
+
+TEST(Trace, DroppedWhenFull) {
+    const std::string path = trace_path("simply_trace_dropped.json");
+    simply::trace::start(path, std::chrono::milliseconds(1000));
+
+    simply::Thread t1([](){
+        for ( size_t i = 0; i < simply::trace::_Ring::capacity + 100; i++ )
+            simply::trace::instant("flood");
+    });
+    t1.join();
+
+    simply::trace::stop();
+    std::remove(path.c_str());
+    EXPECT_GE(simply::trace::dropped(), 100u);
+}
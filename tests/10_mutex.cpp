@@ -0,0 +1,101 @@
+// Tests for simply/mutex.h
+// Uses Google Test framework
+//
+// Note - Profiling is tested separately in 11_lock_profile.cpp, as it
+//        must be enabled for the whole program
+
+#include <simply/concurrency.h>
+#include <simply/mutex.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <vector>
+
+TEST(Mutex, ExclusiveAccess) {
+    simply::Mutex mutex;
+    int counter = 0;
+    std::vector<simply::Thread> threads;
+
+    for ( int i = 0; i < 4; i++ )
+        threads.emplace_back([&mutex, &counter](){
+            for ( int j = 0; j < 10000; j++ ) {
+                std::lock_guard<simply::Mutex> guard(mutex);
+                counter++;
+            }
+        });
+    threads.clear();
+
+    ASSERT_EQ(counter, 40000);
+}
+
+TEST(Mutex, TryLock) {
+    simply::Mutex mutex;
+
+    ASSERT_TRUE(mutex.try_lock());
+    simply::Thread t1([&mutex](){
+        EXPECT_FALSE(mutex.try_lock());
+    });
+    t1.join();
+    mutex.unlock();
+
+    std::unique_lock<simply::Mutex> lock(mutex, std::try_to_lock);
+    ASSERT_TRUE(lock.owns_lock());
+}
+
+TEST(SharedMutex, SharedAndExclusive) {
+    simply::SharedMutex mutex;
+
+    {
+        std::shared_lock<simply::SharedMutex> first(mutex);
+        ASSERT_TRUE(mutex.try_lock_shared()); // Readers share
+        mutex.unlock_shared();
+        ASSERT_FALSE(mutex.try_lock());       // Writers wait for readers
+    }
+
+    std::unique_lock<simply::SharedMutex> writing(mutex);
+    ASSERT_FALSE(mutex.try_lock_shared());
+}
+
+TEST(ConditionVariable, NotifyOne) {
+    simply::Mutex mutex;
+    simply::ConditionVariable cv;
+    bool ready = false;
+
+    simply::Thread t1([&](){
+        simply::this_thread::sleep(10);
+        std::lock_guard<simply::Mutex> guard(mutex);
+        ready = true;
+        cv.notify_one();
+    });
+
+    std::unique_lock<simply::Mutex> lock(mutex);
+    cv.wait(lock, [&](){ return ready; });
+    ASSERT_TRUE(ready);
+    ASSERT_TRUE(lock.owns_lock());
+}
+
+TEST(ConditionVariable, WaitForTimesOut) {
+    simply::Mutex mutex;
+    simply::ConditionVariable cv;
+
+    std::unique_lock<simply::Mutex> lock(mutex);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(cv.wait_for(lock, std::chrono::milliseconds(20), [](){ return false; }));
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    ASSERT_TRUE(lock.owns_lock());
+
+    lock.unlock();
+    ASSERT_THROW(cv.wait(lock), std::system_error);
+}
+
+TEST(LockProfile, CompiledOut) {
+    ASSERT_FALSE(simply::lock_profile::enabled);
+    ASSERT_TRUE(simply::lock_profile::sites().empty());
+
+    std::stringstream dump;
+    simply::lock_profile::dump(dump);
+    ASSERT_NE(dump.str().find("SIMPLY_PROFILE_LOCKS"), std::string::npos);
+}
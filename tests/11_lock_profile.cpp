@@ -0,0 +1,121 @@
+// Tests for lock contention profiling in simply/mutex.h
+// Uses Google Test framework
+//
+// Note - Profiling changes the layout of the lock classes, so it must
+//        be defined before any include, here for the whole test program
+
+#define SIMPLY_PROFILE_LOCKS
+
+#include <simply/concurrency.h>
+#include <simply/mutex.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+
+namespace {
+uint64_t total(char kind, uint64_t simply::lock_profile::Site::*field) {
+    uint64_t sum = 0;
+    for ( const auto& site: simply::lock_profile::sites() )
+        if ( site.kind == kind )
+            sum += site.*field;
+    return sum;
+}
+}
+
+TEST(LockProfile, CountsAcquisitions) {
+    simply::lock_profile::reset();
+    simply::Mutex mutex;
+
+    for ( int i = 0; i < 10; i++ ) {
+        std::lock_guard<simply::Mutex> guard(mutex);
+    }
+
+    ASSERT_TRUE(simply::lock_profile::enabled);
+    ASSERT_EQ(total('x', &simply::lock_profile::Site::acquisitions), 10u);
+    ASSERT_EQ(total('x', &simply::lock_profile::Site::contended), 0u);
+}
+
+TEST(LockProfile, ContentionAndHold) {
+    simply::lock_profile::reset();
+    simply::Mutex mutex;
+
+    std::unique_lock<simply::Mutex> held(mutex);
+    simply::Thread t1([&mutex](){
+        std::lock_guard<simply::Mutex> guard(mutex); // Waits for main
+    });
+    simply::this_thread::sleep(20);
+    held.unlock();
+    t1.join();
+
+    auto sites = simply::lock_profile::sites();
+    ASSERT_FALSE(sites.empty());
+
+    const auto& most_waited = sites.front(); // Sorted by total wait
+    EXPECT_EQ(most_waited.contended, 1u);
+    EXPECT_GE(most_waited.total_wait, std::chrono::milliseconds(15));
+    EXPECT_EQ(most_waited.max_wait, most_waited.total_wait);
+    EXPECT_FALSE(most_waited.stack.empty());
+
+    std::chrono::nanoseconds max_hold{0};
+    for ( const auto& site: sites )
+        max_hold = std::max(max_hold, site.max_hold);
+    EXPECT_GE(max_hold, std::chrono::milliseconds(15));
+}
+
+TEST(LockProfile, SharedAndConditionWaits) {
+    simply::lock_profile::reset();
+    simply::SharedMutex shared;
+    {
+        std::shared_lock<simply::SharedMutex> reading(shared);
+    }
+    EXPECT_EQ(total('s', &simply::lock_profile::Site::acquisitions), 1u);
+
+    simply::Mutex mutex;
+    simply::ConditionVariable cv;
+    std::unique_lock<simply::Mutex> lock(mutex);
+    (void)cv.wait_for(lock, std::chrono::milliseconds(5));
+    EXPECT_EQ(total('c', &simply::lock_profile::Site::contended), 1u);
+
+    // Held again after the wait, charged to where it was locked
+    simply::this_thread::sleep(20);
+    lock.unlock();
+    std::chrono::nanoseconds max_hold{0};
+    for ( const auto& site: simply::lock_profile::sites() ) {
+        if ( site.kind == 'c' ) {
+            EXPECT_EQ(site.total_hold.count(), 0);
+        }
+        if ( site.kind == 'x' )
+            max_hold = std::max(max_hold, site.max_hold);
+    }
+    EXPECT_GE(max_hold, std::chrono::milliseconds(15));
+}
+
+TEST(LockProfile, Fraction) {
+    simply::lock_profile::reset();
+    simply::lock_profile::set_fraction(0);
+    simply::Mutex mutex;
+    {
+        std::lock_guard<simply::Mutex> guard(mutex);
+    }
+    simply::lock_profile::set_fraction(1);
+
+    EXPECT_EQ(total('x', &simply::lock_profile::Site::acquisitions), 0u);
+}
+
+TEST(LockProfile, Dump) {
+    simply::Mutex mutex;
+    {
+        std::lock_guard<simply::Mutex> guard(mutex);
+    }
+
+    std::stringstream dump;
+    const auto flags = dump.flags();
+    simply::lock_profile::dump(dump);
+    ASSERT_NE(dump.str().find("acquisitions"), std::string::npos);
+    ASSERT_NE(dump.str().find("+0x"), std::string::npos);
+    EXPECT_EQ(dump.flags(), flags); // Left as the caller set them
+    EXPECT_EQ(dump.precision(), 6);
+}
@@ -0,0 +1,115 @@
+// Tests for simply/executor_metrics.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/executor_metrics.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using Clock = simply::ExecutorMetrics::Clock;
+
+TEST(ExecutorMetrics, PerWorkerCounts) {
+    simply::ExecutorMetrics metrics("pool", 2);
+
+    metrics.enqueued(3);
+    auto& first = metrics.worker(0);
+    auto& second = metrics.worker(1);
+
+    auto enqueued = Clock::now() - std::chrono::milliseconds(2);
+    first.task_finished(first.task_started(enqueued));
+    first.task_finished(first.task_started(enqueued));
+    second.steal(false);
+    second.steal(true);
+    second.task_finished(second.task_started(enqueued));
+
+    auto snapshot = metrics.snapshot();
+    ASSERT_EQ(snapshot.name, "pool");
+    ASSERT_EQ(snapshot.queue_depth, 0);
+    ASSERT_EQ(snapshot.workers.size(), 2u);
+    ASSERT_EQ(snapshot.workers[0].tasks, 2u);
+    ASSERT_EQ(snapshot.workers[1].tasks, 1u);
+    ASSERT_EQ(snapshot.workers[1].steals_attempted, 2u);
+    ASSERT_EQ(snapshot.workers[1].steals_succeeded, 1u);
+
+    ASSERT_EQ(snapshot.total.tasks, 3u);
+    ASSERT_EQ(snapshot.total.queue_latency.count(), 3u);
+    ASSERT_GE(snapshot.total.queue_latency.min(), 1'900'000);
+    ASSERT_EQ(snapshot.total.execution_time.count(), 3u);
+}
+
+TEST(ExecutorMetrics, QueueDepth) {
+    simply::ExecutorMetrics metrics("pool", 1);
+
+    metrics.enqueued(5);
+    metrics.dequeued(2);
+    (void)metrics.worker(0).task_started(Clock::now());
+    ASSERT_EQ(metrics.snapshot().queue_depth, 2);
+}
+
+TEST(ExecutorMetrics, Utilization) {
+    simply::ExecutorMetrics metrics("pool", 1);
+    auto& worker = metrics.worker(0);
+
+    worker.park();
+    simply::this_thread::sleep(20);
+    worker.unpark();
+    auto started = worker.task_started(Clock::now());
+    simply::this_thread::sleep(20);
+    worker.task_finished(started);
+
+    auto snapshot = metrics.snapshot();
+    ASSERT_EQ(snapshot.workers[0].parks, 1u);
+    ASSERT_EQ(snapshot.workers[0].unparks, 1u);
+    ASSERT_GE(snapshot.workers[0].idle, std::chrono::milliseconds(20));
+    ASSERT_GE(snapshot.workers[0].busy, std::chrono::milliseconds(20));
+    EXPECT_GT(snapshot.total.utilization(), 0.3);
+    EXPECT_LT(snapshot.total.utilization(), 0.7);
+}
+
+TEST(ExecutorMetrics, WorkersRecordConcurrently) {
+    simply::ExecutorMetrics metrics("pool", 4);
+    std::vector<simply::Thread> threads;
+
+    for ( size_t i = 0; i < 4; i++ )
+        threads.emplace_back([&metrics, i](){
+            auto& worker = metrics.worker(i);
+            for ( int j = 0; j < 1000; j++ ) {
+                metrics.enqueued();
+                worker.task_finished(worker.task_started(Clock::now()));
+            }
+        });
+    threads.clear();
+
+    auto snapshot = metrics.snapshot();
+    ASSERT_EQ(snapshot.total.tasks, 4000u);
+    ASSERT_EQ(snapshot.queue_depth, 0);
+}
+
+TEST(ExecutorMetrics, Prometheus) {
+    simply::ExecutorMetrics metrics("io \"pool\"", 2);
+    metrics.enqueued(4);
+    (void)metrics.worker(1).task_started(Clock::now());
+
+    std::stringstream text;
+    metrics.write_prometheus(text);
+    const std::string dump = text.str();
+
+    EXPECT_NE(dump.find("# TYPE simply_executor_queue_depth gauge"), std::string::npos);
+    EXPECT_NE(dump.find("simply_executor_queue_depth{pool=\"io \\\"pool\\\"\"} 3"), std::string::npos);
+    EXPECT_NE(dump.find("simply_executor_tasks_total{pool=\"io \\\"pool\\\"\",worker=\"1\"} 1"), std::string::npos);
+    EXPECT_NE(dump.find("simply_executor_queue_latency_seconds_count{pool=\"io \\\"pool\\\"\"} 1"), std::string::npos);
+    EXPECT_NE(dump.find("quantile=\"0.99\""), std::string::npos);
+}
+
+TEST(ExecutorMetrics, InvalidArguments) {
+    ASSERT_THROW(simply::ExecutorMetrics("pool", 0), std::system_error);
+    ASSERT_THROW(simply::ExecutorMetrics("pool", 1, 11), std::system_error);
+
+    simply::ExecutorMetrics metrics("pool", 1);
+    ASSERT_THROW((void)metrics.worker(1), std::system_error);
+}
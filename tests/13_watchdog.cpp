@@ -0,0 +1,111 @@
+// Tests for simply/watchdog.h
+// Uses Google Test framework
+//
+// Note - Timing tests use EXPECT where fragile, see 01_basics.cpp
+
+#include <simply/concurrency.h>
+#include <simply/watchdog.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+struct Collected {
+    simply::Mutex mutex;
+    std::vector<simply::Watchdog::Report> reports;
+
+    std::vector<simply::Watchdog::Report> get() {
+        std::lock_guard<simply::Mutex> guard(mutex);
+        return reports;
+    }
+};
+
+simply::Watchdog::Options collect_into(Collected& collected) {
+    simply::Watchdog::Options opt;
+    opt.threshold = std::chrono::milliseconds(50);
+    opt.interval  = std::chrono::milliseconds(5);
+    opt.on_stall  = [&collected](const simply::Watchdog::Report& report){
+        std::lock_guard<simply::Mutex> guard(collected.mutex);
+        collected.reports.push_back(report);
+    };
+    return opt;
+}
+}
+
+TEST(Watchdog, ReportsStalledTask) {
+    Collected collected;
+    simply::Watchdog watchdog(collect_into(collected));
+    simply::Thread::id worker_id;
+
+    simply::Thread worker([&](){
+        simply::Heartbeat heartbeat(watchdog);
+        heartbeat.begin("stuck");
+        simply::this_thread::sleep(200);
+        heartbeat.end();
+    });
+    worker_id = worker.get_id();
+    worker.join();
+
+    auto reports = collected.get();
+    ASSERT_EQ(reports.size(), 1u); // Only once per stall
+    EXPECT_EQ(reports[0].thread, worker_id);
+    EXPECT_EQ(std::string(reports[0].task), "stuck");
+    EXPECT_GE(reports[0].stalled, std::chrono::milliseconds(50));
+}
+
+TEST(Watchdog, IdleAndBeatingNotReported) {
+    Collected collected;
+    simply::Watchdog watchdog(collect_into(collected));
+
+    simply::Thread worker([&](){
+        simply::Heartbeat heartbeat(watchdog);
+        simply::this_thread::sleep(150); // Idle
+
+        heartbeat.begin("long");
+        for ( int i = 0; i < 15; i++ ) {
+            simply::this_thread::sleep(10);
+            heartbeat.beat();
+        }
+        heartbeat.end();
+    });
+    worker.join();
+
+    EXPECT_TRUE(collected.get().empty());
+}
+
+TEST(Watchdog, BeginAfterIdleNotReported) {
+    Collected collected;
+    simply::Watchdog watchdog(collect_into(collected));
+
+    simply::Thread worker([&](){
+        simply::Heartbeat heartbeat(watchdog);
+        for ( int i = 0; i < 5; i++ ) {
+            simply::this_thread::sleep(70); // Idle past the threshold
+            heartbeat.begin("short");
+            simply::this_thread::sleep(10);
+            heartbeat.end();
+        }
+    });
+    worker.join();
+
+    EXPECT_TRUE(collected.get().empty());
+}
+
+TEST(Watchdog, WriteReport) {
+    simply::Watchdog::Report report{simply::this_thread::get_id(), "task", std::chrono::milliseconds(1500), {}};
+
+    std::stringstream text;
+    simply::Watchdog::write_report(text, report);
+    ASSERT_NE(text.str().find("stalled for 1500ms in task \"task\""), std::string::npos);
+}
+
+TEST(Watchdog, InvalidOptions) {
+    simply::Watchdog::Options opt;
+    opt.interval = std::chrono::milliseconds(0);
+    ASSERT_THROW(simply::Watchdog{opt}, std::system_error);
+}
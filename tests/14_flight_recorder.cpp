@@ -0,0 +1,124 @@
+// Tests for simply/flight_recorder.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/flight_recorder.h>
+#include <simply/mutex.h>
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+uint32_t number(simply::Thread::id id) {
+    std::stringstream text;
+    text << id;
+    return static_cast<uint32_t>(std::stoul(text.str()));
+}
+
+// Records of a thread since the given time, oldest first
+std::vector<simply::flight_recorder::Record> records_of(uint32_t thread, int64_t since) {
+    std::vector<simply::flight_recorder::Record> found;
+    for ( auto& record: simply::flight_recorder::snapshot() )
+        if ( record.thread == thread && record.time >= since )
+            found.push_back(record);
+    return found;
+}
+
+std::vector<std::string> events(const std::vector<simply::flight_recorder::Record>& records) {
+    std::vector<std::string> names;
+    for ( auto& record: records )
+        names.push_back(record.event);
+    return names;
+}
+}
+
+TEST(FlightRecorder, RecordsThreadEvents) {
+    simply::flight_recorder::enable();
+    ASSERT_TRUE(simply::flight_recorder::enabled());
+    const int64_t since = simply::flight_recorder::_now();
+
+    simply::Thread t1([](){ simply::this_thread::sleep(1); });
+    const uint32_t t1_id = number(t1.get_id());
+    t1.join();
+    simply::flight_recorder::disable();
+
+    auto own = records_of(number(simply::this_thread::get_id()), since);
+#if SIMPLY_C20plus // Joining requests a stop first
+    ASSERT_EQ(events(own), (std::vector<std::string>{"spawn", "stop request", "join begin", "join end"}));
+#else
+    ASSERT_EQ(events(own), (std::vector<std::string>{"spawn", "join begin", "join end"}));
+#endif
+    for ( auto& record: own )
+        EXPECT_EQ(record.detail, t1_id);
+
+    auto other = records_of(t1_id, since);
+    EXPECT_EQ(events(other), (std::vector<std::string>{"thread start", "sleep begin", "sleep end", "thread exit"}));
+}
+
+TEST(FlightRecorder, RecordsLockWaits) {
+    simply::Mutex mutex;
+    simply::flight_recorder::enable();
+    const int64_t since = simply::flight_recorder::_now();
+
+    mutex.lock();
+    simply::Thread t1([&mutex](){ std::lock_guard<simply::Mutex> guard(mutex); });
+    const uint32_t t1_id = number(t1.get_id());
+    simply::this_thread::sleep(50);
+    mutex.unlock();
+    t1.join();
+    simply::flight_recorder::disable();
+
+    auto other = records_of(t1_id, since);
+    ASSERT_EQ(events(other), (std::vector<std::string>{"thread start", "lock wait begin", "lock wait end", "thread exit"}));
+    EXPECT_EQ(other[1].detail, reinterpret_cast<uintptr_t>(&mutex));
+}
+
+TEST(FlightRecorder, KeepsNewest) {
+    simply::flight_recorder::enable();
+    const int64_t since = simply::flight_recorder::_now();
+    for ( int i = 0; i < 3000; i++ )
+        simply::this_thread::sleep(0);
+    simply::flight_recorder::disable();
+    simply::this_thread::sleep(0); // Not recorded
+
+    auto own = records_of(number(simply::this_thread::get_id()), since);
+    EXPECT_GE(own.size(), simply::flight_recorder::_Ring::capacity - 1);
+    EXPECT_LE(own.size(), simply::flight_recorder::_Ring::capacity);
+    EXPECT_EQ(std::string(own.back().event), "sleep end");
+}
+
+TEST(FlightRecorder, WriteAndLoad) {
+    simply::flight_recorder::enable();
+    simply::Thread([](){}).join();
+    simply::flight_recorder::disable();
+
+    const std::string path = (std::filesystem::temp_directory_path() / "flight_recorder_test.bin").string();
+    auto before = simply::flight_recorder::snapshot();
+    ASSERT_TRUE(simply::flight_recorder::write(path.c_str()));
+    auto loaded = simply::flight_recorder::load(path);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(loaded.size(), before.size());
+    for ( size_t i = 0; i < loaded.size(); i++ ) {
+        EXPECT_EQ(loaded[i].time, before[i].time);
+        EXPECT_EQ(loaded[i].thread, before[i].thread);
+        EXPECT_EQ(std::string(loaded[i].event), before[i].event);
+        EXPECT_EQ(loaded[i].detail, before[i].detail);
+    }
+
+    std::stringstream text;
+    const auto flags = text.flags();
+    simply::flight_recorder::dump(text);
+    EXPECT_NE(text.str().find("spawn"), std::string::npos);
+    EXPECT_EQ(text.flags(), flags); // Left as the caller set them
+    EXPECT_EQ(text.precision(), 6);
+
+    ASSERT_THROW((void)simply::flight_recorder::load("no_such_file.bin"), std::system_error);
+}
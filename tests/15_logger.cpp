@@ -0,0 +1,126 @@
+// Tests for simply/logger.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/logger.h>
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+std::vector<std::string> lines_of(const std::string& text) {
+    std::vector<std::string> lines;
+    std::stringstream stream(text);
+    std::string line;
+    while ( std::getline(stream, line) )
+        lines.push_back(line);
+    return lines;
+}
+
+// Message after the "date time [thread] " prefix
+std::string message_of(const std::string& line) {
+    const size_t end = line.find("] ");
+    return end == std::string::npos ? line : line.substr(end + 2);
+}
+
+enum class Color { RED = 3 };
+}
+
+TEST(AsyncLogger, FormatsArguments) {
+    std::stringstream out;
+    {
+        simply::AsyncLogger log(out);
+        const std::string name = "disk";
+        log.log("{} {} {} {} {} {} {}", -42, uint64_t(7), 1.5, true, 'x', name, Color::RED);
+        log.log("{} and {}", "literal", static_cast<const char*>(nullptr));
+        log.log("missing {} {}", 1);
+        log.log("extra", 1, 2);
+        log.flush();
+
+        auto lines = lines_of(out.str());
+        ASSERT_EQ(lines.size(), 4u);
+        EXPECT_EQ(message_of(lines[0]), "-42 7 1.5 true x disk 3");
+        EXPECT_EQ(message_of(lines[1]), "literal and (null)");
+        EXPECT_EQ(message_of(lines[2]), "missing 1 {}");
+        EXPECT_EQ(message_of(lines[3]), "extra");
+        EXPECT_EQ(lines[0].find('['), 27u); // "YYYY-MM-DD hh:mm:ss.uuuuuu ["
+    }
+}
+
+TEST(AsyncLogger, KeepsOrderPerThread) {
+    std::stringstream out;
+    constexpr int threads  = 4;
+    constexpr int messages = 5000;
+    {
+        simply::AsyncLogger::Options opt;
+        opt.ring_bytes = 4096; // Small, so producers must wait
+        opt.overflow   = simply::AsyncLogger::Overflow::BLOCK;
+        simply::AsyncLogger log(out, opt);
+
+        std::vector<simply::Thread> producers;
+        for ( int t = 0; t < threads; t++ )
+            producers.emplace_back([&log, t](){
+                for ( int i = 0; i < messages; i++ )
+                    log.log("{} {}", t, i);
+            });
+        for ( auto& producer: producers )
+            producer.join();
+        EXPECT_EQ(log.dropped(), 0u);
+    } // Destructor writes everything
+
+    auto lines = lines_of(out.str());
+    ASSERT_EQ(lines.size(), size_t(threads * messages));
+    std::vector<int> next(threads, 0);
+    for ( const auto& line: lines ) {
+        int t, i;
+        ASSERT_EQ(std::sscanf(message_of(line).c_str(), "%d %d", &t, &i), 2);
+        ASSERT_EQ(i, next[t]);
+        next[t]++;
+    }
+}
+
+TEST(AsyncLogger, Overflow) {
+    for ( auto overflow: {simply::AsyncLogger::Overflow::DROP, simply::AsyncLogger::Overflow::COUNT} ) {
+        std::stringstream out;
+        simply::AsyncLogger::Options opt;
+        opt.ring_bytes     = 1024;
+        opt.flush_interval = std::chrono::seconds(10); // Only on flush
+        opt.overflow       = overflow;
+        simply::AsyncLogger log(out, opt);
+
+        constexpr size_t messages = 1000;
+        for ( size_t i = 0; i < messages; i++ )
+            log.log("message {}", i);
+        log.flush();
+
+        auto lines = lines_of(out.str());
+        size_t written = 0;
+        bool reported  = false;
+        for ( const auto& line: lines ) {
+            if ( message_of(line) == "[" + std::to_string(log.dropped()) + " messages dropped]" )
+                reported = true;
+            else
+                written++;
+        }
+        EXPECT_GT(log.dropped(), 0u);
+        EXPECT_EQ(written + log.dropped(), messages);
+        EXPECT_EQ(reported, overflow == simply::AsyncLogger::Overflow::COUNT);
+    }
+}
+
+TEST(AsyncLogger, InvalidOptions) {
+    std::stringstream out;
+    simply::AsyncLogger::Options opt;
+    opt.ring_bytes = 3000;
+    EXPECT_THROW(simply::AsyncLogger(out, opt), std::system_error);
+    opt.ring_bytes = 512;
+    EXPECT_THROW(simply::AsyncLogger(out, opt), std::system_error);
+    opt = simply::AsyncLogger::Options();
+    opt.flush_interval = std::chrono::milliseconds(0);
+    EXPECT_THROW(simply::AsyncLogger(out, opt), std::system_error);
+}
@@ -0,0 +1,149 @@
+// Tests for simply/io_pool.h
+// Uses Google Test framework
+//
+// Note - Timing tests use EXPECT where fragile, see 01_basics.cpp
+
+#include <simply/concurrency.h>
+#include <simply/io_pool.h>
+#include <simply/watchdog.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+TEST(BlockingIoPool, ReturnsResults) {
+    simply::BlockingIoPool pool;
+    auto value = pool.offload([](){ return 42; });
+    auto text  = pool.offload([](){ return std::string("read"); });
+    auto none  = pool.offload([](){});
+    auto fails = pool.offload([]() -> int { throw std::runtime_error("disk"); });
+
+    // Move-only callables
+    auto owned = pool.offload([p = std::make_unique<int>(7)](){ return *p; });
+
+    EXPECT_EQ(value.get(), 42);
+    EXPECT_EQ(text.get(), "read");
+    none.get();
+    EXPECT_THROW(fails.get(), std::runtime_error);
+    EXPECT_EQ(owned.get(), 7);
+    EXPECT_NE(simply::this_thread::get_id(), pool.offload([](){
+        return simply::this_thread::get_id();
+    }).get());
+}
+
+TEST(BlockingIoPool, GrowsToMaxThreads) {
+    simply::BlockingIoPool::Options opt;
+    opt.max_threads = 4;
+    simply::BlockingIoPool pool(opt);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> running{0};
+
+    std::vector<std::future<void>> blocked;
+    for ( int i = 0; i < 6; i++ )
+        blocked.push_back(pool.offload([&running, released](){
+            running++;
+            released.wait();
+        }));
+
+    while ( running < 4 )
+        simply::this_thread::yield();
+    EXPECT_EQ(pool.threads(), 4u);
+    EXPECT_EQ(pool.metrics().snapshot().queue_depth, 2);   // Waiting for a free thread
+    EXPECT_EQ(running, 4);
+
+    release.set_value();
+    for ( auto& call: blocked )
+        call.get();
+    EXPECT_EQ(running, 6);
+
+    auto snapshot = pool.metrics().snapshot();
+    EXPECT_EQ(snapshot.queue_depth, 0);
+    EXPECT_EQ(snapshot.workers.size(), 4u);
+    EXPECT_EQ(snapshot.total.tasks, 6u);
+    EXPECT_EQ(snapshot.total.queue_latency.count(), 6u);
+    for ( const auto& worker: snapshot.workers )
+        EXPECT_GE(worker.tasks, 1u);
+}
+
+TEST(BlockingIoPool, ShrinksWhenIdle) {
+    simply::BlockingIoPool::Options opt;
+    opt.min_threads  = 1;
+    opt.max_threads  = 4;
+    opt.idle_timeout = std::chrono::milliseconds(20);
+    simply::BlockingIoPool pool(opt);
+
+    std::vector<std::future<void>> calls;
+    for ( int i = 0; i < 4; i++ )
+        calls.push_back(pool.offload([](){ simply::this_thread::sleep(30); }));
+    for ( auto& call: calls )
+        call.get();
+    EXPECT_EQ(pool.threads(), 4u);
+
+    simply::this_thread::sleep(300);
+    auto total = pool.metrics().snapshot().total;
+    EXPECT_EQ(pool.threads(), 1u);  // Down to min_threads
+    EXPECT_EQ(total.parks - total.unparks, 1u); // Idle
+    EXPECT_GT(total.idle.count(), 0);
+    EXPECT_EQ(pool.offload([](){ return 1; }).get(), 1);
+}
+
+TEST(BlockingIoPool, HeartbeatsWithWatchdog) {
+    simply::Mutex mutex;
+    std::vector<std::string> stalled;
+    simply::Watchdog::Options watch_opt;
+    watch_opt.threshold = std::chrono::milliseconds(50);
+    watch_opt.interval  = std::chrono::milliseconds(5);
+    watch_opt.on_stall  = [&](const simply::Watchdog::Report& report){
+        std::lock_guard<simply::Mutex> guard(mutex);
+        stalled.push_back(report.task);
+    };
+    simply::Watchdog watchdog(watch_opt);
+    {
+        simply::BlockingIoPool::Options opt;
+        opt.watchdog = &watchdog;
+        simply::BlockingIoPool pool(opt);
+        pool.offload([](){}).get();
+        simply::this_thread::sleep(150); // Idle, so never stalled
+        pool.offload([](){ simply::this_thread::sleep(200); }).get();
+    }
+
+    std::lock_guard<simply::Mutex> guard(mutex);
+    ASSERT_EQ(stalled.size(), 1u);
+    EXPECT_EQ(stalled[0], "BlockingIoPool call");
+}
+
+TEST(BlockingIoPool, DestructorFinishesCalls) {
+    std::atomic<int> done{0};
+    {
+        simply::BlockingIoPool::Options opt;
+        opt.max_threads = 2;
+        simply::BlockingIoPool pool(opt);
+        for ( int i = 0; i < 10; i++ )
+            (void)pool.offload([&done](){
+                simply::this_thread::sleep(2);
+                done++;
+            });
+    }
+    EXPECT_EQ(done, 10);
+}
+
+TEST(BlockingIoPool, InvalidOptions) {
+    simply::BlockingIoPool::Options opt;
+    opt.max_threads = 0;
+    EXPECT_THROW(simply::BlockingIoPool{opt}, std::system_error);
+    opt.max_threads = 2;
+    opt.min_threads = 3;
+    EXPECT_THROW(simply::BlockingIoPool{opt}, std::system_error);
+    opt.min_threads  = 0;
+    opt.idle_timeout = std::chrono::milliseconds(0);
+    EXPECT_THROW(simply::BlockingIoPool{opt}, std::system_error);
+}
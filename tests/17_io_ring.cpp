@@ -0,0 +1,171 @@
+// Tests for simply/io_ring.h
+// Uses Google Test framework
+//
+// Note - Timing tests use EXPECT where fragile, see 01_basics.cpp
+
+#include <simply/concurrency.h>
+#include <simply/io_ring.h>
+#include <simply/watchdog.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+// Temporary file opened for overlapped I/O, deleted afterwards
+struct TempFile {
+    std::string path;
+    HANDLE handle;
+
+    explicit TempFile(const char* name):
+        path((std::filesystem::temp_directory_path() / name).string()),
+        handle(CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                           CREATE_ALWAYS, FILE_FLAG_OVERLAPPED, nullptr))
+    {}
+
+    ~TempFile() {
+        if ( handle != INVALID_HANDLE_VALUE )
+            CloseHandle(handle);
+        std::remove(path.c_str());
+    }
+};
+}
+
+TEST(IoRing, WritesAndReads) {
+    TempFile file("io_ring_test.bin");
+    ASSERT_NE(file.handle, INVALID_HANDLE_VALUE);
+    simply::IoRing ring;
+    ring.attach(file.handle);
+
+    const std::string first = "hello, ";
+    const std::string second = "ring";
+    auto a = ring.write(file.handle, 0, first.data(), first.size());
+    auto b = ring.write(file.handle, first.size(), second.data(), second.size());
+    EXPECT_EQ(a.get(), first.size());
+    EXPECT_EQ(b.get(), second.size());
+    ring.flush(file.handle).get();
+
+    std::vector<char> buffer(64);
+    EXPECT_EQ(ring.read(file.handle, 0, buffer.data(), buffer.size()).get(), 11u);
+    EXPECT_EQ(std::string(buffer.data(), 11), "hello, ring");
+    EXPECT_EQ(ring.read(file.handle, 7, buffer.data(), 4).get(), 4u);
+    EXPECT_EQ(std::string(buffer.data(), 4), "ring");
+    EXPECT_EQ(ring.read(file.handle, 100, buffer.data(), buffer.size()).get(), 0u); // Past the end
+}
+
+TEST(IoRing, CallbacksOnReactor) {
+    TempFile file("io_ring_callbacks.bin");
+    ASSERT_NE(file.handle, INVALID_HANDLE_VALUE);
+
+    constexpr size_t count = 200;
+    std::vector<uint32_t> values(count);
+    std::atomic<size_t> written{0};
+    std::promise<simply::Thread::id> reactor;
+    {
+        simply::IoRing ring;
+        ring.attach(file.handle);
+        ring.post([&reactor](){ reactor.set_value(simply::this_thread::get_id()); });
+
+        for ( size_t i = 0; i < count; i++ ) {
+            values[i] = static_cast<uint32_t>(i);
+            ring.write(file.handle, i * 4, &values[i], 4, [&written](std::error_code error, size_t bytes){
+                if ( !error && bytes == 4 )
+                    written++;
+            });
+        }
+    } // Waits for all
+    EXPECT_EQ(written, count);
+    EXPECT_NE(reactor.get_future().get(), simply::this_thread::get_id());
+}
+
+TEST(IoRing, Timeouts) {
+    simply::IoRing ring;
+    std::vector<int> order;
+    simply::Mutex mutex;
+    auto record = [&](int n){
+        return [&, n](std::error_code, size_t){
+            std::lock_guard<simply::Mutex> guard(mutex);
+            order.push_back(n);
+        };
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    ring.after(std::chrono::milliseconds(60), record(3));
+    ring.after(std::chrono::milliseconds(20), record(1));
+    ring.after(std::chrono::milliseconds(40), record(2));
+    ring.after(std::chrono::milliseconds(80)).get();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(80));
+
+    std::lock_guard<simply::Mutex> guard(mutex);
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(IoRing, MetricsAndHeartbeat) {
+    simply::Mutex mutex;
+    std::vector<std::string> stalled;
+    simply::Watchdog::Options watch_opt;
+    watch_opt.threshold = std::chrono::milliseconds(50);
+    watch_opt.interval  = std::chrono::milliseconds(5);
+    watch_opt.on_stall  = [&](const simply::Watchdog::Report& report){
+        std::lock_guard<simply::Mutex> guard(mutex);
+        stalled.push_back(report.task);
+    };
+    simply::Watchdog watchdog(watch_opt);
+    {
+        simply::IoRing::Options opt;
+        opt.watchdog = &watchdog;
+        simply::IoRing ring(opt);
+        ring.after(std::chrono::milliseconds(30)).get();
+        std::promise<void> slept;
+        ring.post([&slept](){
+            simply::this_thread::sleep(200);
+            slept.set_value();
+        });
+        slept.get_future().get();
+        ring.after(std::chrono::milliseconds(0)).get(); // After the task is recorded
+
+        auto snapshot = ring.metrics().snapshot();
+        EXPECT_EQ(snapshot.queue_depth, 0);
+        EXPECT_GE(snapshot.total.tasks, 2u);
+        EXPECT_GE(snapshot.total.queue_latency.max(), 25000000); // The 30ms timeout, in ns
+        EXPECT_GE(snapshot.total.busy, std::chrono::milliseconds(200));
+        EXPECT_EQ(ring.flush_metrics().workers(), opt.flush_threads);
+    }
+
+    std::lock_guard<simply::Mutex> guard(mutex);
+    ASSERT_EQ(stalled.size(), 1u);
+    EXPECT_EQ(stalled[0], "IoRing task");
+}
+
+TEST(IoRing, DestructorCancelsTimeouts) {
+    std::atomic<bool> canceled{false};
+    const auto start = std::chrono::steady_clock::now();
+    {
+        simply::IoRing ring;
+        ring.after(std::chrono::hours(1), [&canceled](std::error_code error, size_t){
+            canceled = error.value() == ERROR_OPERATION_ABORTED;
+        });
+        EXPECT_EQ(ring.pending(), 1u);
+    }
+    EXPECT_TRUE(canceled);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST(IoRing, Errors) {
+    simply::IoRing ring;
+    std::vector<char> buffer(16);
+    auto read = ring.read(INVALID_HANDLE_VALUE, 0, buffer.data(), buffer.size());
+    EXPECT_THROW(read.get(), std::system_error);
+    EXPECT_THROW(ring.attach(INVALID_HANDLE_VALUE), std::system_error);
+
+    simply::IoRing::Options opt;
+    opt.batch = 0;
+    EXPECT_THROW(simply::IoRing{opt}, std::system_error);
+}
@@ -0,0 +1,167 @@
+// Tests for simply/loop_thread.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/loop_thread.h>
+#include <simply/watchdog.h>
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+TEST(LoopThread, RunsPostedTasksInOrder) {
+    std::vector<int> order;
+    simply::Thread::id ran_on;
+    simply::Thread::id loop_id;
+    {
+        simply::LoopThread loop;
+        loop_id = loop.get_id();
+        for ( int i = 0; i < 1000; i++ )
+            loop.post([&order, i](){ order.push_back(i); });
+        loop.post([&ran_on, &loop](){
+            ran_on = simply::this_thread::get_id();
+            EXPECT_TRUE(loop.in_loop());
+        });
+        EXPECT_FALSE(loop.in_loop());
+    } // Runs all before returning
+
+    ASSERT_EQ(order.size(), 1000u);
+    for ( int i = 0; i < 1000; i++ )
+        ASSERT_EQ(order[i], i);
+    EXPECT_EQ(ran_on, loop_id);
+    EXPECT_NE(ran_on, simply::this_thread::get_id());
+}
+
+TEST(LoopThread, Invoke) {
+    simply::LoopThread loop;
+    EXPECT_EQ(loop.invoke([](){ return 42; }), 42);
+    EXPECT_EQ(loop.invoke([](){ return simply::this_thread::get_id(); }), loop.get_id());
+    EXPECT_THROW(loop.invoke([]() -> int { throw std::runtime_error("device"); }), std::runtime_error);
+
+    // From the loop itself, runs directly instead of waiting on itself
+    EXPECT_EQ(loop.invoke([&loop](){
+        return loop.invoke([](){ return std::string("nested"); });
+    }), "nested");
+
+    // Many threads at once
+    std::atomic<int> sum{0};
+    std::vector<simply::Thread> threads;
+    for ( int t = 0; t < 4; t++ )
+        threads.emplace_back([&loop, &sum](){
+            for ( int i = 0; i < 100; i++ )
+                sum += loop.invoke([i](){ return i; });
+        });
+    for ( auto& thread: threads )
+        thread.join();
+    EXPECT_EQ(sum, 4 * 4950);
+}
+
+TEST(LoopThread, WatchesHandles) {
+    simply::LoopThread loop;
+    HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    ASSERT_NE(event, nullptr);
+
+    std::atomic<int> signalled{0};
+    loop.watch(event, [&signalled](){ signalled++; });
+    EXPECT_THROW(loop.watch(event, [](){}), std::system_error);
+
+    for ( int i = 1; i <= 3; i++ ) {
+        SetEvent(event);
+        while ( signalled < i )
+            simply::this_thread::yield();
+    }
+
+    loop.unwatch(event);
+    SetEvent(event);
+    loop.invoke([](){}); // A full turn of the loop
+    simply::this_thread::sleep(10);
+    EXPECT_EQ(signalled, 3);
+    loop.unwatch(event); // Not watched, ignored
+    CloseHandle(event);
+}
+TEST(LoopThread, UnwatchesClosedHandles) {
+    simply::LoopThread loop;
+    HANDLE closed = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    HANDLE open   = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    ASSERT_NE(closed, nullptr);
+    ASSERT_NE(open, nullptr);
+
+    std::atomic<int> signalled{0};
+    loop.watch(closed, [](){});
+    loop.watch(open, [&signalled](){ signalled++; });
+    CloseHandle(closed);
+
+    // The failed wait neither spins nor strands posted tasks
+    EXPECT_EQ(loop.invoke([](){ return 5; }), 5);
+    SetEvent(open);
+    while ( signalled < 1 )
+        simply::this_thread::yield();
+
+    loop.unwatch(open);
+    CloseHandle(open);
+}
+
+TEST(LoopThread, MetricsAndHeartbeat) {
+    simply::Mutex mutex;
+    std::vector<std::string> stalled;
+    simply::Watchdog::Options watch_opt;
+    watch_opt.threshold = std::chrono::milliseconds(50);
+    watch_opt.interval  = std::chrono::milliseconds(5);
+    watch_opt.on_stall  = [&](const simply::Watchdog::Report& report){
+        std::lock_guard<simply::Mutex> guard(mutex);
+        stalled.push_back(report.task);
+    };
+    simply::Watchdog watchdog(watch_opt);
+    {
+        simply::LoopThread::Options opt;
+        opt.name = "device";
+        opt.watchdog = &watchdog;
+        simply::LoopThread loop(opt);
+        HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        ASSERT_NE(event, nullptr);
+        std::atomic<int> signalled{0};
+        loop.watch(event, [&signalled](){ signalled++; });
+
+        for ( int i = 0; i < 100; i++ )
+            loop.post([](){});
+        SetEvent(event);
+        while ( signalled < 1 )
+            simply::this_thread::yield();
+        loop.invoke([](){ simply::this_thread::sleep(200); });
+        loop.unwatch(event);
+        CloseHandle(event);
+
+        auto snapshot = loop.metrics().snapshot();
+        EXPECT_EQ(snapshot.name, "device");
+        EXPECT_EQ(snapshot.queue_depth, 0); // The unwatch task has started
+        EXPECT_GE(snapshot.total.tasks, 102u); // Posted, the callback, watch and invoke
+        EXPECT_GE(snapshot.total.busy, std::chrono::milliseconds(200));
+        EXPECT_GT(snapshot.total.parks, 0u);
+    }
+
+    std::lock_guard<simply::Mutex> guard(mutex);
+    ASSERT_EQ(stalled.size(), 1u);
+    EXPECT_EQ(stalled[0], "LoopThread task");
+}
+
+TEST(LoopThread, WatchLimit) {
+    simply::LoopThread loop;
+    std::vector<HANDLE> events;
+    for ( int i = 0; i < MAXIMUM_WAIT_OBJECTS; i++ )
+        events.push_back(CreateEventW(nullptr, FALSE, FALSE, nullptr));
+
+    for ( int i = 0; i < MAXIMUM_WAIT_OBJECTS - 1; i++ )
+        loop.watch(events[i], [](){});
+    EXPECT_THROW(loop.watch(events.back(), [](){}), std::system_error);
+
+    for ( HANDLE event: events ) {
+        loop.unwatch(event);
+        CloseHandle(event);
+    }
+}
@@ -0,0 +1,107 @@
+// Tests for simply/parallel_read.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/parallel_read.h>
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+// Temporary file with the given content, deleted afterwards
+struct TempFile {
+    std::string path;
+
+    TempFile(const char* name, const std::string& content):
+        path((std::filesystem::temp_directory_path() / name).string())
+    {
+        std::ofstream(path, std::ios::binary) << content;
+    }
+
+    ~TempFile() {
+        std::remove(path.c_str());
+    }
+};
+
+std::string make_records(size_t count) {
+    std::string text;
+    for ( size_t i = 0; i < count; i++ )
+        text += "record " + std::to_string(i) + ",value\n";
+    return text;
+}
+}
+
+TEST(ParallelRead, ChunksInOrder) {
+    const std::string content = make_records(20000);
+    TempFile file("parallel_read_ordered.csv", content);
+
+    auto chunks = simply::parallel_read_chunks(file.path, 4096, '\n', [](std::string_view chunk){
+        return std::string(chunk);
+    });
+    ASSERT_GT(chunks.size(), 10u);
+
+    std::string joined;
+    for ( size_t i = 0; i < chunks.size(); i++ ) {
+        EXPECT_EQ(chunks[i].back(), '\n'); // Never splits a record
+        if ( i + 1 < chunks.size() ) {
+            EXPECT_GE(chunks[i].size(), 4096u);
+        }
+        joined += chunks[i];
+    }
+    EXPECT_EQ(joined, content);
+}
+
+TEST(ParallelRead, UnorderedMerge) {
+    TempFile file("parallel_read_unordered.csv", make_records(20000));
+
+    size_t lines = 0;
+    std::set<size_t> indices;
+    simply::parallel_read_chunks(file.path, 1000, '\n',
+        [](std::string_view chunk){
+            return static_cast<size_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+        },
+        [&](size_t index, size_t count){ // Never concurrent
+            lines += count;
+            indices.insert(index);
+        });
+    EXPECT_EQ(lines, 20000u);
+    ASSERT_FALSE(indices.empty());
+    EXPECT_EQ(*indices.rbegin(), indices.size() - 1); // Every chunk once
+}
+
+TEST(ParallelRead, LongRecordsAndNoDelimiter) {
+    const std::string content = std::string(10000, 'a') + "\nshort\n" + std::string(50, 'b');
+    TempFile file("parallel_read_long.txt", content);
+
+    auto chunks = simply::parallel_read_chunks(file.path, 100, '\n', [](std::string_view chunk){
+        return std::string(chunk);
+    });
+    ASSERT_EQ(chunks.size(), 2u);
+    EXPECT_EQ(chunks[0], std::string(10000, 'a') + "\n");
+    EXPECT_EQ(chunks[1], "short\n" + std::string(50, 'b')); // Ends with the file
+}
+
+TEST(ParallelRead, Errors) {
+    TempFile empty("parallel_read_empty.txt", "");
+    EXPECT_TRUE(simply::parallel_read_chunks(empty.path, 100, '\n', [](std::string_view){ return 1; }).empty());
+
+    EXPECT_THROW((void)simply::parallel_read_chunks("no_such_file.csv", 100, '\n',
+                                                    [](std::string_view){ return 1; }), std::system_error);
+
+    TempFile file("parallel_read_throws.csv", make_records(1000));
+    EXPECT_THROW((void)simply::parallel_read_chunks(file.path, 0, '\n',
+                                                    [](std::string_view){ return 1; }), std::system_error);
+    EXPECT_THROW(simply::parallel_read_chunks(file.path, 100, '\n', [](std::string_view chunk){
+        if ( chunk.find("record 500,") != std::string_view::npos )
+            throw std::runtime_error("bad record");
+    }), std::runtime_error);
+}
@@ -0,0 +1,69 @@
+// Tests for simply/parallel_memory.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/parallel_memory.h>
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+namespace {
+// Sizes around each threshold - small, parallel, non-temporal
+const std::vector<size_t> sizes = {
+    0, 1, 63, 64, 1000,
+    (size_t(1) << 20) + 3, (size_t(3) << 20) + 17,
+    (size_t(8) << 20) - 1, (size_t(9) << 20) + 13
+};
+
+std::vector<char> pattern(size_t size) {
+    std::vector<char> data(size);
+    for ( size_t i = 0; i < size; i++ )
+        data[i] = static_cast<char>(i * 31 + i / 251);
+    return data;
+}
+}
+
+TEST(ParallelMemory, Copies) {
+    for ( size_t size: sizes ) {
+        for ( size_t misalign: {0, 5} ) {
+            for ( unsigned threads: {0u, 1u, 3u} ) {
+                const std::vector<char> from = pattern(size + misalign);
+                std::vector<char> to(size + 2 * misalign + 1, 'x');
+
+                simply::parallel_memcpy(to.data() + misalign, from.data() + misalign, size, threads);
+                ASSERT_EQ(std::memcmp(to.data() + misalign, from.data() + misalign, size), 0)
+                    << "size " << size << ", misaligned by " << misalign << ", threads " << threads;
+                ASSERT_EQ(to[size + misalign], 'x'); // Nothing written past the end
+            }
+        }
+    }
+}
+
+TEST(ParallelMemory, Fills) {
+    for ( size_t size: sizes ) {
+        for ( size_t misalign: {0, 7} ) {
+            std::vector<unsigned char> data(size + 2 * misalign + 1, 1);
+            simply::parallel_memset(data.data() + misalign, 0x1AB, size); // Only the low byte
+
+            for ( size_t i = 0; i < data.size(); i++ ) {
+                const bool inside = i >= misalign && i < misalign + size;
+                ASSERT_EQ(data[i], inside ? 0xAB : 1) << "size " << size << ", at " << i;
+            }
+        }
+    }
+}
+
+TEST(ParallelMemory, Calibrate) {
+    EXPECT_GE(simply::parallel_memory_threads(), 1u);
+    EXPECT_LE(simply::parallel_memory_threads(), simply::Thread::hardware_concurrency());
+
+    const unsigned picked = simply::calibrate_parallel_memory(size_t(8) << 20);
+    EXPECT_GE(picked, 1u);
+    EXPECT_LE(picked, simply::Thread::hardware_concurrency());
+    EXPECT_EQ(simply::parallel_memory_threads(), picked);
+
+    EXPECT_THROW(simply::calibrate_parallel_memory(1024), std::system_error);
+}
@@ -0,0 +1,170 @@
+// Tests for simply/parallel_reduce.h
+// Uses Google Test framework
+
+#include <simply/concurrency.h>
+#include <simply/parallel_reduce.h>
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <vector>
+
+namespace {
+// Every kernel this CPU can run, and the portable one
+std::vector<simply::Simd> kernels() {
+    std::vector<simply::Simd> all;
+    for ( auto simd: {simply::Simd::AVX512, simply::Simd::AVX2, simply::Simd::SSE2, simply::Simd::SCALAR} )
+        if ( simd >= simply::supported_simd() )
+            all.push_back(simd);
+    return all;
+}
+
+// Sizes around vector widths, unrolling and blocks
+const std::vector<size_t> sizes = {1, 3, 7, 16, 63, 64, 65, 1000, 100003, 300007};
+
+template <class T>
+std::vector<T> values(size_t size) {
+    std::vector<T> data(size);
+    for ( size_t i = 0; i < size; i++ )
+        data[i] = static_cast<T>(static_cast<int64_t>(i * 2654435761u % 2001) - 1000);
+    return data;
+}
+
+template <class T>
+bool same_bits(T a, T b) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+}
+
+TEST(ParallelReduce, SumAndDot) {
+    for ( size_t size: sizes ) {
+        const auto ints = values<int32_t>(size);
+        const auto floats = values<float>(size);
+        const auto doubles = values<double>(size);
+        const auto shorts = values<int16_t>(size);
+
+        int64_t sum = 0, dot = 0;
+        for ( int32_t x: ints ) {
+            sum += x;
+            dot += int64_t(x) * x;
+        }
+
+        for ( simply::Simd simd: kernels() ) {
+            for ( unsigned threads: {1u, 3u} ) {
+                simply::ReduceOptions opt;
+                opt.simd = simd;
+                opt.threads = threads;
+                // Small integers, so floating-point sums are exact too
+                EXPECT_EQ(simply::parallel_sum(ints.data(), size, opt), sum) << size;
+                EXPECT_EQ(simply::parallel_sum(floats.data(), size, opt), static_cast<float>(sum)) << size;
+                EXPECT_EQ(simply::parallel_sum(doubles.data(), size, opt), static_cast<double>(sum)) << size;
+                EXPECT_EQ(simply::parallel_sum(shorts.data(), size, opt), static_cast<int16_t>(sum)) << size;
+                EXPECT_EQ(simply::parallel_dot(ints.data(), ints.data(), size, opt), static_cast<int32_t>(dot)) << size;
+                EXPECT_EQ(simply::parallel_dot(doubles.data(), doubles.data(), size, opt), static_cast<double>(dot)) << size;
+            }
+        }
+    }
+    EXPECT_EQ(simply::parallel_sum(static_cast<const float*>(nullptr), 0), 0.0f);
+
+    // Wraps around rather than overflowing
+    const std::vector<int32_t> large(1000, std::numeric_limits<int32_t>::max());
+    EXPECT_EQ(simply::parallel_sum(large.data(), large.size()), static_cast<int32_t>(uint32_t(1000) * 0x7FFFFFFFu));
+}
+
+TEST(ParallelReduce, Reproducible) {
+    // Values whose sum depends on the order of additions
+    std::vector<float> data(500009);
+    for ( size_t i = 0; i < data.size(); i++ )
+        data[i] = std::sin(static_cast<float>(i)) * (i % 7 == 0 ? 1e6f : 1e-3f);
+
+    simply::ReduceOptions opt;
+    opt.reproducible = true;
+    opt.threads = 1;
+    const float sum = simply::parallel_sum(data.data(), data.size(), opt);
+    const float dot = simply::parallel_dot(data.data(), data.data(), data.size(), opt);
+
+    for ( simply::Simd simd: kernels() ) {
+        for ( unsigned threads: {1u, 2u, 5u, 0u} ) {
+            opt.simd = simd;
+            opt.threads = threads;
+            EXPECT_TRUE(same_bits(simply::parallel_sum(data.data(), data.size(), opt), sum));
+            EXPECT_TRUE(same_bits(simply::parallel_dot(data.data(), data.data(), data.size(), opt), dot));
+        }
+    }
+
+    // Without, still close - within rounding of the magnitudes added
+    double exact = 0, magnitude = 0;
+    for ( float x: data ) {
+        exact += x;
+        magnitude += std::abs(x);
+    }
+    EXPECT_NEAR(simply::parallel_sum(data.data(), data.size()), exact, magnitude * 1e-6);
+    EXPECT_NEAR(sum, exact, magnitude * 1e-6);
+}
+
+TEST(ParallelReduce, MinMax) {
+    for ( size_t size: sizes ) {
+        auto floats = values<float>(size);
+        auto ints = values<int32_t>(size);
+        auto chars = values<int8_t>(size); // Wrapped, but still a range to check
+        floats[size / 2] = -5000.5f;
+        ints[size - 1] = 4000;
+
+        int8_t char_min = chars[0], char_max = chars[0];
+        for ( int8_t c: chars ) {
+            char_min = std::min(char_min, c);
+            char_max = std::max(char_max, c);
+        }
+
+        for ( simply::Simd simd: kernels() ) {
+            simply::ReduceOptions opt;
+            opt.simd = simd;
+            opt.threads = 2;
+            EXPECT_EQ(simply::parallel_min(floats.data(), size, opt), -5000.5f) << size;
+            EXPECT_EQ(simply::parallel_max(ints.data(), size, opt), 4000) << size;
+            const auto range = simply::parallel_minmax(chars.data(), size, opt);
+            EXPECT_EQ(range.first, char_min);
+            EXPECT_EQ(range.second, char_max);
+        }
+    }
+    EXPECT_THROW((void)simply::parallel_min(static_cast<const double*>(nullptr), 0), std::system_error);
+}
+
+TEST(ParallelReduce, CountIf) {
+    using simply::Compare;
+    for ( size_t size: sizes ) {
+        auto doubles = values<double>(size);
+        const auto ints = values<int32_t>(size);
+        doubles[0] = std::numeric_limits<double>::quiet_NaN();
+
+        for ( Compare op: {Compare::EQUAL, Compare::NOT_EQUAL, Compare::LESS,
+                           Compare::LESS_EQUAL, Compare::GREATER, Compare::GREATER_EQUAL} ) {
+            size_t double_count = 0, int_count = 0;
+            for ( size_t i = 0; i < size; i++ ) {
+                const double d = doubles[i];
+                const int32_t n = ints[i];
+                switch ( op ) {
+                case Compare::EQUAL:         double_count += d == 7;  int_count += n == 7;  break;
+                case Compare::NOT_EQUAL:     double_count += d != 7;  int_count += n != 7;  break;
+                case Compare::LESS:          double_count += d < 7;   int_count += n < 7;   break;
+                case Compare::LESS_EQUAL:    double_count += d <= 7;  int_count += n <= 7;  break;
+                case Compare::GREATER:       double_count += d > 7;   int_count += n > 7;   break;
+                case Compare::GREATER_EQUAL: double_count += d >= 7;  int_count += n >= 7;  break;
+                }
+            }
+
+            for ( simply::Simd simd: kernels() ) {
+                simply::ReduceOptions opt;
+                opt.simd = simd;
+                EXPECT_EQ(simply::parallel_count_if(doubles.data(), size, op, 7, opt), double_count)
+                    << size << " " << static_cast<int>(op);
+                EXPECT_EQ(simply::parallel_count_if(ints.data(), size, op, 7, opt), int_count)
+                    << size << " " << static_cast<int>(op);
+            }
+        }
+    }
+}